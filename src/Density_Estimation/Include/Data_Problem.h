@@ -11,6 +11,8 @@
 #include "../../FdaPDE.h"
 #include "DE_Data.h"
 #include "../../FE_Assemblers_Solvers/Include/Projection.h"
+#include "../../Global_Utilities/Include/Solver_Definitions.h"
+#include "../../FE_Assemblers_Solvers/Include/Psi_Builder.h"
 
 // This file contains data informations for the Density Estimation problem
 
@@ -22,6 +24,7 @@ class DataProblem{
     MeshHandler<ORDER, mydim, ndim> mesh_;
     SpMat R0_, R1_, GlobalPsi_;
     MatrixXr P_, PsiQuad_;
+    std::vector<Id> data_elements_; //elements containing the data
     static constexpr UInt Nodes = mydim==2? 3*ORDER : 6*ORDER-2;
 
     //! A method to compute the finite element matrices.
@@ -83,7 +86,7 @@ class DataProblem{
 
     //getter for mesh
     //! A method returning the mesh.
-    inline MeshHandler<ORDER, mydim, ndim> getMesh() const {return mesh_;}
+    inline const MeshHandler<ORDER, mydim, ndim>& getMesh() const {return mesh_;}
     //getter for specific mesh features
     //! A method returning the number of mesh nodes. It calls the same method of MeshHandler class.
     inline UInt getNumNodes() const {return mesh_.num_nodes();}
@@ -97,6 +100,8 @@ class DataProblem{
     inline Element<Nodes,mydim,ndim> findLocationNaive(Point point) const {return mesh_.findLocationNaive(point);}
     //! A method returning the element in which he point in input is located by using a tree search. It calls the same method of MeshHandler class.
     inline Element<Nodes,mydim,ndim> findLocationTree(Point point) const {return mesh_.findLocationTree(point);}
+    //! A method returning the element in which he point in input is located by using the bucket grid. It calls the same method of MeshHandler class.
+    inline Element<Nodes,mydim,ndim> findLocationGrid(Point point) const {return mesh_.findLocationGrid(point);}
 
     //getter for matrices
     //! A method returning the P matrix.
@@ -21,25 +21,29 @@ DataProblem<Integrator, Integrator_noPoly, ORDER, mydim, ndim>::DataProblem(SEXP
 
     // REMOVE POINTS NOT IN THE DOMAIN
     data = deData_.getData(); // for the 2.5D case
-    constexpr UInt Nodes = mydim ==2? 3*ORDER : 6*ORDER-2;
-    Element<Nodes, mydim, ndim> tri_activated;
+    // the data are located once (in parallel), the elements are kept for the matrices Psi
+    PsiBuilder<ORDER, mydim, ndim> builder(mesh_, deData_.getSearch());
+    std::vector<Id> located = builder.locate(data);
 
     bool check = false;
-    for(auto it = data.begin(); it != data.end(); ){
-      tri_activated = mesh_.findLocationNaive(data[it - data.begin()]); // cambiare ricerca
-      if(tri_activated.getId() == Identifier::NVAL)
+    UInt kept = 0;
+    data_elements_.clear();
+    data_elements_.reserve(located.size());
+    for(UInt i = 0; i < located.size(); ++i){
+      if(located[i] == Identifier::NVAL)
       {
-        it = data.erase(it);
         Rprintf("WARNING: an observation is not in the domain. It is removed and the algorithm proceeds.\n");
 
         if(!check) check = true;
       }
       else {
-        it++;
+        data[kept++] = data[i];
+        data_elements_.push_back(located[i]);
       }
     }
 
     if(check){
+      data.resize(kept);
       deData_.setNewData(data);
       deData_.updateN(data.size());
     }
@@ -62,11 +66,10 @@ void DataProblem<Integrator, Integrator_noPoly, ORDER, mydim, ndim>::fillFEMatri
   FiniteElement<Integrator, ORDER, mydim, ndim> fe;
   typedef EOExpr<Mass> ETMass; Mass EMass; ETMass mass(EMass);
   typedef EOExpr<Stiff> ETStiff; Stiff EStiff; ETStiff stiff(EStiff);
-  Assembler::operKernel(mass, mesh_, fe, R0_);
-  Assembler::operKernel(stiff, mesh_, fe, R1_);
+  Assembler::operKernel(mass, stiff, mesh_, fe, R0_, R1_); // both in a single pass over the mesh
 
   //fill P
-  Eigen::SparseLU<SpMat> solver;
+  SparseFactorization solver(SparseMatrixType::SymmetricPositiveDefinite);
 	solver.compute(R0_);
 	auto X2 = solver.solve(R1_);
 	P_ = R1_.transpose()* X2;
@@ -153,49 +156,23 @@ template<typename Integrator, typename Integrator_noPoly, UInt ORDER, UInt mydim
 SpMat
 DataProblem<Integrator, Integrator_noPoly, ORDER, mydim, ndim>::computePsi(const std::vector<UInt>& indices) const{
 
-  UInt nnodes = mesh_.num_nodes();
 	UInt nlocations = indices.size();
-	SpMat psi(nlocations, nnodes);
+	SpMat psi;
 
 	Real eps = 2.2204e-016,
 		   tolerance = 100 * eps;
 
-	// Constexpr is used for selecting the right number of nodes to pass as a template parameter to the Element object.In case of planar domain(i.e. mydim==2), we have that the number of nodes is 3*ORDER. In case of volumetric domain (i.e. mydim==3), we have that the number of nodes is 4 nodes if ORDER==1 and 10 nodes if ORDER==2, so the expression is 6*ORDER-2. ORDER==2 if mydim==3 is not yet implemented.
-	constexpr UInt Nodes = mydim ==2? 3*ORDER : 6*ORDER-2;
-	Element<Nodes, mydim, ndim> tri_activated;
-	Eigen::Matrix<Real,Nodes,1> coefficients;
-
-	Real evaluator;
-	std::vector<coeff> triplets;
-	triplets.reserve(Nodes*nlocations);
-
-	for(auto it = indices.cbegin(); it != indices.cend(); it++)
+	// The elements of the data have been found by the constructor
+	std::vector<Point> points(nlocations);
+	std::vector<Id> elements(nlocations);
+	for(UInt i = 0; i < nlocations; ++i)
 	{
-
-    if (deData_.getSearch() == 1) { //use Naive search
-      tri_activated = mesh_.findLocationNaive(deData_.getDatum(*it));
-    } else if (deData_.getSearch() == 2) { //use Tree search (default)
-      tri_activated = mesh_.findLocationTree(deData_.getDatum(*it));
-    }
-
-		if(tri_activated.getId() == Identifier::NVAL)
-		{
-			Rprintf("WARNING: the following observation is not in the domain\n");
-			//(deData_.getDatum(*it)).print(std::cout);
-		}
-    else
-    {
-			for(UInt node = 0; node < Nodes ; ++node)
-			{
-				coefficients = Eigen::Matrix<Real,Nodes,1>::Zero();
-				coefficients(node) = 1; //Activates only current base
-				evaluator = evaluate_point<Nodes, mydim, ndim>(tri_activated, deData_.getDatum(*it), coefficients);
-				triplets.emplace_back(it-indices.cbegin(), tri_activated[node].getId(), evaluator);
-			}
-		}
+		points[i] = deData_.getDatum(indices[i]);
+		elements[i] = data_elements_[indices[i]];
 	}
 
-	psi.setFromTriplets(triplets.begin(),triplets.end());
+	PsiBuilder<ORDER, mydim, ndim> builder(mesh_, deData_.getSearch());
+	builder.pointwise(points, elements, psi);
 
 	psi.prune(tolerance);
 	psi.makeCompressed();
@@ -1,8 +1,6 @@
 #ifndef __DENSITY_INITIALIZATION_IMP_H__
 #define __DENSITY_INITIALIZATION_IMP_H__
 
-#include <unordered_set>
-
 template<typename Integrator, typename Integrator_noPoly, UInt ORDER, UInt mydim, UInt ndim>
 UserInitialization<Integrator, Integrator_noPoly, ORDER, mydim, ndim>::UserInitialization(const DataProblem<Integrator, Integrator_noPoly, ORDER, mydim, ndim>& dp):
   DensityInitialization<Integrator, Integrator_noPoly, ORDER, mydim, ndim>(dp){
@@ -80,6 +78,8 @@ HeatProcess<Integrator, Integrator_noPoly, ORDER, mydim, ndim>::computeDensityOn
       current_element = this->dataProblem_.findLocationNaive(this->dataProblem_.getDatum(i));
     } else if (this->dataProblem_.getSearch() == 2) { //use Tree search (default)
       current_element = this->dataProblem_.findLocationTree(this->dataProblem_.getDatum(i));
+    } else if (this->dataProblem_.getSearch() == 4) { //use Grid search
+      current_element = this->dataProblem_.findLocationGrid(this->dataProblem_.getDatum(i));
     }
 
 		for(UInt j=0; j<Nodes; j++){
@@ -98,32 +98,23 @@ template<typename Integrator, typename Integrator_noPoly, UInt ORDER, UInt mydim
 void
 HeatProcess<Integrator, Integrator_noPoly, ORDER, mydim, ndim>::computeStartingDensities(){
 
-	constexpr UInt Nodes = mydim==2? 3*ORDER : 6*ORDER-2;
-
 	VectorXr x(this->dataProblem_.getNumNodes());
 	x = computeDensityOnlyData();
 
-	std::vector<std::unordered_set<UInt>> neighbours_nodes(this->dataProblem_.getNumNodes());
-	// it saves in i-th position the set of the neighboor nodes id that have node i
-
-	for(UInt t = 0; t < this->dataProblem_.getNumElements(); t++){
-		Element<Nodes, mydim, ndim> current_element = this->dataProblem_.getElement(t);
-		for(UInt i=0; i<Nodes;i++){
-			for(UInt j=i+1; j<Nodes; j++){
-					neighbours_nodes[current_element[i].id()].insert(current_element[j].id());
-					neighbours_nodes[current_element[j].id()].insert(current_element[i].id());
-			}
-		}
-	}
+	// the neighboor nodes of node i (the nodes sharing an element with it) are read from the adjacency tables of the mesh
+	const auto & adjacency = this->dataProblem_.getMesh().getAdjacency();
 
 	for(UInt j=0; j < niter_; j++){
 		VectorXr x_new(this->dataProblem_.getNumNodes());
 		for(UInt k = 0; k < this->dataProblem_.getNumNodes(); k++){
 			Real mean = 0.;
-			for(UInt elem : neighbours_nodes[k]){
-				mean += x[elem];
+			const UInt * begin;
+			const UInt * end;
+			adjacency.nodeNodes(k, begin, end);
+			for(const UInt * elem = begin; elem != end; ++elem){
+				mean += x[*elem];
 			}
-			mean /= neighbours_nodes[k].size();
+			mean /= (end - begin);
 
 			x_new[k] = x[k] + alpha_*(mean - x[k]);
 		}
@@ -11,27 +11,33 @@ void Evaluator<ORDER,2,2>::eval(Real* X, Real *Y, UInt length, const Real *coef,
 	Eigen::Matrix<Real,Nodes,1> coefficients;
 	UInt search = mesh_.getSearch();						 
 
-	for (int i = 0; i<length; ++i) {
-		current_point = Point(X[i],Y[i]);
+	std::vector<Point> points;
+	points.reserve(length);
+	for (int i = 0; i<length; ++i)
+		points.emplace_back(X[i],Y[i]);
+
+	std::vector<Id> element_ids;
+	if (search == 1) { //use Naive search
+		element_ids.resize(length);
+		for (int i = 0; i<length; ++i)
+			element_ids[i] = mesh_.findLocationNaive(points[i]).getId();
+	} else if (search == 2 || search == 3) { //use Tree (default) or Walking search, on the whole batch
+		// redundancy: to avoid problems with non convex mesh when walking
+		element_ids = mesh_.findLocationBatch(points, redundancy);
+	} else if (search == 4) { //use Grid search, point by point
+		element_ids.resize(length);
+		for (int i = 0; i<length; ++i)
+			element_ids[i] = mesh_.findLocationGrid(points[i]).getId();
+	}
 
-		if (search == 1) { //use Naive search
-			current_element = mesh_.findLocationNaive(current_point);
-		} else if (search == 2)  { //use Tree search (default)
-			current_element = mesh_.findLocationTree(current_point);
-		} else if (search == 3) { //use Walking search
-			Element<Nodes,2,2> starting_element;
-			starting_element = mesh_.getElement(0);
-			current_element = mesh_.findLocationWalking(current_point, starting_element);
-			if(current_element.getId() == Identifier::NVAL && redundancy == true) {
-				//To avoid problems with non convex mesh
-				current_element = mesh_.findLocationNaive(current_point);
-			}
-		}
+	for (int i = 0; i<length; ++i) {
+		current_point = points[i];
 
-		if(current_element.getId() == Identifier::NVAL) {
+		if(element_ids[i] == Identifier::NVAL) {
 			isinside[i]=false;
 		} else {
 			isinside[i]=true;
+			current_element = mesh_.getElement(element_ids[i]);
 			for (int j=0; j<(Nodes); ++j) {
 				coefficients[j] = coef[current_element[j].getId()];
 			}
@@ -90,19 +96,33 @@ void Evaluator<ORDER,2,3>::eval(Real* X, Real *Y,  Real *Z, UInt length, const R
 	Eigen::Matrix<Real,Nodes,1> coefficients;
 	UInt search = mesh_.getSearch();
 
-	for (int i = 0; i<length; ++i) {
-		current_point = Point(X[i],Y[i],Z[i]);
+	std::vector<Point> points;
+	points.reserve(length);
+	for (int i = 0; i<length; ++i)
+		points.emplace_back(X[i],Y[i],Z[i]);
+
+	std::vector<Id> element_ids;
+	if (search == 1) { //use Naive search
+		element_ids.resize(length);
+		for (int i = 0; i<length; ++i)
+			element_ids[i] = mesh_.findLocationNaive(points[i]).getId();
+	} else if (search == 2 || search == 3) { //use Tree (default) or Walking search, on the whole batch
+		// redundancy: to avoid problems with non convex mesh when walking
+		element_ids = mesh_.findLocationBatch(points, redundancy);
+	} else if (search == 4) { //use Grid search, point by point
+		element_ids.resize(length);
+		for (int i = 0; i<length; ++i)
+			element_ids[i] = mesh_.findLocationGrid(points[i]).getId();
+	}
 
-		if (search == 1) { //use Naive search
-			current_element = mesh_.findLocationNaive(current_point);
-		} else if (search == 2)  { //use Tree search (default)
-			current_element = mesh_.findLocationTree(current_point);
-		}
+	for (int i = 0; i<length; ++i) {
+		current_point = points[i];
 
-		if(current_element.getId() == Identifier::NVAL) {
+		if(element_ids[i] == Identifier::NVAL) {
 			isinside[i]=false;
 		} else {
 			isinside[i]=true;
+			current_element = mesh_.getElement(element_ids[i]);
 			for (int j=0; j<(Nodes); ++j) {
 				coefficients[j] = coef[current_element[j].getId()];
 			}
@@ -162,20 +182,34 @@ void Evaluator<ORDER,3,3>::eval(Real* X, Real *Y,  Real *Z, UInt length, const R
 	UInt search = mesh_.getSearch();
 
 
-	for (int i = 0; i<length; ++i) {
-		current_point = Point(X[i],Y[i],Z[i]);
+	std::vector<Point> points;
+	points.reserve(length);
+	for (int i = 0; i<length; ++i)
+		points.emplace_back(X[i],Y[i],Z[i]);
+
+	std::vector<Id> element_ids;
+	if (search == 1) { //use Naive search
+		element_ids.resize(length);
+		for (int i = 0; i<length; ++i)
+			element_ids[i] = mesh_.findLocationNaive(points[i]).getId();
+	} else if (search == 2 || search == 3) { //use Tree (default) or Walking search, on the whole batch
+		// redundancy: to avoid problems with non convex mesh when walking
+		element_ids = mesh_.findLocationBatch(points, redundancy);
+	} else if (search == 4) { //use Grid search, point by point
+		element_ids.resize(length);
+		for (int i = 0; i<length; ++i)
+			element_ids[i] = mesh_.findLocationGrid(points[i]).getId();
+	}
 
-		if (search == 1) { //use Naive search
-			current_element = mesh_.findLocationNaive(current_point);
-		} else if (search == 2)  { //use Tree search (default)
-			current_element = mesh_.findLocationTree(current_point);
-		}
+	for (int i = 0; i<length; ++i) {
+		current_point = points[i];
 
 
-		if(current_element.getId() == Identifier::NVAL) {
+		if(element_ids[i] == Identifier::NVAL) {
 			isinside[i]=false;
 		} else {
 			isinside[i]=true;
+			current_element = mesh_.getElement(element_ids[i]);
 			for (int j=0; j<(Nodes); ++j) {
 				coefficients[j] = coef[current_element[j].getId()];
 			}
@@ -28,10 +28,15 @@ private:
 	//Numero basi locali x Num coordinate x numero nodi integrazione
 	Eigen::Matrix<Real,3*ORDER, Integrator::NNODES*2> phiDerMapMaster_;
 	Eigen::Matrix<Real,3*ORDER, Integrator::NNODES*2> invTrJPhiDerMapMaster_;
+	//Quadrature on the reference element of phi_i*phi_j, of d_a phi_i*d_b phi_j (index a*2+b) and of phi_i*d_a phi_j
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> massMaster_;
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> stiffMaster_[4];
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> gradMaster_[2];
 
 	void setPhiMaster();
 	void setPhiDerMaster();
 	void setInvTrJPhiDerMaster();
+	void setReferenceMatrices();
 
 public:
 
@@ -77,6 +82,19 @@ public:
 
 	//Returns J^{-1} \nabla \hat{phi}
 	Real invTrJPhiDerMaster(UInt i, UInt ic, UInt iq) const;
+
+	//Returns the quadrature of \hat{phi}_i \hat{phi}_j
+	const Eigen::Matrix<Real,3*ORDER,3*ORDER>& massMaster() const {return massMaster_;}
+
+	//Returns the quadrature of \nabla \hat{phi}_i^T K \nabla \hat{phi}_j
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> stiffMaster(const Eigen::Matrix<Real,2,2>& K) const;
+
+	//Returns the quadrature of \hat{phi}_i \nabla \hat{phi}_j^T c
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> gradMaster(const Eigen::Matrix<Real,2,1>& c) const;
+
+	const Eigen::Matrix<Real,2,2>& invJ() const {return t_.getM_invJ();}
+
+	const Eigen::Matrix<Real,2,2>& metric() const {return t_.getMetric();}
 };
 
 
@@ -90,10 +108,14 @@ private:
 	Eigen::Matrix<Real,3*ORDER, Integrator::NNODES*2> phiDerMapMaster_;
 	//Eigen::Matrix<Real,3*ORDER, Integrator::NNODES*2> invTrJPhiDerMapMaster_;
 	Eigen::Matrix<Real,2,2> metric_;
+	//Quadrature on the reference element of phi_i*phi_j and of d_a phi_i*d_b phi_j (index a*2+b)
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> massMaster_;
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> stiffMaster_[4];
 
 	void setPhiMaster();
 	void setPhiDerMaster();
 	//void setInvTrJPhiDerMaster();
+	void setReferenceMatrices();
 
 public:
 
@@ -141,6 +163,12 @@ public:
 	//Returns J^{-1} \nabla \hat{phi}
 	//Real invTrJPhiDerMaster(UInt i, UInt ic, UInt iq) const;
 
+	//Returns the quadrature of \hat{phi}_i \hat{phi}_j
+	const Eigen::Matrix<Real,3*ORDER,3*ORDER>& massMaster() const {return massMaster_;}
+
+	//Returns the quadrature of \nabla \hat{phi}_i^T K \nabla \hat{phi}_j
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> stiffMaster(const Eigen::Matrix<Real,2,2>& K) const;
+
 	Eigen::Matrix<Real,2,2> metric()const {return metric_;};
 
 };
@@ -157,11 +185,14 @@ private:
 	//Numero basi locali x Num coordinate x numero nodi integrazione
 	Eigen::Matrix<Real,6*ORDER-2, Integrator::NNODES*3> phiDerMapMaster_;
 	Eigen::Matrix<Real,6*ORDER-2, Integrator::NNODES*3> invTrJPhiDerMapMaster_;
-	Eigen::Matrix<Real,3,3> metric_;
+	//Quadrature on the reference element of phi_i*phi_j and of d_a phi_i*d_b phi_j (index a*3+b)
+	Eigen::Matrix<Real,6*ORDER-2,6*ORDER-2> massMaster_;
+	Eigen::Matrix<Real,6*ORDER-2,6*ORDER-2> stiffMaster_[9];
 
 	void setPhiMaster();
 	void setPhiDerMaster();
 	void setInvTrJPhiDerMaster();
+	void setReferenceMatrices();
 
 
 public:
@@ -210,7 +241,13 @@ public:
 	//Returns J^{-1} \nabla \hat{phi}
 	Real invTrJPhiDerMaster(UInt i, UInt ic, UInt iq) const;
 
-	Eigen::Matrix<Real,3,3> metric()const {return metric_;};
+	//Returns the quadrature of \hat{phi}_i \hat{phi}_j
+	const Eigen::Matrix<Real,6*ORDER-2,6*ORDER-2>& massMaster() const {return massMaster_;}
+
+	//Returns the quadrature of \nabla \hat{phi}_i^T K \nabla \hat{phi}_j
+	Eigen::Matrix<Real,6*ORDER-2,6*ORDER-2> stiffMaster(const Eigen::Matrix<Real,3,3>& K) const;
+
+	const Eigen::Matrix<Real,3,3>& metric() const {return t_.getMetric();}
 
 };
 
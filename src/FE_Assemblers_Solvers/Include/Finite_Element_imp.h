@@ -20,6 +20,7 @@ FiniteElement<Integrator, ORDER,2,2>::FiniteElement()
 	//How it will be used, it does not depend on J^-1 -> set one time
 	setPhiMaster();
 	setPhiDerMaster();
+	setReferenceMatrices();
 }
 
 
@@ -109,6 +110,47 @@ void FiniteElement<Integrator, ORDER,2,2>::setInvTrJPhiDerMaster()
 	}
 }
 
+template <class Integrator, UInt ORDER>
+void FiniteElement<Integrator, ORDER,2,2>::setReferenceMatrices()
+{
+	// the measures of the reference element and of the element are applied by the assembler
+	massMaster_.setZero();
+	for (auto ab=0; ab < 4; ab++)
+		stiffMaster_[ab].setZero();
+	for (auto a=0; a < 2; a++)
+		gradMaster_[a].setZero();
+
+	for (auto iq=0; iq < Integrator::NNODES; iq++)
+	{
+		const Real w = Integrator::WEIGHTS[iq];
+		for (auto i=0; i < 3*ORDER; i++)
+			for (auto j=0; j < 3*ORDER; j++)
+			{
+				massMaster_(i,j) += w*phiMapMaster_(i,iq)*phiMapMaster_(j,iq);
+				for (auto a=0; a < 2; a++)
+					for (auto b=0; b < 2; b++)
+						stiffMaster_[a*2+b](i,j) += w*phiDerMapMaster_(i,iq*2+a)*phiDerMapMaster_(j,iq*2+b);
+				for (auto a=0; a < 2; a++)
+					gradMaster_[a](i,j) += w*phiMapMaster_(i,iq)*phiDerMapMaster_(j,iq*2+a);
+			}
+	}
+}
+
+template <class Integrator, UInt ORDER>
+Eigen::Matrix<Real,3*ORDER,3*ORDER> FiniteElement<Integrator, ORDER,2,2>::stiffMaster(const Eigen::Matrix<Real,2,2>& K) const
+{
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> local = K(0,0)*stiffMaster_[0];
+	for (auto ab=1; ab < 4; ab++)
+		local += K(ab/2,ab%2)*stiffMaster_[ab];
+	return local;
+}
+
+template <class Integrator, UInt ORDER>
+Eigen::Matrix<Real,3*ORDER,3*ORDER> FiniteElement<Integrator, ORDER,2,2>::gradMaster(const Eigen::Matrix<Real,2,1>& c) const
+{
+	return c[0]*gradMaster_[0] + c[1]*gradMaster_[1];
+}
+
 //! Implementazione EF mydim=2, ndim=3
 
 
@@ -126,6 +168,7 @@ FiniteElement<Integrator, ORDER,2,3>::FiniteElement()
 	//How it will be used, it does not depend on J^-1 -> set one time
 	setPhiMaster();
 	setPhiDerMaster();
+	setReferenceMatrices();
 }
 
 
@@ -216,6 +259,37 @@ void FiniteElement<Integrator, ORDER,2,2>::setInvTrJPhiDerMaster()
 }*/
 
 
+template <class Integrator, UInt ORDER>
+void FiniteElement<Integrator, ORDER,2,3>::setReferenceMatrices()
+{
+	massMaster_.setZero();
+	for (auto ab=0; ab < 4; ab++)
+		stiffMaster_[ab].setZero();
+
+	for (auto iq=0; iq < Integrator::NNODES; iq++)
+	{
+		const Real w = Integrator::WEIGHTS[iq];
+		for (auto i=0; i < 3*ORDER; i++)
+			for (auto j=0; j < 3*ORDER; j++)
+			{
+				massMaster_(i,j) += w*phiMapMaster_(i,iq)*phiMapMaster_(j,iq);
+				for (auto a=0; a < 2; a++)
+					for (auto b=0; b < 2; b++)
+						stiffMaster_[a*2+b](i,j) += w*phiDerMapMaster_(i,iq*2+a)*phiDerMapMaster_(j,iq*2+b);
+			}
+	}
+}
+
+template <class Integrator, UInt ORDER>
+Eigen::Matrix<Real,3*ORDER,3*ORDER> FiniteElement<Integrator, ORDER,2,3>::stiffMaster(const Eigen::Matrix<Real,2,2>& K) const
+{
+	Eigen::Matrix<Real,3*ORDER,3*ORDER> local = K(0,0)*stiffMaster_[0];
+	for (auto ab=1; ab < 4; ab++)
+		local += K(ab/2,ab%2)*stiffMaster_[ab];
+	return local;
+}
+
+
 //! Implementazione EF mydim=3, ndim=3
 
 
@@ -234,6 +308,7 @@ FiniteElement<Integrator, ORDER,3,3>::FiniteElement()
 	//How it will be used, it does not depend on J^-1 -> set one time
 	setPhiMaster();
 	setPhiDerMaster();
+	setReferenceMatrices();
 }
 
 
@@ -329,6 +404,35 @@ Real FiniteElement<Integrator, ORDER,3,3>::invTrJPhiDerMaster(UInt i, UInt ic, U
 	return invTrJPhiDerMapMaster_(i, iq*3 + ic);
 }
 
+template <class Integrator, UInt ORDER>
+void FiniteElement<Integrator, ORDER,3,3>::setReferenceMatrices()
+{
+	massMaster_.setZero();
+	for (auto ab=0; ab < 9; ab++)
+		stiffMaster_[ab].setZero();
+
+	for (auto iq=0; iq < Integrator::NNODES; iq++)
+	{
+		const Real w = Integrator::WEIGHTS[iq];
+		for (auto i=0; i < 6*ORDER-2; i++)
+			for (auto j=0; j < 6*ORDER-2; j++)
+			{
+				massMaster_(i,j) += w*phiMapMaster_(i,iq)*phiMapMaster_(j,iq);
+				for (auto a=0; a < 3; a++)
+					for (auto b=0; b < 3; b++)
+						stiffMaster_[a*3+b](i,j) += w*phiDerMapMaster_(i,iq*3+a)*phiDerMapMaster_(j,iq*3+b);
+			}
+	}
+}
+
+template <class Integrator, UInt ORDER>
+Eigen::Matrix<Real,6*ORDER-2,6*ORDER-2> FiniteElement<Integrator, ORDER,3,3>::stiffMaster(const Eigen::Matrix<Real,3,3>& K) const
+{
+	Eigen::Matrix<Real,6*ORDER-2,6*ORDER-2> local = K(0,0)*stiffMaster_[0];
+	for (auto ab=1; ab < 9; ab++)
+		local += K(ab/3,ab%3)*stiffMaster_[ab];
+	return local;
+}
 
 
 #endif
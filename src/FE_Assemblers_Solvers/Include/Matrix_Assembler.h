@@ -8,6 +8,27 @@
 #include "Param_Functors.h"
 #include "Spline.h"
 #include "../../Mesh/Include/Mesh.h"
+#include "../../Global_Utilities/Include/Parallel.h"
+
+//! A function computing the local matrix of an operator by quadrature, one entry at a time.
+/*!
+ * local(i,j) is the sum over the quadrature nodes of the operator (i,j) times the weight of the node.
+ * The operators with constant coefficients compute their local matrix from the reference matrices
+ * of the finite element instead; this is the fallback of those whose coefficients vary in space.
+ */
+template<typename Oper, typename Integrator, UInt ORDER, UInt mydim, UInt ndim, typename Matrix>
+inline void quadratureLocalMatrix(Oper& oper, FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+{
+	for(int i = 0; i < local.rows(); i++)
+		for(int j = 0; j < local.cols(); j++)
+		{
+			Real s = 0;
+			for(int l = 0; l < Integrator::NNODES; l++)
+				s += oper(currentfe_, i, j, l) * Integrator::WEIGHTS[l];
+			local(i,j) = s;
+		}
+}
+
 //! A Stiff class: a class for the stiffness operator.
 
 class Stiff{
@@ -82,6 +103,19 @@ class Stiff{
 	   	return s;
 	}
 
+	//! The local matrix of the operator on the current finite element, without the measure of the element.
+	/*!
+	 * The gradients are mapped by the metric of the element: the matrix is a combination of the
+	 * reference stiffness matrices with its entries as coefficients.
+	 */
+	template<class Integrator, UInt ORDER, UInt mydim, UInt ndim, class Matrix>
+	inline void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+	{
+		local = currentfe_.stiffMaster(currentfe_.metric());
+	}
+
+	//! Whether the coefficients of the operator are the same at every quadrature node
+	static constexpr bool constantCoefficients() {return true;}
 
 };
 
@@ -131,6 +165,18 @@ class StiffAnys<Eigen::Matrix<Real,2,2>>{
 template<class Integrator, UInt ORDER>
 	inline Real operator() (FiniteElement<Integrator, ORDER,3,3>& currentfe_, UInt i, UInt j, UInt iq, UInt ic = 0){return 0;}
 
+	//! The local matrix on the current planar finite element: the reference stiffness matrices combined by J^{-1} K J^{-T}
+	template<class Integrator, UInt ORDER, class Matrix>
+	inline void localMatrix(FiniteElement<Integrator, ORDER,2,2>& currentfe_, Matrix& local)
+	{
+		local = currentfe_.stiffMaster(currentfe_.invJ()*K_*currentfe_.invJ().transpose());
+	}
+
+	template<class Integrator, UInt ORDER, UInt mydim, UInt ndim, class Matrix>
+	inline void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local){local.setZero();}
+
+	static constexpr bool constantCoefficients() {return true;}
+
 };
 
 template <>
@@ -176,6 +222,14 @@ class StiffAnys<Diffusivity>{
     template <class Integrator, UInt ORDER>
 	inline Real operator() (FiniteElement<Integrator, ORDER,3,3>& currentfe_, UInt i, UInt j, UInt iq, UInt ic = 0){return 0;}
 
+	template<class Integrator, UInt ORDER, UInt mydim, UInt ndim, class Matrix>
+	inline void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+	{
+		quadratureLocalMatrix(*this, currentfe_, local);
+	}
+
+	static constexpr bool constantCoefficients() {return false;}
+
 };
 
 //! A Mass class: a class for the mass operator.
@@ -228,6 +282,15 @@ class Mass{
     	return currentfe_.phiMaster(i,iq)*  currentfe_.phiMaster(j,iq);
     };
 
+    //! The local matrix on the current finite element, without the measure of the element: the reference mass matrix.
+    template <class Integrator ,UInt ORDER, UInt mydim, UInt ndim, class Matrix>
+    inline void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+    {
+    	local = currentfe_.massMaster();
+    }
+
+    static constexpr bool constantCoefficients() {return true;}
+
 };
 
 //! A vGrad class: a class for the the vectorial Gradient operator.
@@ -260,6 +323,20 @@ class Grad{
      template<class Integrator, UInt ORDER>
      inline Real operator() (FiniteElement<Integrator, ORDER,3,3>& currentfe_, UInt i, UInt j, UInt iq, UInt ic = 0){return 0;};
 
+     //! The local matrix of dot(b, Grad) on the current planar finite element, without the measure of the element.
+     /*!
+      * phi_i (J^{-T} grad phi_j).b = phi_i grad phi_j.(J^{-1} b): a combination of the reference matrices of phi_i d_a phi_j.
+      */
+     template<class Integrator, UInt ORDER, class Matrix>
+     inline void dotLocalMatrix(const Eigen::Matrix<Real,2,1>& b, FiniteElement<Integrator, ORDER,2,2>& currentfe_, Matrix& local)
+     {
+    	 local = currentfe_.gradMaster(currentfe_.invJ()*b);
+     }
+
+     template<class Integrator, UInt ORDER, UInt mydim, UInt ndim, class Vector, class Matrix>
+     inline void dotLocalMatrix(const Vector& b, FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local){local.setZero();}
+
+     static constexpr bool constantCoefficients() {return true;}
 
 };
 
@@ -352,6 +429,24 @@ class EOExpr{
           return a_(currentfe_, i,j,iq,ic);
       }
 
+	 //! The local matrix of the operator on the current finite element, without the measure of the element.
+     /*!
+     * \param local a fixed-size matrix with one row and one column per basis function of the element
+     */
+	  template<typename Integrator, UInt ORDER,UInt mydim, UInt ndim, class Matrix>
+      void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+      {
+          a_.localMatrix(currentfe_, local);
+      }
+
+	  template<typename Integrator, UInt ORDER,UInt mydim, UInt ndim, class Vector, class Matrix>
+      void dotLocalMatrix(const Vector& b, FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+      {
+          a_.dotLocalMatrix(b, currentfe_, local);
+      }
+
+	  static constexpr bool constantCoefficients() {return A::constantCoefficients();}
+
     template<typename Integrator, UInt DEGREE, UInt ORDER_DERIVATIVE>
       Real operator() (Spline<Integrator, DEGREE, ORDER_DERIVATIVE>& spline_, UInt i, UInt j, Real u)
       {
@@ -408,6 +503,24 @@ class EOBinOp{
 	  {
 		  return Op::apply(a_(currentfe_,i,j, iq, ic),b_(currentfe_, i,j, iq, ic));
 	  }
+
+		template<typename Integrator, UInt ORDER,UInt mydim,UInt ndim, class Matrix>
+	  void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+	  {
+		  // an operand with variable coefficients is integrated node by node: so is the whole operation,
+		  // in a single loop over the quadrature nodes
+		  if(!constantCoefficients())
+		  {
+			  quadratureLocalMatrix(*this, currentfe_, local);
+			  return;
+		  }
+		  Matrix local_b;
+		  a_.localMatrix(currentfe_, local);
+		  b_.localMatrix(currentfe_, local_b);
+		  local = Op::apply(local, local_b);
+	  }
+
+		static constexpr bool constantCoefficients() {return A::constantCoefficients() && B::constantCoefficients();}
 	};
 
 template<class B, class Op>
@@ -423,6 +536,15 @@ public:
 	{
 		return Op::apply(M_a,M_b(currentfe_, i, j, iq, ic));
 	}
+
+	template<typename Integrator, UInt ORDER,UInt mydim, UInt ndim, class Matrix>
+	void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+	{
+		M_b.localMatrix(currentfe_, local);
+		local = Op::apply(M_a, local);
+	}
+
+	static constexpr bool constantCoefficients() {return B::constantCoefficients();}
 };
 
 template<class B, class Op>
@@ -439,6 +561,14 @@ public:
 		UInt globalIndex = currentfe_.getGlobalIndex(iq);
 		return Op::apply(M_a(globalIndex),M_b(currentfe_, i, j, iq, ic));
 	}
+
+	template<typename Integrator, UInt ORDER,UInt mydim, UInt ndim, class Matrix>
+	void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+	{
+		quadratureLocalMatrix(*this, currentfe_, local);
+	}
+
+	static constexpr bool constantCoefficients() {return false;}
 };
 
 //wrappers addition
@@ -460,6 +590,9 @@ class EOAdd{
 	 * \param b is of P type, second addend
 	 */
 	static inline Real apply(Real a, Real b){ return (a+b); }
+	//! The addition of two local matrices
+	template<class Matrix>
+	static inline Matrix apply(const Matrix& a, const Matrix& b){ return (a+b); }
 };
 
 //multiplication by real scalar
@@ -481,6 +614,9 @@ class EOMult{
 	 * \param b is a Real, second operand
 	 */
 	  static inline Real apply( Real a, Real b){ return (a*b);}
+	 //! The multiplication of a local matrix by a real scalar
+	  template<class Matrix>
+	  static inline Matrix apply( Real a, const Matrix& b){ return (a*b);}
 	  //not needed since in ETRBinOp I did "Op::apply(a_(i,j),b_)"
 	  //static inline P apply(Real b, const P&a){ return (a*b);}
 	};
@@ -510,6 +646,14 @@ class EODotProd
 			s += a_(ic) * b_(currentfe_, i, j, iq, ic);
 	return s;
 	}
+
+	template<typename Integrator, UInt ORDER, UInt mydim, UInt ndim, class Matrix>
+	inline void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+	{
+		b_.dotLocalMatrix(a_, currentfe_, local);
+	}
+
+	static constexpr bool constantCoefficients() {return B::constantCoefficients();}
 };
 
 //Dot
@@ -540,6 +684,14 @@ class EODotProd<Function, B>
 	return s;
 	}
 
+	template<typename Integrator, UInt ORDER, UInt mydim, UInt ndim, class Matrix>
+	inline void localMatrix(FiniteElement<Integrator, ORDER,mydim,ndim>& currentfe_, Matrix& local)
+	{
+		quadratureLocalMatrix(*this, currentfe_, local);
+	}
+
+	static constexpr bool constantCoefficients() {return false;}
+
 };
 
 //operator +
@@ -652,6 +804,32 @@ class Assembler{
 	  template<UInt ORDER, typename Integrator>
 	  static void forcingTerm(const MeshHandler<ORDER,3,3>& mesh, FiniteElement<Integrator, ORDER,3,3>& fe, const ForcingTerm& u, VectorXr& forcingTerm);
 
+	  //! A template member discretizing two differential operators, and optionally a forcing term, in a single pass over the mesh
+	  /*!
+	   * The finite element is updated once per element for both operators and the two matrices are summed
+	   * into the pattern of the mesh (see AssemblyPattern); they are equal to those of two calls of operKernel.
+	   * \param operA, operB are template expressions: the differential operators to be discretized in MatA and MatB.
+	   * \param u if not null, the forcing term is also computed in forcingTerm, as by forcingTerm.
+	   */
+	  template<UInt ORDER, UInt mydim, UInt ndim, typename Integrator, typename A, typename B>
+	  static void operKernel(EOExpr<A> operA, EOExpr<B> operB, const MeshHandler<ORDER,mydim,ndim>& mesh,
+	  	                     FiniteElement<Integrator, ORDER,mydim,ndim>& fe, SpMat& MatA, SpMat& MatB,
+	  	                     const ForcingTerm* u = nullptr, VectorXr* forcingTerm = nullptr);
+
+	  //! The factor of the integrals on the current element: the determinant of the Jacobian, or its square root on surfaces and volumes
+	  template<typename Integrator, UInt ORDER>
+	  static Real measure(FiniteElement<Integrator, ORDER,2,2>& fe) {return fe.getDet();}
+	  template<typename Integrator, UInt ORDER>
+	  static Real measure(FiniteElement<Integrator, ORDER,2,3>& fe) {return std::sqrt(fe.getDet());}
+	  template<typename Integrator, UInt ORDER>
+	  static Real measure(FiniteElement<Integrator, ORDER,3,3>& fe) {return std::sqrt(fe.getDet());}
+
+	  //! The measure of the reference element
+	  template<typename Integrator, UInt ORDER, UInt ndim>
+	  static Real reference(FiniteElement<Integrator, ORDER,2,ndim>& fe) {return fe.getAreaReference();}
+	  template<typename Integrator, UInt ORDER>
+	  static Real reference(FiniteElement<Integrator, ORDER,3,3>& fe) {return fe.getVolumeReference();}
+
 
 };
 
@@ -8,38 +8,41 @@ void Assembler::operKernel(EOExpr<A> oper,const MeshHandler<ORDER,2,2>& mesh,
 {
 	Real eps = 2.2204e-016,
 		 tolerance = 10 * eps;
-	std::vector<coeff> triplets;
 
-
-  	for(auto t=0; t<mesh.num_elements(); t++)
-  	{
-		fe.updateElement(mesh.getElement(t));
-
-		// Vector of vertices indices (link local to global indexing system)
-		std::vector<UInt> identifiers;
-		identifiers.resize(3*ORDER);
-		for( auto q=0; q<3*ORDER; q++)
-			identifiers[q]=mesh.getElement(t)[q].id();
-
-		//localM=localMassMatrix(currentelem);
-		for(int i = 0; i < 3*ORDER; i++)
+	// geometry of the elements is computed once and reused by the following passes over the mesh
+	mesh.buildGeometryCache();
+	// so are the pattern of the matrix and the map from the local matrices to its entries
+	const auto & pattern = mesh.getAssemblyPattern();
+
+	// The local matrix of element t fills the Nodes*Nodes values from position Nodes*Nodes*t: the elements are
+	// integrated in parallel, then the values are summed into the entries of the pattern
+	constexpr UInt Nodes = 3*ORDER;
+	const UInt num_elements = mesh.num_elements();
+	std::vector<Real> local(std::size_t(Nodes*Nodes)*num_elements);
+	const int threads = fdaPDEThreads();
+
+	#pragma omp parallel num_threads(threads)
+	{
+		// Every thread updates its own copy of the finite element and of the operator
+		FiniteElement<Integrator, ORDER,2,2> local_fe(fe);
+		EOExpr<A> local_oper(oper);
+		Eigen::Matrix<Real,Nodes,Nodes> local_reference;
+
+		#pragma omp for schedule(static)
+		for(int t=0; t<int(num_elements); t++)
 		{
-			for(int j = 0; j < 3*ORDER; j++)
-			{
-				Real s=0;
-
-				for(int l = 0;l < Integrator::NNODES; l++)
-				{
-					s += oper(fe,i,j,l) * fe.getDet() * fe.getAreaReference() * Integrator::WEIGHTS[l];
-				}
-			  triplets.push_back(coeff(identifiers[i],identifiers[j],s));
-			}
+			const auto element = mesh.getElement(t);
+			local_fe.updateElement(element);
+
+			// the local matrix is a fixed-size combination of the reference matrices of the finite element,
+			// stored row by row
+			local_oper.localMatrix(local_fe, local_reference);
+			Eigen::Map<Eigen::Matrix<Real,Nodes,Nodes,Eigen::RowMajor>> local_matrix(&local[std::size_t(Nodes*Nodes)*t]);
+			local_matrix = (local_fe.getDet() * local_fe.getAreaReference()) * local_reference;
 		}
 	}
 
-  	UInt nnodes = mesh.num_nodes();
-  	OpMat.resize(nnodes, nnodes);
-	OpMat.setFromTriplets(triplets.begin(),triplets.end());
+	pattern.assemble(local, OpMat, threads);
 	OpMat.prune(tolerance);
 }
 
@@ -49,33 +52,42 @@ void Assembler::forcingTerm(const MeshHandler<ORDER,2,2>& mesh,
 {
 
 	forcingTerm = VectorXr::Zero(mesh.num_nodes());
+	mesh.buildGeometryCache();
 
-  	for(auto t=0; t<mesh.num_elements(); t++)
-  	{
-		fe.updateElement(mesh.getElement(t));
+	// The local vectors are computed in parallel, then summed in the order of the elements
+	constexpr UInt Nodes = 3*ORDER;
+	const UInt num_elements = mesh.num_elements();
+	std::vector<UInt> identifiers(Nodes*num_elements);
+	std::vector<Real> local(Nodes*num_elements);
+	const int threads = fdaPDEThreads();
 
-		// Vector of vertices indices (link local to global indexing system)
-		std::vector<UInt> identifiers;
-				identifiers.resize(3*ORDER);
+	#pragma omp parallel num_threads(threads)
+	{
+		FiniteElement<Integrator, ORDER,2,2> local_fe(fe);
 
-		for( auto q=0; q<3*ORDER; q++)
-			identifiers[q]=mesh.getElement(t)[q].id();
-
-
-		//localM=localMassMatrix(currentelem);
-		for(int i = 0; i < 3*ORDER; i++)
+		#pragma omp for schedule(static)
+		for(int t=0; t<int(num_elements); t++)
 		{
-			Real s=0;
+			const auto element = mesh.getElement(t);
+			local_fe.updateElement(element);
 
-			for(int iq = 0;iq < Integrator::NNODES; iq++)
+			for(int i = 0; i < Nodes; i++)
 			{
-				UInt globalIndex = fe.getGlobalIndex(iq);
-				s +=  fe.phiMaster(i,iq)* u(globalIndex) * fe.getDet() * fe.getAreaReference()* Integrator::WEIGHTS[iq];//(*)
+				Real s=0;
+
+				for(int iq = 0;iq < Integrator::NNODES; iq++)
+				{
+					UInt globalIndex = local_fe.getGlobalIndex(iq);
+					s +=  local_fe.phiMaster(i,iq)* u(globalIndex) * local_fe.getDet() * local_fe.getAreaReference()* Integrator::WEIGHTS[iq];//(*)
+				}
+				identifiers[Nodes*t+i] = element[i].id();
+				local[Nodes*t+i] = s;
 			}
-			forcingTerm[identifiers[i]] += s;
 		}
-
 	}
+
+	for(UInt k = 0; k < Nodes*num_elements; k++)
+		forcingTerm[identifiers[k]] += local[k];
 }
 
 
@@ -87,39 +99,38 @@ void Assembler::operKernel(EOExpr<A> oper,const MeshHandler<ORDER,2,3>& mesh,
 {
 	Real eps = 2.2204e-016,
 		 tolerance = 10 * eps;
-	std::vector<coeff> triplets;
 
-
-  	for(auto t=0; t<mesh.num_elements(); t++)
-  	{
-		fe.updateElement(mesh.getElement(t));
-
-		// Vector of vertices indices (link local to global indexing system)
-		std::vector<UInt> identifiers;
-		identifiers.resize(3*ORDER);
-		for( auto q=0; q<3*ORDER; q++)
-			identifiers[q]=mesh.getElement(t)[q].id();
-
-		//localM=localMassMatrix(currentelem);
-		for(int i = 0; i < 3*ORDER; i++)
+	// geometry of the elements is computed once and reused by the following passes over the mesh
+	mesh.buildGeometryCache();
+	// so are the pattern of the matrix and the map from the local matrices to its entries
+	const auto & pattern = mesh.getAssemblyPattern();
+
+	// As in the planar case, each element fills its own slot of local values
+	constexpr UInt Nodes = 3*ORDER;
+	const UInt num_elements = mesh.num_elements();
+	std::vector<Real> local(std::size_t(Nodes*Nodes)*num_elements);
+	const int threads = fdaPDEThreads();
+
+	#pragma omp parallel num_threads(threads)
+	{
+		// Every thread updates its own copy of the finite element and of the operator
+		FiniteElement<Integrator, ORDER,2,3> local_fe(fe);
+		EOExpr<A> local_oper(oper);
+		Eigen::Matrix<Real,Nodes,Nodes> local_reference;
+
+		#pragma omp for schedule(static)
+		for(int t=0; t<int(num_elements); t++)
 		{
-			for(int j = 0; j < 3*ORDER; j++)
-			{
-				Real s=0;
+			const auto element = mesh.getElement(t);
+			local_fe.updateElement(element);
 
-				for(int l = 0;l < Integrator::NNODES; l++)
-				{
-					s += oper(fe,i,j,l) * std::sqrt(fe.getDet()) * fe.getAreaReference()* Integrator::WEIGHTS[l];
-				}
-			  triplets.push_back(coeff(identifiers[i],identifiers[j],s));
-			}
+			local_oper.localMatrix(local_fe, local_reference);
+			Eigen::Map<Eigen::Matrix<Real,Nodes,Nodes,Eigen::RowMajor>> local_matrix(&local[std::size_t(Nodes*Nodes)*t]);
+			local_matrix = (std::sqrt(local_fe.getDet()) * local_fe.getAreaReference()) * local_reference;
 		}
-
 	}
 
-  	UInt nnodes = mesh.num_nodes();
-  	OpMat.resize(nnodes, nnodes);
-	OpMat.setFromTriplets(triplets.begin(),triplets.end());
+	pattern.assemble(local, OpMat, threads);
 	OpMat.prune(tolerance);
 }
 
@@ -157,34 +168,43 @@ void Assembler::forcingTerm(const MeshHandler<ORDER,2,3>& mesh,
 {
 
 	forcingTerm = VectorXr::Zero(mesh.num_nodes());
+	mesh.buildGeometryCache();
 
-  	for(auto t=0; t<mesh.num_elements(); t++)
-  	{
-		fe.updateElement(mesh.getElement(t));
-
-		// Vector of vertices indices (link local to global indexing system)
-		std::vector<UInt> identifiers;
-				identifiers.resize(3*ORDER);
+	// As in the planar case, the local vectors are summed in the order of the elements
+	constexpr UInt Nodes = 3*ORDER;
+	const UInt num_elements = mesh.num_elements();
+	std::vector<UInt> identifiers(Nodes*num_elements);
+	std::vector<Real> local(Nodes*num_elements);
+	const int threads = fdaPDEThreads();
 
-		for( auto q=0; q<3*ORDER; q++)
-			identifiers[q]=mesh.getElement(t)[q].id();
+	#pragma omp parallel num_threads(threads)
+	{
+		FiniteElement<Integrator, ORDER,2,3> local_fe(fe);
 
-
-		//localM=localMassMatrix(currentelem);
-		for(int i = 0; i < 3*ORDER; i++)
+		#pragma omp for schedule(static)
+		for(int t=0; t<int(num_elements); t++)
 		{
-			Real s=0;
+			const auto element = mesh.getElement(t);
+			local_fe.updateElement(element);
 
-			for(int iq = 0;iq < Integrator::NNODES; iq++)
+			for(int i = 0; i < Nodes; i++)
 			{
-				UInt globalIndex = fe.getGlobalIndex(iq);
-				s +=  fe.phiMaster(i,iq)* u(globalIndex) * std::sqrt(fe.getDet()) * fe.getAreaReference()* Integrator::WEIGHTS[iq];//(*)
+				Real s=0;
+
+				for(int iq = 0;iq < Integrator::NNODES; iq++)
+				{
+					UInt globalIndex = local_fe.getGlobalIndex(iq);
+					s +=  local_fe.phiMaster(i,iq)* u(globalIndex) * std::sqrt(local_fe.getDet()) * local_fe.getAreaReference()* Integrator::WEIGHTS[iq];//(*)
+				}
+				identifiers[Nodes*t+i] = element[i].id();
+				local[Nodes*t+i] = s;
 			}
-			forcingTerm[identifiers[i]] += s;
 		}
-
 	}
 
+	for(UInt k = 0; k < Nodes*num_elements; k++)
+		forcingTerm[identifiers[k]] += local[k];
+
 }
 
 //! Volume mesh implementation
@@ -195,39 +215,38 @@ void Assembler::operKernel(EOExpr<A> oper,const MeshHandler<ORDER,3,3>& mesh,
 {
 	Real eps = 2.2204e-016,
 		 tolerance = 10 * eps;
-	std::vector<coeff> triplets;
-
-
-  	for(auto t=0; t<mesh.num_elements(); t++)
-  	{
-		fe.updateElement(mesh.getElement(t));
-
-		// Vector of vertices indices (link local to global indexing system)
-		std::vector<UInt> identifiers;
-		identifiers.resize(6*ORDER-2);
-		for( auto q=0; q<6*ORDER-2; q++)
-			identifiers[q]=mesh.getElement(t)[q].id();
 
-		//localM=localMassMatrix(currentelem);
-		for(int i = 0; i < 6*ORDER-2; i++)
+	// geometry of the elements is computed once and reused by the following passes over the mesh
+	mesh.buildGeometryCache();
+	// so are the pattern of the matrix and the map from the local matrices to its entries
+	const auto & pattern = mesh.getAssemblyPattern();
+
+	// As in the planar case, each element fills its own slot of local values
+	constexpr UInt Nodes = 6*ORDER-2;
+	const UInt num_elements = mesh.num_elements();
+	std::vector<Real> local(std::size_t(Nodes*Nodes)*num_elements);
+	const int threads = fdaPDEThreads();
+
+	#pragma omp parallel num_threads(threads)
+	{
+		// Every thread updates its own copy of the finite element and of the operator
+		FiniteElement<Integrator, ORDER,3,3> local_fe(fe);
+		EOExpr<A> local_oper(oper);
+		Eigen::Matrix<Real,Nodes,Nodes> local_reference;
+
+		#pragma omp for schedule(static)
+		for(int t=0; t<int(num_elements); t++)
 		{
-			for(int j = 0; j < 6*ORDER-2; j++)
-			{
-				Real s=0;
+			const auto element = mesh.getElement(t);
+			local_fe.updateElement(element);
 
-				for(int l = 0;l < Integrator::NNODES; l++)
-				{
-					s += oper(fe,i,j,l) * std::sqrt(fe.getDet()) * fe.getVolumeReference()* Integrator::WEIGHTS[l];
-				}
-			  triplets.push_back(coeff(identifiers[i],identifiers[j],s));
-			}
+			local_oper.localMatrix(local_fe, local_reference);
+			Eigen::Map<Eigen::Matrix<Real,Nodes,Nodes,Eigen::RowMajor>> local_matrix(&local[std::size_t(Nodes*Nodes)*t]);
+			local_matrix = (std::sqrt(local_fe.getDet()) * local_fe.getVolumeReference()) * local_reference;
 		}
-
 	}
 
-  	UInt nnodes = mesh.num_nodes();
-  	OpMat.resize(nnodes, nnodes);
-	OpMat.setFromTriplets(triplets.begin(),triplets.end());
+	pattern.assemble(local, OpMat, threads);
 	OpMat.prune(tolerance);
 }
 
@@ -239,37 +258,117 @@ void Assembler::forcingTerm(const MeshHandler<ORDER,3,3>& mesh,
 {
 
 	forcingTerm = VectorXr::Zero(mesh.num_nodes());
+	mesh.buildGeometryCache();
 
-  	for(auto t=0; t<mesh.num_elements(); t++)
-  	{
-		fe.updateElement(mesh.getElement(t));
-
-		// Vector of vertices indices (link local to global indexing system)
-		std::vector<UInt> identifiers;
-				identifiers.resize(6*ORDER-2);
-
-		for( auto q=0; q<6*ORDER-2; q++)
-			identifiers[q]=mesh.getElement(t)[q].id();
+	// As in the planar case, the local vectors are summed in the order of the elements
+	constexpr UInt Nodes = 6*ORDER-2;
+	const UInt num_elements = mesh.num_elements();
+	std::vector<UInt> identifiers(Nodes*num_elements);
+	std::vector<Real> local(Nodes*num_elements);
+	const int threads = fdaPDEThreads();
 
+	#pragma omp parallel num_threads(threads)
+	{
+		FiniteElement<Integrator, ORDER,3,3> local_fe(fe);
 
-		//localM=localMassMatrix(currentelem);
-		for(int i = 0; i < 6*ORDER-2; i++)
+		#pragma omp for schedule(static)
+		for(int t=0; t<int(num_elements); t++)
 		{
-			Real s=0;
+			const auto element = mesh.getElement(t);
+			local_fe.updateElement(element);
 
-			for(int iq = 0;iq < Integrator::NNODES; iq++)
+			for(int i = 0; i < Nodes; i++)
 			{
-				UInt globalIndex = fe.getGlobalIndex(iq);
-				s +=  fe.phiMaster(i,iq)* u(globalIndex) * std::sqrt(fe.getDet()) * fe.getVolumeReference()* Integrator::WEIGHTS[iq];//(*)
+				Real s=0;
+
+				for(int iq = 0;iq < Integrator::NNODES; iq++)
+				{
+					UInt globalIndex = local_fe.getGlobalIndex(iq);
+					s +=  local_fe.phiMaster(i,iq)* u(globalIndex) * std::sqrt(local_fe.getDet()) * local_fe.getVolumeReference()* Integrator::WEIGHTS[iq];//(*)
+				}
+				identifiers[Nodes*t+i] = element[i].id();
+				local[Nodes*t+i] = s;
 			}
-			forcingTerm[identifiers[i]] += s;
 		}
-
 	}
 
+	for(UInt k = 0; k < Nodes*num_elements; k++)
+		forcingTerm[identifiers[k]] += local[k];
+
 }
 
+//! Fused implementation, for every mesh
+
+template<UInt ORDER, UInt mydim, UInt ndim, typename Integrator, typename A, typename B>
+void Assembler::operKernel(EOExpr<A> operA, EOExpr<B> operB, const MeshHandler<ORDER,mydim,ndim>& mesh,
+	                     FiniteElement<Integrator, ORDER,mydim,ndim>& fe, SpMat& MatA, SpMat& MatB,
+	                     const ForcingTerm* u, VectorXr* forcingTerm)
+{
+	Real eps = 2.2204e-016,
+		 tolerance = 10 * eps;
+
+	mesh.buildGeometryCache();
+	const auto & pattern = mesh.getAssemblyPattern();
+
+	// Both local matrices (and the local forcing vector) of element t are computed after a single update of the
+	// finite element, each in its own slots, then summed into the pattern as in the single operator case
+	constexpr UInt Nodes = mydim==2 ? 3*ORDER : 6*ORDER-2;
+	const UInt num_elements = mesh.num_elements();
+	std::vector<Real> localA(std::size_t(Nodes*Nodes)*num_elements), localB(std::size_t(Nodes*Nodes)*num_elements);
+	std::vector<UInt> identifiers(u ? Nodes*num_elements : 0);
+	std::vector<Real> localF(u ? Nodes*num_elements : 0);
+	const int threads = fdaPDEThreads();
+
+	#pragma omp parallel num_threads(threads)
+	{
+		FiniteElement<Integrator, ORDER,mydim,ndim> local_fe(fe);
+		EOExpr<A> local_operA(operA);
+		EOExpr<B> local_operB(operB);
+		Eigen::Matrix<Real,Nodes,Nodes> local_reference;
+
+		#pragma omp for schedule(static)
+		for(int t=0; t<int(num_elements); t++)
+		{
+			const auto element = mesh.getElement(t);
+			local_fe.updateElement(element);
+			const Real det = measure(local_fe), ref = reference(local_fe);
+
+			local_operA.localMatrix(local_fe, local_reference);
+			Eigen::Map<Eigen::Matrix<Real,Nodes,Nodes,Eigen::RowMajor>> matrixA(&localA[std::size_t(Nodes*Nodes)*t]);
+			matrixA = (det * ref) * local_reference;
+			local_operB.localMatrix(local_fe, local_reference);
+			Eigen::Map<Eigen::Matrix<Real,Nodes,Nodes,Eigen::RowMajor>> matrixB(&localB[std::size_t(Nodes*Nodes)*t]);
+			matrixB = (det * ref) * local_reference;
+
+			if(u)
+			{
+				for(int i = 0; i < Nodes; i++)
+				{
+					Real s=0;
+
+					for(int iq = 0;iq < Integrator::NNODES; iq++)
+					{
+						UInt globalIndex = local_fe.getGlobalIndex(iq);
+						s +=  local_fe.phiMaster(i,iq)* (*u)(globalIndex) * det * ref * Integrator::WEIGHTS[iq];
+					}
+					identifiers[Nodes*t+i] = element[i].id();
+					localF[Nodes*t+i] = s;
+				}
+			}
+		}
+	}
 
+	pattern.assemble(localA, MatA, threads);
+	MatA.prune(tolerance);
+	pattern.assemble(localB, MatB, threads);
+	MatB.prune(tolerance);
 
+	if(u)
+	{
+		*forcingTerm = VectorXr::Zero(mesh.num_nodes());
+		for(UInt k = 0; k < Nodes*num_elements; k++)
+			(*forcingTerm)[identifiers[k]] += localF[k];
+	}
+}
 
 #endif
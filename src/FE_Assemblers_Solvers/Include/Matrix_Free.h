@@ -0,0 +1,164 @@
+#ifndef __MATRIX_FREE_H__
+#define __MATRIX_FREE_H__
+
+#include "../../FdaPDE.h"
+#include "../../Mesh/Include/Mesh.h"
+#include "../../Global_Utilities/Include/Parallel.h"
+#include "Matrix_Assembler.h"
+
+//! Reads the R option fdaPDE.matrix.free, setting it to TRUE solves the regression without assembling its matrices (see SaddlePointOperator)
+inline bool matrixFreeOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.matrix.free"));
+	return Rf_isLogical(option) && Rf_length(option) > 0 && LOGICAL(option)[0] == TRUE;
+}
+
+class LinearOperator;
+
+namespace Eigen {
+namespace internal {
+	// A LinearOperator has the traits of a sparse matrix
+	template<>
+	struct traits<LinearOperator> : public Eigen::internal::traits<SpMat> {};
+}
+}
+
+/**	\class LinearOperator
+ * 	\brief A square matrix known only through its products with vectors.
+ *
+ *	It is an Eigen expression, so the iterative solvers of Eigen (ConjugateGradient, BiCGSTAB, MINRES, GMRES)
+ *	take it in place of a sparse matrix, with the IdentityPreconditioner or the Jacobi version of BlockPreconditioner
+ *	(see Solver.h).
+ */
+class LinearOperator : public Eigen::EigenBase<LinearOperator> {
+public:
+	typedef Real Scalar;
+	typedef Real RealScalar;
+	typedef int StorageIndex;
+	enum {
+		ColsAtCompileTime = Eigen::Dynamic,
+		MaxColsAtCompileTime = Eigen::Dynamic,
+		IsRowMajor = false
+	};
+
+	virtual ~LinearOperator() {};
+
+	virtual Eigen::Index rows() const = 0;
+	Eigen::Index cols() const { return rows(); }
+
+	/// Computes y = A x, y is resized if needed.
+	virtual void apply(const VectorXr & x, VectorXr & y) const = 0;
+	/// Computes y = A^T x, y is resized if needed.
+	virtual void applyTranspose(const VectorXr & x, VectorXr & y) const = 0;
+	/// Returns the diagonal of A.
+	virtual VectorXr diagonal() const = 0;
+
+	template<typename Rhs>
+	Eigen::Product<LinearOperator, Rhs, Eigen::AliasFreeProduct> operator*(const Eigen::MatrixBase<Rhs> & x) const
+	{
+		return Eigen::Product<LinearOperator, Rhs, Eigen::AliasFreeProduct>(*this, x.derived());
+	}
+};
+
+namespace Eigen {
+namespace internal {
+	// Its products with dense vectors call apply
+	template<typename Rhs>
+	struct generic_product_impl<LinearOperator, Rhs, SparseShape, DenseShape, GemvProduct>
+		: generic_product_impl_base<LinearOperator, Rhs, generic_product_impl<LinearOperator, Rhs> >
+	{
+		typedef typename Product<LinearOperator, Rhs>::Scalar Scalar;
+
+		template<typename Dest>
+		static void scaleAndAddTo(Dest & dst, const LinearOperator & lhs, const Rhs & rhs, const Scalar & alpha)
+		{
+			VectorXr y;
+			lhs.apply(rhs, y);
+			dst += alpha*y;
+		}
+	};
+}
+}
+
+/**	\class MatrixFreeOperator
+ * 	\brief The finite element matrix of a differential operator, applied element by element without being assembled.
+ *	\param ORDER, mydim, ndim: template parameters, those of the mesh
+ *	\param Integrator: the quadrature rule of the finite element
+ *	\param A: the expression of the operator (see EOExpr)
+ *
+ *	Every product computes the local matrices again, from the geometry cache of the mesh, as operKernel does, and
+ *	the product of each of them with the entries of x on its element. The elements are processed in parallel; then
+ *	each entry of y sums the products of the elements of its node, in the order of the elements, so the result does
+ *	not depend on the number of threads and equals the product with the matrix assembled by operKernel, up to the
+ *	order of the sums. Its memory is one index and one value per node of every element.
+ */
+template<UInt ORDER, UInt mydim, UInt ndim, typename Integrator, typename A>
+class MatrixFreeOperator : public LinearOperator {
+public:
+	static constexpr UInt Nodes = mydim==2 ? 3*ORDER : 6*ORDER-2;
+
+	/// It reads the number of threads (see fdaPDEThreads) and builds the geometry cache of the mesh, so it must be built by the main thread.
+	MatrixFreeOperator(const MeshHandler<ORDER,mydim,ndim> & mesh, const FiniteElement<Integrator,ORDER,mydim,ndim> & fe, const EOExpr<A> & oper);
+
+	Eigen::Index rows() const override { return mesh_.num_nodes(); }
+
+	void apply(const VectorXr & x, VectorXr & y) const override { product(x, y, false); }
+	void applyTranspose(const VectorXr & x, VectorXr & y) const override { product(x, y, true); }
+	VectorXr diagonal() const override;
+
+	/// Returns the memory, in bytes, used by the operator.
+	std::size_t memory() const { return (slot_start_.capacity()+slots_.capacity())*sizeof(UInt) + local_.capacity()*sizeof(Real); }
+
+private:
+	/// Calls values(element, matrix, slot) on every element, in parallel: matrix is the local matrix of the element,
+	/// with its measure, and values writes the Nodes values of the element from local_[slot].
+	template<typename Values>
+	void forEachElement(Values values) const;
+	/// Sums in y the values of local_ of each node, see slots_.
+	void gather(VectorXr & y) const;
+	void product(const VectorXr & x, VectorXr & y, bool transpose) const;
+
+	const MeshHandler<ORDER,mydim,ndim> & mesh_;
+	FiniteElement<Integrator,ORDER,mydim,ndim> fe_;
+	EOExpr<A> oper_;
+	int threads_;
+
+	/// Position in slots_ of the first slot of each node (number of nodes + 1 values).
+	std::vector<UInt> slot_start_;
+	/// The slots of the nodes, node after node: slot Nodes*t+i is the i-th node of element t, in increasing order.
+	std::vector<UInt> slots_;
+	/// One value per slot, the workspace of the products.
+	mutable std::vector<Real> local_;
+};
+
+/**	\class SaddlePointOperator
+ * 	\brief The system matrix of the spatial regression without covariates, applied block by block.
+ *
+ *	 | DMat           -lambda*R1^T |
+ *	 | -lambda*R1     -lambda*R0   |
+ *	as built by MixedFERegressionBase::buildSystemMatrix; R0 and R1 are usually MatrixFreeOperator. The matrix is
+ *	symmetric and indefinite, it is solved by MINRES.
+ */
+class SaddlePointOperator : public LinearOperator {
+public:
+	SaddlePointOperator(const SpMat & DMat, const LinearOperator & R1, const LinearOperator & R0, Real lambda = 1) :
+		DMat_(DMat), R1_(R1), R0_(R0), lambda_(lambda) {};
+
+	void setLambda(Real lambda) { lambda_ = lambda; }
+
+	Eigen::Index rows() const override { return 2*DMat_.rows(); }
+
+	void apply(const VectorXr & x, VectorXr & y) const override;
+	void applyTranspose(const VectorXr & x, VectorXr & y) const override { apply(x, y); }
+	VectorXr diagonal() const override;
+
+private:
+	const SpMat & DMat_;
+	const LinearOperator & R1_;
+	const LinearOperator & R0_;
+	Real lambda_;
+};
+
+#include "Matrix_Free_imp.h"
+
+#endif
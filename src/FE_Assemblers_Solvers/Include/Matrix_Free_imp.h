@@ -0,0 +1,133 @@
+#ifndef __MATRIX_FREE_IMP_H__
+#define __MATRIX_FREE_IMP_H__
+
+template<UInt ORDER, UInt mydim, UInt ndim, typename Integrator, typename A>
+MatrixFreeOperator<ORDER,mydim,ndim,Integrator,A>::MatrixFreeOperator(const MeshHandler<ORDER,mydim,ndim> & mesh,
+	const FiniteElement<Integrator,ORDER,mydim,ndim> & fe, const EOExpr<A> & oper) :
+	mesh_(mesh), fe_(fe), oper_(oper), threads_(fdaPDEThreads())
+{
+	mesh_.buildGeometryCache();
+
+	// The slots are counted, then listed node by node: visiting the elements in order, the slots of every
+	// node are in increasing order
+	const UInt num_nodes = mesh_.num_nodes(), num_elements = mesh_.num_elements();
+	slot_start_.assign(num_nodes+1, 0);
+	slots_.resize(Nodes*num_elements);
+	local_.resize(Nodes*num_elements);
+
+	std::vector<UInt> identifiers(Nodes*num_elements);
+	for(UInt t = 0; t < num_elements; ++t)
+	{
+		const auto element = mesh_.getElement(t);
+		for(UInt i = 0; i < Nodes; ++i)
+		{
+			identifiers[Nodes*t+i] = element[i].id();
+			++slot_start_[element[i].id()+1];
+		}
+	}
+	for(UInt n = 0; n < num_nodes; ++n)
+		slot_start_[n+1] += slot_start_[n];
+
+	std::vector<UInt> next(slot_start_.begin(), slot_start_.end()-1);
+	for(UInt k = 0; k < Nodes*num_elements; ++k)
+		slots_[next[identifiers[k]]++] = k;
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim, typename Integrator, typename A>
+template<typename Values>
+void MatrixFreeOperator<ORDER,mydim,ndim,Integrator,A>::forEachElement(Values values) const
+{
+	const UInt num_elements = mesh_.num_elements();
+
+	#pragma omp parallel num_threads(threads_)
+	{
+		// Every thread updates its own copy of the finite element and of the operator
+		FiniteElement<Integrator,ORDER,mydim,ndim> local_fe(fe_);
+		EOExpr<A> local_oper(oper_);
+		Eigen::Matrix<Real,Nodes,Nodes> local_reference, local_matrix;
+
+		#pragma omp for schedule(static)
+		for(int t = 0; t < int(num_elements); ++t)
+		{
+			const auto element = mesh_.getElement(t);
+			local_fe.updateElement(element);
+			local_oper.localMatrix(local_fe, local_reference);
+			local_matrix = (Assembler::measure(local_fe) * Assembler::reference(local_fe)) * local_reference;
+			values(element, local_matrix, Nodes*t);
+		}
+	}
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim, typename Integrator, typename A>
+void MatrixFreeOperator<ORDER,mydim,ndim,Integrator,A>::gather(VectorXr & y) const
+{
+	const UInt num_nodes = mesh_.num_nodes();
+	y.resize(num_nodes);
+
+	#pragma omp parallel for num_threads(threads_) schedule(static)
+	for(int n = 0; n < int(num_nodes); ++n)
+	{
+		Real s = 0;
+		for(UInt k = slot_start_[n]; k < slot_start_[n+1]; ++k)
+			s += local_[slots_[k]];
+		y[n] = s;
+	}
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim, typename Integrator, typename A>
+void MatrixFreeOperator<ORDER,mydim,ndim,Integrator,A>::product(const VectorXr & x, VectorXr & y, bool transpose) const
+{
+	std::vector<Real> & local = local_;
+	forEachElement([&x, &local, transpose](const Element<Nodes,mydim,ndim> & element, const Eigen::Matrix<Real,Nodes,Nodes> & matrix, UInt slot)
+	{
+		Eigen::Matrix<Real,Nodes,1> local_x;
+		for(UInt j = 0; j < Nodes; ++j)
+			local_x[j] = x[element[j].id()];
+
+		Eigen::Map<Eigen::Matrix<Real,Nodes,1>> local_y(&local[slot]);
+		if(transpose)
+			local_y.noalias() = matrix.transpose() * local_x;
+		else
+			local_y.noalias() = matrix * local_x;
+	});
+	gather(y);
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim, typename Integrator, typename A>
+VectorXr MatrixFreeOperator<ORDER,mydim,ndim,Integrator,A>::diagonal() const
+{
+	std::vector<Real> & local = local_;
+	forEachElement([&local](const Element<Nodes,mydim,ndim> &, const Eigen::Matrix<Real,Nodes,Nodes> & matrix, UInt slot)
+	{
+		Eigen::Map<Eigen::Matrix<Real,Nodes,1>> local_diagonal(&local[slot]);
+		local_diagonal = matrix.diagonal();
+	});
+
+	VectorXr d;
+	gather(d);
+	return d;
+}
+
+inline void SaddlePointOperator::apply(const VectorXr & x, VectorXr & y) const
+{
+	const Eigen::Index n = DMat_.rows();
+	VectorXr r1x1, r1tx2, r0x2;
+	R1_.apply(x.head(n), r1x1);
+	R1_.applyTranspose(x.tail(n), r1tx2);
+	R0_.apply(x.tail(n), r0x2);
+
+	y.resize(2*n);
+	y.head(n) = DMat_*x.head(n) - lambda_*r1tx2;
+	y.tail(n) = -lambda_*(r1x1 + r0x2);
+}
+
+inline VectorXr SaddlePointOperator::diagonal() const
+{
+	const Eigen::Index n = DMat_.rows();
+	VectorXr d(2*n);
+	d.head(n) = DMat_.diagonal();
+	d.tail(n) = -lambda_*R0_.diagonal();
+	return d;
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define __PROJECTION_H__
 
 #include "../../Mesh/Include/Mesh.h"
+#include "../../Mesh/Include/KD_Tree.h"
+#include "../../Global_Utilities/Include/Parallel.h"
 
 template <UInt ORDER,UInt mydim, UInt ndim>
 class projection{
@@ -10,12 +12,12 @@ class projection{
 template <UInt ORDER>
 class projection<ORDER,2,2>{
 private:
-  MeshHandler<ORDER,2,2> mesh_;
+  const MeshHandler<ORDER,2,2> & mesh_;
   const std::vector<Point> & deData_; // the points to be projected
   UInt num_points;
 
 public:
-  projection(MeshHandler<ORDER,2,2> m, const std::vector<Point> & d): mesh_(m), deData_(d), num_points(d.size()) {};
+  projection(const MeshHandler<ORDER,2,2> & m, const std::vector<Point> & d): mesh_(m), deData_(d), num_points(d.size()) {};
 
   std::vector<Point> computeProjection() {return deData_;}
 };
@@ -24,7 +26,7 @@ public:
 template<UInt ORDER>
 class projection<ORDER,2,3>{
 private:
-  MeshHandler<ORDER,2,3> mesh_;
+  const MeshHandler<ORDER,2,3> & mesh_;
   const std::vector<Point> & deData_; // the points to be projected
   UInt num_points;
 
@@ -32,12 +34,11 @@ private:
   UInt getMaxCoor(const Point& ) const;
   Real computeDistance(const Point&, const Point&) const;
   Real getAreaTriangle2d(const Point&, const Point&, const Point&) const;
-  std::vector<UInt> computeNodePatch(UInt ) const;
 
   std::pair<Point, Real> project(const Element<3*ORDER,2,3>& , const Point& ) const;
 
 public:
-  projection(MeshHandler<ORDER,2,3> m, const std::vector<Point> & d): mesh_(m), deData_(d), num_points(d.size()) {};
+  projection(const MeshHandler<ORDER,2,3> & m, const std::vector<Point> & d): mesh_(m), deData_(d), num_points(d.size()) {};
 
   std::vector<Point> computeProjection();
 
@@ -47,12 +48,12 @@ public:
 template <UInt ORDER>
 class projection<ORDER,3,3>{
 private:
-  MeshHandler<ORDER,3,3> mesh_;
+  const MeshHandler<ORDER,3,3> & mesh_;
   const std::vector<Point> & deData_; // the points to be projected
   UInt num_points;
 
 public:
-  projection(MeshHandler<ORDER,3,3> m, const std::vector<Point> & d): mesh_(m), deData_(d), num_points(d.size()) {};
+  projection(const MeshHandler<ORDER,3,3> & m, const std::vector<Point> & d): mesh_(m), deData_(d), num_points(d.size()) {};
 
   std::vector<Point> computeProjection() {return deData_;}
 };
@@ -31,25 +31,6 @@ Real projection<ORDER,2,3>::getAreaTriangle2d(const Point& A, const Point& B, co
   return (0.5*det);
 }
 
-template<UInt ORDER>
-std::vector<UInt> projection<ORDER,2,3>::computeNodePatch(UInt id_node) const
-{
-  std::vector<UInt> patch_node;
-  constexpr UInt Nodes = 3*ORDER;
-
-  for(UInt t=0; t<mesh_.num_elements(); t++){
-    Element<Nodes, 2, 3> current_element = mesh_.getElement(t);
-    bool exit = false;
-    for(UInt i=0; i<Nodes && exit==false ; i++){
-      if(current_element[i].id() == id_node){
-        patch_node.push_back(t);
-        exit = true;
-      }
-    }
-  }
-  return patch_node;
-}
-
 template<UInt ORDER>
 std::pair<Point, Real> projection<ORDER,2,3>::project(const Element<3*ORDER,2,3>& triangle ,const Point& P) const
 {
@@ -62,7 +43,7 @@ std::pair<Point, Real> projection<ORDER,2,3>::project(const Element<3*ORDER,2,3>
   Real nx = (B[1]-A[1])*(C[2]-A[2]) - (B[2]-A[2])*(C[1]-A[1]);
   Real ny = (B[2]-A[2])*(C[0]-A[0]) - (B[0]-A[0])*(C[2]-A[2]);
   Real nz = (B[0]-A[0])*(C[1]-A[1]) - (B[1]-A[1])*(C[0]-A[0]);
-  VectorXr n(3); // ndim
+  Eigen::Matrix<Real,3,1> n; // ndim
   n << nx, ny, nz;
   n.normalize();
   nx = n[0];
@@ -108,7 +89,7 @@ std::pair<Point, Real> projection<ORDER,2,3>::project(const Element<3*ORDER,2,3>
   // edge
 
   if(lambda[0]>0 && lambda[1]>0 && lambda[2]<0){
-    VectorXr pt_A(3), B_A(3), proj_AB(3), vecA(3);
+    Eigen::Matrix<Real,3,1> pt_A, B_A, proj_AB, vecA;
     pt_A << pt[0]-A[0], pt[1]-A[1], pt[2]-A[2];
     B_A << B[0]-A[0], B[1]-A[1], B[2]-A[2];
     vecA << A[0], A[1], A[2];
@@ -131,7 +112,7 @@ std::pair<Point, Real> projection<ORDER,2,3>::project(const Element<3*ORDER,2,3>
   }
 
   if(lambda[0]>0 && lambda[1]<0 && lambda[2]>0){
-    VectorXr pt_A(3), C_A(3), proj_AC(3), vecA(3);
+    Eigen::Matrix<Real,3,1> pt_A, C_A, proj_AC, vecA;
     pt_A << pt[0]-A[0], pt[1]-A[1], pt[2]-A[2];
     C_A << C[0]-A[0], C[1]-A[1], C[2]-A[2];
     vecA << A[0], A[1], A[2];
@@ -154,7 +135,7 @@ std::pair<Point, Real> projection<ORDER,2,3>::project(const Element<3*ORDER,2,3>
   }
 
   if(lambda[0]<0 && lambda[1]>0 && lambda[2]>0){
-    VectorXr pt_B(3), C_B(3), proj_BC(3), vecB(3);
+    Eigen::Matrix<Real,3,1> pt_B, C_B, proj_BC, vecB;
     pt_B << pt[0]-B[0], pt[1]-B[1], pt[2]-B[2];
     C_B << C[0]-B[0], C[1]-B[1], C[2]-B[2];
     vecB << B[0], B[1], B[2];
@@ -187,34 +168,31 @@ std::vector<Point> projection<ORDER,2,3>::computeProjection()
   std::vector<Point> res;
   res.resize(getNumPoints());
 
-  // (1): nearest node to each point
-  std::vector<UInt> nearest_node;
-  nearest_node.reserve(getNumPoints());
-
-  for(UInt d=0; d<getNumPoints(); d++){
-    std::pair<Real, UInt> min_dist (computeDistance(deData_[d], mesh_.getPoint(0)), 0);
-    Real dist;
-    for(UInt n=1; n<mesh_.num_nodes(); n++){
-      dist = computeDistance(deData_[d], mesh_.getPoint(n));
-      if(dist < min_dist.first) min_dist = std::make_pair(dist, n);
-    }
-    nearest_node.push_back(min_dist.second);
+  // (1): k-d tree of the nodes, for the nearest node to each point
+  std::vector<Real> nodes(3*mesh_.num_nodes());
+  for(UInt n=0; n<mesh_.num_nodes(); n++){
+    Point node = mesh_.getPoint(n);
+    for(UInt k=0; k<3; k++)
+      nodes[3*n+k] = node[k];
   }
+  KDTree<3> node_tree(nodes.data(), mesh_.num_nodes());
 
-  // (2): patch of the nearest node to each point
-  std::vector<std::vector<UInt>> patch_element; // for each node -> id of elements that contains the node
-  patch_element.reserve(getNumPoints());
-  for(UInt i=0; i<getNumPoints(); i++){
-    patch_element.push_back(computeNodePatch(nearest_node[i]));
-  }
+  // (2): patch of every node (id of the elements that contain the node), from the adjacency tables of the mesh
+  const MeshAdjacency<Element<3*ORDER,2,3>> & adjacency = mesh_.getAdjacency();
 
-  // (3): I project each data in the patch of the nearest node
-  for(UInt i=0; i<getNumPoints(); i++){
+  // (3): I project each data in the patch of its nearest node, the points are independent
+  mesh_.buildGeometryCache();
+  const int threads = fdaPDEThreads();
+  #pragma omp parallel for num_threads(threads) schedule(dynamic, 64)
+  for(int i=0; i<int(getNumPoints()); i++){
+    UInt nearest_node = node_tree.nearest(deData_[i]);
     Real dist = std::numeric_limits<Real>::max();
-    Point new_datum;
-    for(auto elem: patch_element[i]){
+    const UInt * patch_begin;
+    const UInt * patch_end;
+    adjacency.nodeElements(nearest_node, patch_begin, patch_end);
+    for(const UInt * k=patch_begin; k!=patch_end; k++){
       constexpr UInt Nodes = 3*ORDER;
-      Element<Nodes, 2, 3> element = mesh_.getElement(elem);
+      Element<Nodes, 2, 3> element = mesh_.getElement(*k);
       std::pair<Point, Real> proj = project(element, deData_[i]);
 
       if(proj.second < dist){
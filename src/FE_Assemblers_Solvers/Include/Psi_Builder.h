@@ -0,0 +1,60 @@
+#ifndef __PSI_BUILDER_H__
+#define __PSI_BUILDER_H__
+
+#include "../../FdaPDE.h"
+#include "../../Mesh/Include/Mesh.h"
+#include "../../Global_Utilities/Include/Parallel.h"
+#include "Integrate_Psi.h"
+
+/**	\class PsiBuilder
+ * 	\brief Builds the matrix Psi of the values of the basis functions at the locations of the data.
+ *	\param ORDER, mydim, ndim: template parameters, those of the mesh
+ *
+ *	Row i of Psi holds the values of the basis functions at location i (at most one element per row,
+ *	so at most Nodes entries), or their means over region i for areal data. The locations are searched
+ *	and the rows computed in parallel; the entries are then written directly in compressed storage.
+ *	No R function is called by the threads: the locations outside the domain are returned to the
+ *	caller, which reports them.
+ */
+template<UInt ORDER, UInt mydim, UInt ndim>
+class PsiBuilder {
+public:
+	static constexpr UInt Nodes = mydim==2 ? 3*ORDER : 6*ORDER-2;
+
+	/** It reads the number of threads (see fdaPDEThreads), so it must be built by the main thread.
+	 *	\param search The search algorithm for the locations: 1 naive, 2 tree, 3 walking, 4 grid (built by locate if needed).
+	 */
+	PsiBuilder(const MeshHandler<ORDER,mydim,ndim> & mesh, UInt search);
+
+	/// Returns the ids of the elements containing the points, Identifier::NVAL for the points outside the domain.
+	std::vector<Id> locate(const std::vector<Point> & points) const;
+
+	/** Psi for pointwise data.
+	 *	\param[in] points The locations.
+	 *	\param[in] elements The elements containing them (see locate), the rows of Psi of the points outside are empty.
+	 *	\param[out] psi The matrix, points.size() x number of nodes.
+	 *	\param[out] values If not null, the values of the basis functions of the element of each point (by row).
+	 *	\param[out] barycenters If not null, the barycentric coordinates of each point in its element (by row, in the
+	 *	first mydim+1 of Nodes columns).
+	 */
+	void pointwise(const std::vector<Point> & points, const std::vector<Id> & elements, SpMat & psi,
+		MatrixXr * values = nullptr, MatrixXr * barycenters = nullptr) const;
+
+	/// Psi for pointwise data located by barycenters: the entries of row i are barycenters.row(i), in the nodes of element elements(i).
+	void byBarycenters(const VectorXi & elements, const MatrixXr & barycenters, SpMat & psi) const;
+
+	/// Psi for areal data: row i is the mean of the basis functions over the elements j with incidence(i,j) == 1, measures(i) the area of the region.
+	void areal(const MatrixXi & incidence, const VectorXr & measures, SpMat & psi) const;
+
+private:
+	/// Builds psi from its rows in compressed storage: the entries of row i are in positions start[i], ..., start[i+1]-1.
+	void compress(const std::vector<UInt> & start, const std::vector<UInt> & columns, const std::vector<Real> & entries, SpMat & psi) const;
+
+	const MeshHandler<ORDER,mydim,ndim> & mesh_;
+	UInt search_;
+	int threads_;
+};
+
+#include "Psi_Builder_imp.h"
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef __PSI_BUILDER_IMP_H__
+#define __PSI_BUILDER_IMP_H__
+
+template<UInt ORDER, UInt mydim, UInt ndim>
+PsiBuilder<ORDER,mydim,ndim>::PsiBuilder(const MeshHandler<ORDER,mydim,ndim> & mesh, UInt search):
+	mesh_(mesh), search_(search), threads_(fdaPDEThreads())
+{
+	// The geometry of the elements, read by the threads, is built here once
+	mesh_.buildGeometryCache();
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim>
+std::vector<Id> PsiBuilder<ORDER,mydim,ndim>::locate(const std::vector<Point> & points) const
+{
+	if(search_ == 2 || search_ == 3) //use Tree (default) or Walking search, the batch search is parallel
+		return mesh_.findLocationBatch(points);
+
+	if(search_ == 4) // the buckets are filled here if the mesh has not been built for the grid search
+		mesh_.buildGrid();
+
+	std::vector<Id> elements(points.size(), Identifier::NVAL);
+	#pragma omp parallel for num_threads(threads_) schedule(dynamic, 256)
+	for(int i = 0; i < int(points.size()); ++i)
+	{
+		if(search_ == 1) //use Naive search
+			elements[i] = mesh_.findLocationNaive(points[i]).getId();
+		else if(search_ == 4) //use Grid search
+			elements[i] = mesh_.findLocationGrid(points[i]).getId();
+	}
+	return elements;
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim>
+void PsiBuilder<ORDER,mydim,ndim>::pointwise(const std::vector<Point> & points, const std::vector<Id> & elements, SpMat & psi,
+	MatrixXr * values, MatrixXr * barycenters) const
+{
+	const UInt nlocations = points.size();
+	if(values)
+		values->setZero(nlocations, Nodes);
+	if(barycenters)
+		barycenters->setZero(nlocations, Nodes);
+
+	// Every row has room for Nodes entries, the rows of the points outside the domain are left empty
+	std::vector<UInt> start(nlocations+1);
+	std::vector<UInt> columns(Nodes*nlocations);
+	std::vector<Real> entries(Nodes*nlocations);
+
+	#pragma omp parallel for num_threads(threads_) schedule(static)
+	for(int i = 0; i < int(nlocations); ++i)
+	{
+		if(elements[i] == Identifier::NVAL)
+		{
+			start[i+1] = 0;
+			continue;
+		}
+		Element<Nodes,mydim,ndim> tri_activated = mesh_.getElement(elements[i]);
+		Eigen::Matrix<Real,Nodes,1> evaluator = evaluate_basis<Nodes,mydim,ndim>(tri_activated, points[i]);
+		for(UInt node = 0; node < Nodes; ++node)
+		{
+			columns[Nodes*i + node] = tri_activated[node].getId();
+			entries[Nodes*i + node] = evaluator(node);
+		}
+		start[i+1] = Nodes;
+
+		if(values)
+			values->row(i) = evaluator.transpose();
+		if(barycenters)
+			barycenters->row(i).head(mydim+1) = tri_activated.getBaryCoordinates(points[i]).transpose();
+	}
+
+	// Remove the room of the empty rows
+	start[0] = 0;
+	for(UInt i = 0; i < nlocations; ++i)
+	{
+		const UInt count = start[i+1];
+		start[i+1] = start[i] + count;
+		if(count != 0 && start[i] != Nodes*i)
+			for(UInt node = 0; node < Nodes; ++node)
+			{
+				columns[start[i] + node] = columns[Nodes*i + node];
+				entries[start[i] + node] = entries[Nodes*i + node];
+			}
+	}
+
+	compress(start, columns, entries, psi);
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim>
+void PsiBuilder<ORDER,mydim,ndim>::byBarycenters(const VectorXi & elements, const MatrixXr & barycenters, SpMat & psi) const
+{
+	const UInt nlocations = elements.size();
+	std::vector<UInt> start(nlocations+1, 0);
+	for(UInt i = 0; i < nlocations; ++i)
+		start[i+1] = start[i] + ((elements(i) >= 0 && elements(i) < mesh_.num_elements()) ? Nodes : 0);
+
+	std::vector<UInt> columns(start.back());
+	std::vector<Real> entries(start.back());
+
+	#pragma omp parallel for num_threads(threads_) schedule(static)
+	for(int i = 0; i < int(nlocations); ++i)
+	{
+		if(start[i+1] == start[i])
+			continue;
+		// We already know the id of the element containing the point and the values to add
+		Element<Nodes,mydim,ndim> tri_activated = mesh_.getElement(elements(i));
+		for(UInt node = 0; node < Nodes; ++node)
+		{
+			columns[start[i] + node] = tri_activated[node].getId();
+			entries[start[i] + node] = barycenters(i,node);
+		}
+	}
+
+	compress(start, columns, entries, psi);
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim>
+void PsiBuilder<ORDER,mydim,ndim>::areal(const MatrixXi & incidence, const VectorXr & measures, SpMat & psi) const
+{
+	const UInt nregions = incidence.rows();
+	const UInt nnodes = mesh_.num_nodes();
+
+	// Elements of every region, reading the (column major) incidence matrix by columns
+	std::vector<std::vector<UInt>> region_elements(nregions);
+	for(UInt j = 0; j < incidence.cols(); ++j)
+		for(UInt i = 0; i < nregions; ++i)
+			if(incidence(i,j) == 1) // Element j is in region i
+				region_elements[i].push_back(j);
+
+	// Row i is accumulated in a dense vector owned by the thread, the touched nodes are then stored in order
+	std::vector<std::vector<UInt>> row_columns(nregions);
+	std::vector<std::vector<Real>> row_entries(nregions);
+
+	#pragma omp parallel num_threads(threads_)
+	{
+		std::vector<Real> tab(nnodes, 0.); // Psi_i temporary storage
+		std::vector<UInt> touched;
+
+		#pragma omp for schedule(dynamic)
+		for(int i = 0; i < int(nregions); ++i)
+		{
+			touched.clear();
+			for(UInt j : region_elements[i])
+			{
+				Element<Nodes,mydim,ndim> tri = mesh_.getElement(j); // Identify the element
+				for(UInt k = 0; k < Nodes; ++k)
+				{ // Add contribution of the area to right location
+					if(tab[tri[k].getId()] == 0)
+						touched.push_back(tri[k].getId());
+					tab[tri[k].getId()] += integratePsi(tri,k); // Integral over tri of psi_k
+				}
+			}
+			std::sort(touched.begin(), touched.end());
+			touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+			for(UInt k : touched)
+			{
+				if(tab[k] != 0) // Relevant change
+				{
+					row_columns[i].push_back(k);
+					row_entries[i].push_back(tab[k]/measures(i)); // Divide by |D_i|
+				}
+				tab[k] = 0;
+			}
+		}
+	}
+
+	std::vector<UInt> start(nregions+1, 0);
+	for(UInt i = 0; i < nregions; ++i)
+		start[i+1] = start[i] + row_columns[i].size();
+	std::vector<UInt> columns;
+	std::vector<Real> entries;
+	columns.reserve(start.back());
+	entries.reserve(start.back());
+	for(UInt i = 0; i < nregions; ++i)
+	{
+		columns.insert(columns.end(), row_columns[i].begin(), row_columns[i].end());
+		entries.insert(entries.end(), row_entries[i].begin(), row_entries[i].end());
+	}
+
+	compress(start, columns, entries, psi);
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim>
+void PsiBuilder<ORDER,mydim,ndim>::compress(const std::vector<UInt> & start, const std::vector<UInt> & columns, const std::vector<Real> & entries, SpMat & psi) const
+{
+	// The rows are viewed as a row major matrix, the assignment turns it in the column major Psi
+	Eigen::Map<const Eigen::SparseMatrix<Real, Eigen::RowMajor, UInt>> rows(start.size()-1, mesh_.num_nodes(), start.back(),
+		start.data(), columns.data(), entries.data());
+	psi = rows;
+	psi.makeCompressed();
+}
+
+#endif
@@ -1,7 +1,10 @@
 #ifndef __SOLVER_H__
 #define __SOLVER_H__
 
+#include <algorithm>
+#include <unsupported/Eigen/IterativeSolvers>
 #include "../../FdaPDE.h"
+#include "../../Global_Utilities/Include/Solver_Definitions.h"
 
 //!  A Linear System QR solver class
 /*!
@@ -42,15 +45,15 @@ class Cholesky{
 	static void solve(MatrixXr const & A, VectorXr const & b,VectorXr &x){x=A.ldlt().solve(b);};
 };
 
-//!  A Linear System LU sparse solver class
+//!  A Linear System Conjugate Gradient sparse solver class
 /*!
- * This class gives offers a standard interface to the LU resolutor for sparse matrices.
+ * This class gives offers a standard interface to the Conjugate Gradient resolutor for sparse matrices.
 */
-class SpLU{
+class SpConjGrad{
 	public:
 	static void solve(SpMat const & A, VectorXr const & b, VectorXr &x )
 	{
-		Eigen::SparseLU<SpMat> solver;
+		Eigen::ConjugateGradient<SpMat> solver;
 		solver.compute(A);
 		if(solver.info()!=Eigen::Success){
 		//std::cerr<<"Decomposition failed!"<<std::endl;
@@ -63,15 +66,16 @@ class SpLU{
 	};
 };
 
-//!  A Linear System QR sparse solver class
+//!  A Linear System BiConjugate Gradient stabilized sparse solver class
 /*!
- * This class gives offers a standard interface to the QR resolutor for sparse matrices.
+ * This class gives offers a standard interface to the BiConjugate Gradient stabilized resolutor for sparse matrices.
 */
-class SpQR{
+
+class BiCGSTAB{
 	public:
 	static void solve(SpMat const & A, VectorXr const & b, VectorXr &x )
 	{
-		Eigen::SparseQR<SpMat,Eigen::COLAMDOrdering<int> > solver;
+		Eigen::BiCGSTAB<SpMat> solver;
 		solver.compute(A);
 		if(solver.info()!=Eigen::Success){
 		//std::cerr<<"Decomposition failed!"<<std::endl;
@@ -84,15 +88,16 @@ class SpQR{
 	};
 };
 
-//!  A Linear System Cholesky sparse solver class
+//!  A Linear System BiConjugate Gradient stabilized with Incomplete LUT preconditioner sparse solver class
 /*!
- * This class gives offers a standard interface to the Cholesky resolutor for sparse matrices.
+ * This class gives offers a standard interface to the BiConjugate Gradient stabilized BiConjugate Gradient stabilized with Incomplete LUT preconditioner resolutor for sparse matrices.
 */
-class SpCholesky{
+
+class BiCGSTABILUT{
 	public:
 	static void solve(SpMat const & A, VectorXr const & b, VectorXr &x )
 	{
-		Eigen::SimplicialLDLT<SpMat> solver;
+		Eigen::BiCGSTAB<SpMat,Eigen::IncompleteLUT<Real>> solver;
 		solver.compute(A);
 		if(solver.info()!=Eigen::Success){
 		//std::cerr<<"Decomposition failed!"<<std::endl;
@@ -105,69 +110,270 @@ class SpCholesky{
 	};
 };
 
-//!  A Linear System Conjugate Gradient sparse solver class
+//! Returns the diagonal of the HRZ lumping of a mass matrix: its diagonal, scaled to keep the sum of all its entries
 /*!
- * This class gives offers a standard interface to the Conjugate Gradient resolutor for sparse matrices.
+ * Unlike the row sums, it stays positive on quadratic elements, whose vertex basis functions integrate to 0. On a mesh
+ * of affine elements of one order the scaling is the same for every element, so it is the lumping of each element; on
+ * linear elements it equals the row sums.
 */
-class SpConjGrad{
+inline VectorXr lumpedMass(const SpMat & M)
+{
+	const VectorXr d = M.diagonal();
+	return d*(M.sum()/d.sum());
+}
+
+//!  A block diagonal preconditioner class for symmetric saddle point matrices
+/*!
+ * For a matrix | A  B^T | with C negative definite, it approximates diag(A - B^T * C^-1 * B, -C). C is replaced by the
+ *              | B  C   |
+ * diagonal matrix Cl of its lumping (see lumpedMass, C being a multiple of a mass matrix) and the Schur complement by Z^T * |Cl|^-1 * Z, with Z = |Cl|^1/2 * diag(A)^1/2 - B,
+ * which matches both of its terms: only Z, with the pattern of B, is factorized, by the sparse LU of the library chosen with
+ * fdaPDE.sparse.solver (see SparseFactorization). Both blocks are positive
+ * definite, as MINRES requires, and the number of iterations depends little on the scale of B. Incomplete factorizations
+ * of the Schur complement, or of Z, would save the memory of the fill-in but need many more iterations when B dominates.
+ * Without blocks it is the Jacobi preconditioner, the inverse of the absolute values of the diagonal. It offers the
+ * interface of the Eigen preconditioners.
+*/
+class BlockPreconditioner{
 	public:
-	static void solve(SpMat const & A, VectorXr const & b, VectorXr &x )
+	//! Computes the blocks from a saddle point matrix whose first block has n rows, the next calls of compute keep them
+	void setBlocks(const SpMat & A, UInt n)
 	{
-		Eigen::ConjugateGradient<SpMat> solver;
-		solver.compute(A);
-		if(solver.info()!=Eigen::Success){
-		//std::cerr<<"Decomposition failed!"<<std::endl;
-		}
-		x=solver.solve(b);
-		if(solver.info()!=Eigen::Success)
+		const UInt m = A.rows()-n;
+		SpMat Z = -A.bottomLeftCorner(m,n);
+		scaling_ = lumpedMass(A.bottomRightCorner(m,m)).cwiseAbs();
+		for(UInt i=0; i<m; ++i)
+			if(!(scaling_[i] > 0))
+				scaling_[i] = 1;	// a null or degenerate block of C would make the preconditioner singular
+		for(UInt i=0; i<std::min(n,m); ++i)
+			Z.coeffRef(i,i) += std::sqrt(scaling_[i]*std::max(A.coeff(i,i), Real(0)));
+		Z.makeCompressed();
+
+		// The ordering is kept while the pattern of Z does not change
+		const bool samePattern = hasBlocks_ && Z.nonZeros()==Z_.nonZeros() &&
+			std::equal(Z.outerIndexPtr(), Z.outerIndexPtr()+Z.outerSize()+1, Z_.outerIndexPtr()) &&
+			std::equal(Z.innerIndexPtr(), Z.innerIndexPtr()+Z.nonZeros(), Z_.innerIndexPtr());
+		Z_ = std::move(Z);	// kept alive, some libraries read it when solving
+		if(!samePattern)
+			first_.analyzePattern(Z_);
+		first_.factorize(Z_);
+		inverse_ = scaling_.cwiseInverse();
+		n_ = n;
+		hasBlocks_ = true;
+	}
+
+	template<typename MatType>
+	BlockPreconditioner & analyzePattern(const MatType &) {return *this;}
+
+	template<typename MatType>
+	BlockPreconditioner & factorize(const MatType & mat)
+	{
+		if(!hasBlocks_)
 		{
-		//std::cerr<<"solving failed!"<<std::endl;
+			inverse_ = diagonal(mat).cwiseAbs();
+			for(UInt i=0; i<inverse_.size(); ++i)
+				inverse_[i] = (inverse_[i]==0) ? 1 : 1/inverse_[i];
 		}
-	};
+		return *this;
+	}
+
+	template<typename MatType>
+	BlockPreconditioner & compute(const MatType & mat) {return factorize(mat);}
+
+	template<typename Rhs>
+	VectorXr solve(const Rhs & b) const
+	{
+		if(!hasBlocks_)
+			return inverse_.asDiagonal()*b;
+		VectorXr x(b.rows());
+		VectorXr y = first_.solveTranspose(b.head(n_));
+		x.head(n_) = first_.solve(scaling_.asDiagonal()*y);
+		x.tail(b.rows()-n_) = inverse_.asDiagonal()*b.tail(b.rows()-n_);
+		return x;
+	}
+
+	Eigen::ComputationInfo info() {return hasBlocks_ ? first_.info() : Eigen::Success;}
+
+	private:
+	template<typename MatType>
+	static VectorXr diagonal(const Eigen::SparseMatrixBase<MatType> & mat)
+	{
+		VectorXr d(mat.rows());
+		for(UInt i=0; i<mat.rows(); ++i)
+			d[i] = mat.derived().coeff(i,i);
+		return d;
+	}
+	template<typename MatType>
+	static VectorXr diagonal(const Eigen::EigenBase<MatType> & mat) {return mat.derived().diagonal();}
+
+	bool hasBlocks_ = false;
+	UInt n_ = 0;
+	SpMat Z_;
+	SparseFactorization first_;	//!< Factorization of Z
+	VectorXr scaling_;	//!< |Cl|
+	VectorXr inverse_;	//!< Inverse of the second block, or of the diagonal
 };
 
-//!  A Linear System BiConjugate Gradient stabilized sparse solver class
+//!  A MINRES solver class for symmetric saddle point systems
 /*!
- * This class gives offers a standard interface to the BiConjugate Gradient stabilized resolutor for sparse matrices.
+ * This class solves the systems column by column with MINRES, to a relative residual below the tolerance, preconditioned by
+ * the BlockPreconditioner. It keeps the largest number of iterations and relative residual of the last solve and of all of
+ * them, and warns when a column does not converge. MatrixType is SpMat or a matrix known only through its products (see
+ * LinearOperator), for which only the Jacobi preconditioner is available.
 */
-
-class BiCGSTAB{
+template<typename MatrixType>
+class SaddlePointMINRES{
 	public:
-	static void solve(SpMat const & A, VectorXr const & b, VectorXr &x )
+	void setTolerance(Real tolerance) {solver_.setTolerance(tolerance);}
+
+	//! Computes the Jacobi preconditioner of A
+	void compute(const MatrixType & A)
 	{
-		Eigen::BiCGSTAB<SpMat> solver;
-		solver.compute(A);
-		if(solver.info()!=Eigen::Success){
-		//std::cerr<<"Decomposition failed!"<<std::endl;
-		}
-		x=solver.solve(b);
-		if(solver.info()!=Eigen::Success)
+		solver_.setMaxIterations(20*A.rows());
+		solver_.compute(A);
+	}
+
+	//! Computes the block preconditioner of A, whose first block has n rows
+	void compute(const MatrixType & A, UInt n)
+	{
+		solver_.preconditioner().setBlocks(A, n);
+		compute(A);
+	}
+
+	template<typename Derived>
+	MatrixXr solve(const Eigen::MatrixBase<Derived> & b)
+	{
+		MatrixXr x(b.rows(), b.cols());
+		iterations_ = 0;
+		error_ = 0;
+		for(UInt j=0; j<b.cols(); ++j)
 		{
-		//std::cerr<<"solving failed!"<<std::endl;
+			VectorXr bj = b.col(j);
+			x.col(j) = solver_.solve(bj);
+			iterations_ = std::max(iterations_, UInt(solver_.iterations()));
+			error_ = std::max(error_, Real(solver_.error()));
+			if(solver_.info()!=Eigen::Success)
+				Rprintf("WARNING: MINRES did not converge, relative residual %e after %d iterations\n", solver_.error(), int(solver_.iterations()));
 		}
-	};
+		maxIterations_ = std::max(maxIterations_, iterations_);
+		maxError_ = std::max(maxError_, error_);
+		return x;
+	}
+
+	UInt iterations() const {return iterations_;}
+	Real error() const {return error_;}
+	UInt maxIterations() const {return maxIterations_;}
+	Real maxError() const {return maxError_;}
+
+	private:
+	Eigen::MINRES<MatrixType, Eigen::Lower|Eigen::Upper, BlockPreconditioner> solver_;
+	UInt iterations_ = 0, maxIterations_ = 0;
+	Real error_ = 0, maxError_ = 0;
 };
 
-//!  A Linear System BiConjugate Gradient stabilized with Incomplete LUT preconditioner sparse solver class
+//!  A conjugate gradient for the family of shifted systems (M + sigma_j*K)*x = b, solved together for all the shifts
 /*!
- * This class gives offers a standard interface to the BiConjugate Gradient stabilized BiConjugate Gradient stabilized with Incomplete LUT preconditioner resolutor for sparse matrices.
+ * M is symmetric positive definite, K symmetric positive semidefinite and the shifts sigma_j positive. With c_j = 1/sigma_j
+ * the systems read (M^-1*K + c_j*I)*x/c_j = M^-1*b, whose Krylov spaces do not depend on c_j: the conjugate gradient of the
+ * smallest c_j, the worst conditioned system, in the scalar product of M gives the iterates of all the others through the
+ * recurrences of the shifted CG, at the cost of one solve with M and one product by K and by M per iteration. Only F*x is
+ * built for each shift, F being a sparse projection of the solution [e.g. Psi], so that the memory is that of b plus the
+ * projections. Each column of b is solved independently; a pair (shift, column) stops being updated once its relative
+ * residual, in the norm of M^-1, is below the tolerance. The largest number of iterations and relative residual of the
+ * last solve and of all of them are kept, as in SaddlePointMINRES.
 */
-
-class BiCGSTABILUT{
+class MultiShiftCG{
 	public:
-	static void solve(SpMat const & A, VectorXr const & b, VectorXr &x )
+	void setTolerance(Real tolerance) {tolerance_ = tolerance;}
+	void setMaxIterations(UInt maxIterations) {iterationLimit_ = maxIterations;}
+
+	//! Returns c_j*F*x_j for every shift sigma_j = 1/c_j, Mdec being a factorization of M
+	template<typename Factorization>
+	std::vector<MatrixXr> solve(const Factorization & Mdec, const SpMat & M, const SpMat & K, const std::vector<Real> & sigmas, const MatrixXr & b, const SpMat & F)
 	{
-		Eigen::BiCGSTAB<SpMat,Eigen::IncompleteLUT<Real>> solver;
-		solver.compute(A);
-		if(solver.info()!=Eigen::Success){
-		//std::cerr<<"Decomposition failed!"<<std::endl;
-		}
-		x=solver.solve(b);
-		if(solver.info()!=Eigen::Success)
+		typedef Eigen::Array<Real, Eigen::Dynamic, 1> ArrayXr;
+		const UInt nshifts = sigmas.size(), m = b.cols();
+
+		VectorXr c(nshifts);
+		for(UInt j=0; j<nshifts; ++j)
+			c[j] = 1/sigmas[j];
+		const Real cs = c.minCoeff();	// seed system
+
+		MatrixXr rho = b;			// M times the residual of the seed system
+		MatrixXr r = Mdec.solve(rho);		// residual of the seed system
+		MatrixXr p = r;
+		ArrayXr rr = (rho.array()*r.array()).colwise().sum().transpose();
+		const ArrayXr bnorm = rr.sqrt();
+
+		const MatrixXr Fr0 = F*r;
+		std::vector<MatrixXr> Fx(nshifts, MatrixXr::Zero(F.rows(), m)), Fp(nshifts, Fr0);
+		MatrixXr zeta = MatrixXr::Ones(nshifts, m), zetaOld = MatrixXr::Ones(nshifts, m), residual = MatrixXr::Zero(nshifts, m);
+		Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic> active(nshifts, m);
+		for(UInt i=0; i<m; ++i)
+			active.col(i).setConstant(bnorm[i]>0);	// x = 0 solves the systems with a null right hand side
+		ArrayXr alphaOld = ArrayXr::Ones(m), betaOld = ArrayXr::Zero(m);
+
+		UInt k = 0;
+		for(; k<iterationLimit_ && active.any(); ++k)
 		{
-		//std::cerr<<"solving failed!"<<std::endl;
+			const MatrixXr Ap = K*p + cs*(M*p);
+			const ArrayXr pAp = (p.array()*Ap.array()).colwise().sum().transpose();
+			ArrayXr alpha = ArrayXr::Zero(m), beta = ArrayXr::Zero(m);
+			for(UInt i=0; i<m; ++i)
+				if(pAp[i]>0)
+					alpha[i] = rr[i]/pAp[i];
+			rho -= Ap*alpha.matrix().asDiagonal();
+			r = Mdec.solve(rho);
+			const ArrayXr rrNew = (rho.array()*r.array()).colwise().sum().transpose();
+			for(UInt i=0; i<m; ++i)
+				if(rr[i]>0)
+					beta[i] = rrNew[i]/rr[i];
+
+			const MatrixXr Fr = F*r;
+			for(UInt j=0; j<nshifts; ++j)
+				for(UInt i=0; i<m; ++i)
+				{
+					if(!active(j,i))
+						continue;
+					const Real zetaNew = zeta(j,i)*zetaOld(j,i)*alphaOld[i]/
+						(alpha[i]*betaOld[i]*(zetaOld(j,i)-zeta(j,i)) + zetaOld(j,i)*alphaOld[i]*(1+alpha[i]*(c[j]-cs)));
+					const Real ratio = zetaNew/zeta(j,i);
+					Fx[j].col(i) += (alpha[i]*ratio)*Fp[j].col(i);
+					Fp[j].col(i) = zetaNew*Fr.col(i) + (ratio*ratio*beta[i])*Fp[j].col(i);
+					zetaOld(j,i) = zeta(j,i);
+					zeta(j,i) = zetaNew;
+					residual(j,i) = std::abs(zetaNew)*std::sqrt(std::max(rrNew[i], Real(0)))/bnorm[i];
+					if(!(residual(j,i)>=tolerance_))
+						active(j,i) = false;
+				}
+
+			p = r + p*beta.matrix().asDiagonal();
+			rr = rrNew;
+			alphaOld = alpha;
+			betaOld = beta;
 		}
-	};
+
+		for(UInt j=0; j<nshifts; ++j)
+			Fx[j] *= c[j];
+		iterations_ = k;
+		error_ = residual.size()>0 ? residual.maxCoeff() : 0;
+		if(active.any())
+			Rprintf("WARNING: multi-shift CG did not converge, relative residual %e after %d iterations\n", error_, int(iterations_));
+		maxIterations_ = std::max(maxIterations_, iterations_);
+		maxError_ = std::max(maxError_, error_);
+		return Fx;
+	}
+
+	UInt iterations() const {return iterations_;}
+	Real error() const {return error_;}
+	UInt maxIterations() const {return maxIterations_;}
+	Real maxError() const {return maxError_;}
+
+	private:
+	Real tolerance_ = 1e-10;
+	UInt iterationLimit_ = 1000;
+	UInt iterations_ = 0, maxIterations_ = 0;
+	Real error_ = 0, maxError_ = 0;
 };
 
 #endif
@@ -10,6 +10,7 @@
 //#include "IO_handler.h"
 #include "../../Mesh/Include/Mesh_Objects.h"
 #include "../../Mesh/Include/Mesh.h"
+#include "../../Mesh/Include/Mesh_Reordering.h"
 #include "../Include/Evaluator.h"
 #include "../Include/Projection.h"
 
@@ -63,6 +64,44 @@ SEXP tree_mesh_skeleton(SEXP Rmesh) {
 	return(result);
 }
 
+template<UInt ORDER, UInt mydim, UInt ndim>
+SEXP tree_mesh_image_skeleton(SEXP Rmesh) {
+	MeshHandler<ORDER, mydim, ndim> mesh(Rmesh);
+	auto image = mesh.getImage();
+
+	//Copy the binary image of mesh and tree in R memory
+	SEXP result = NILSXP;
+	result = PROTECT(Rf_allocVector(RAWSXP, image.size(mesh.getTree())));
+	image.write(mesh.getTree(), reinterpret_cast<char *>(RAW(result)));
+
+	UNPROTECT(1);
+	return(result);
+}
+
+template<UInt ORDER, UInt mydim, UInt ndim>
+SEXP mesh_reordering_skeleton(SEXP Rmesh) {
+	MeshHandler<ORDER, mydim, ndim> mesh(Rmesh, 1); //the orders do not use the tree
+	std::vector<UInt> nodes_order = reverseCuthillMcKee(mesh.getAdjacency());
+	std::vector<UInt> elements_order = elementMortonOrder(mesh, ndim);
+
+	//Copy the orders in R memory, indices starting from 1
+	SEXP result = NILSXP;
+	result = PROTECT(Rf_allocVector(VECSXP, 2));
+	SET_VECTOR_ELT(result, 0, Rf_allocVector(INTSXP, nodes_order.size()));
+	SET_VECTOR_ELT(result, 1, Rf_allocVector(INTSXP, elements_order.size()));
+
+	int *rans = INTEGER(VECTOR_ELT(result, 0));
+	for(UInt i = 0; i < nodes_order.size(); i++)
+		rans[i] = nodes_order[i]+1;
+
+	int *rans1 = INTEGER(VECTOR_ELT(result, 1));
+	for(UInt i = 0; i < elements_order.size(); i++)
+		rans1[i] = elements_order[i]+1;
+
+	UNPROTECT(1);
+	return(result);
+}
+
 SEXP CPP_eval_FEM_fd(SEXP Rmesh, double* X,  double* Y,  double* Z, UInt n_X, UInt** incidenceMatrix, UInt nRegions, UInt nElements, double* coef, UInt order, UInt fast, UInt mydim, UInt ndim, int search, SEXP RbaryLocations)
 {
 	SEXP result;
@@ -721,7 +760,7 @@ SEXP eval_FEM_time(SEXP Rmesh, SEXP Rmesh_time, SEXP Rlocations, SEXP Rtime_loca
 		UInt order = INTEGER(VECTOR_ELT(Rmesh,4))[0];
 
 		if (order == 1) {
-			MeshHandler<1,2,3> mesh(Rmesh);
+			MeshHandler<1,2,3> mesh(Rmesh, 1); //the projection does not use the tree
 			projection<1,2,3> projector(mesh, deData_);
 			prjData_ = projector.computeProjection();
 		}
@@ -763,4 +802,40 @@ SEXP tree_mesh_construction(SEXP Rmesh, SEXP Rorder, SEXP Rmydim, SEXP Rndim) {
 	return(NILSXP);
 }
 
+SEXP tree_mesh_image(SEXP Rmesh, SEXP Rorder, SEXP Rmydim, SEXP Rndim) {
+	UInt ORDER=INTEGER(Rorder)[0];
+	UInt mydim=INTEGER(Rmydim)[0];
+	UInt ndim=INTEGER(Rndim)[0];
+
+	if(ORDER == 1 && mydim==2 && ndim==2)
+		return(tree_mesh_image_skeleton<1, 2, 2>(Rmesh));
+	else if(ORDER == 2 && mydim==2 && ndim==2)
+		return(tree_mesh_image_skeleton<2, 2, 2>(Rmesh));
+	else if(ORDER == 1 && mydim==2 && ndim==3)
+		return(tree_mesh_image_skeleton<1, 2, 3>(Rmesh));
+	else if(ORDER == 2 && mydim==2 && ndim==3)
+		return(tree_mesh_image_skeleton<2, 2, 3>(Rmesh));
+	else if(ORDER == 1 && mydim==3 && ndim==3)
+		return(tree_mesh_image_skeleton<1, 3, 3>(Rmesh));
+	return(NILSXP);
+}
+
+SEXP mesh_reordering(SEXP Rmesh, SEXP Rorder, SEXP Rmydim, SEXP Rndim) {
+	UInt ORDER=INTEGER(Rorder)[0];
+	UInt mydim=INTEGER(Rmydim)[0];
+	UInt ndim=INTEGER(Rndim)[0];
+
+	if(ORDER == 1 && mydim==2 && ndim==2)
+		return(mesh_reordering_skeleton<1, 2, 2>(Rmesh));
+	else if(ORDER == 2 && mydim==2 && ndim==2)
+		return(mesh_reordering_skeleton<2, 2, 2>(Rmesh));
+	else if(ORDER == 1 && mydim==2 && ndim==3)
+		return(mesh_reordering_skeleton<1, 2, 3>(Rmesh));
+	else if(ORDER == 2 && mydim==2 && ndim==3)
+		return(mesh_reordering_skeleton<2, 2, 3>(Rmesh));
+	else if(ORDER == 1 && mydim==3 && ndim==3)
+		return(mesh_reordering_skeleton<1, 3, 3>(Rmesh));
+	return(NILSXP);
+}
+
 }
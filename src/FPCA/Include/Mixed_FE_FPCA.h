@@ -10,6 +10,7 @@
 #include "FPCA_Data.h"
 #include "FPCA_Object.h"
 #include "../../FE_Assemblers_Solvers/Include/Integrate_Psi.h"
+#include "../../FE_Assemblers_Solvers/Include/Psi_Builder.h"
 #include "../../Global_Utilities/Include/Solver_Definitions.h"
 #include <memory>
 
@@ -50,7 +51,7 @@ protected:
 	VectorXr b_;			  //!A Eigen::VectorXr: Stores the system solution.
 	std::vector<VectorXr> solution_;
 
-	Sparse_LU sparseSolver_;
+	SparseFactorization sparseSolver_;
 	//!A Real : Stores the variance of the edf computation using the stochastic method.
 	std::vector<Real> var_;
 
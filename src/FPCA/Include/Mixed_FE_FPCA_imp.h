@@ -56,103 +56,44 @@ void MixedFEFPCABase::computeBasisEvaluations(const MeshHandler<ORDER, mydim, nd
 	}
 	else if (fpcaData_.isLocationsByBarycenter() && (fpcaData_.getNumberOfRegions()==0))
 	{
-		//Constexpr is used for selecting the right number of nodes to pass as a template parameter to the Element object.In case of planar domain(i.e. mydim==2), we have that the number of nodes is 3*ORDER. In case of volumetric domain (i.e. mydim==3), we have that the number of nodes is 4 nodes if ORDER==1 and 10 nodes if ORDER==2, so the expression is 6*ORDER-2. ORDER==2 if mydim==3 is not yet implemented.
-		constexpr UInt Nodes = mydim==2? 3*ORDER : 6*ORDER-2;
-		Element<Nodes, mydim, ndim> tri_activated;
-		Real evaluator;
+		PsiBuilder<ORDER, mydim, ndim> builder(mesh, fpcaData_.getSearch());
+		builder.byBarycenters(fpcaData_.getElementIds(), fpcaData_.getBarycenters(), Psi_);
 
 		for(UInt i=0; i<nlocations;i++)
 		{
-
-			tri_activated = mesh.getElement(fpcaData_.getElementId(i));
-
-			if(tri_activated.getId() == Identifier::NVAL)
+			if(fpcaData_.getElementIds()(i) < 0 || fpcaData_.getElementIds()(i) >= mesh.num_elements())
 			{
 				Rprintf("WARNING: Observation %d is not in the domain, remove point and re-perform smoothing\n", i+1);
 			}
-			else
-			{
-				for(UInt node = 0; node < Nodes ; ++node)
-				{
-					evaluator = fpcaData_.getBarycenter(i,node);
-					Psi_.insert(i, tri_activated[node].getId()) = evaluator;
-				}
-			}
-		} //end of for loop
+		}
 
 		Psi_.prune(tolerance);
 		Psi_.makeCompressed();
 	}
 	else if ((!fpcaData_.isLocationsByBarycenter()) && fpcaData_.getNumberOfRegions()==0)
 	{
-		//Constexpr is used for selecting the right number of nodes to pass as a template parameter to the Element object.In case of planar domain(i.e. mydim==2), we have that the number of nodes is 3*ORDER. In case of volumetric domain (i.e. mydim==3), we have that the number of nodes is 4 nodes if ORDER==1 and 10 nodes if ORDER==2, so the expression is 6*ORDER-2. ORDER==2 if mydim==3 is not yet implemented.
-		constexpr UInt Nodes = mydim==2? 3*ORDER : 6*ORDER-2;
-		Element<Nodes, mydim, ndim> tri_activated;
-		Eigen::Matrix<Real,Nodes,1> coefficients;
+		// The points are located and the rows of Psi are computed in parallel, the values of the basis are saved as barycenters
+		PsiBuilder<ORDER, mydim, ndim> builder(mesh, fpcaData_.getSearch());
+		std::vector<Id> located = builder.locate(fpcaData_.getLocations());
+		builder.pointwise(fpcaData_.getLocations(), located, Psi_, &barycenters_);
 
-		Real evaluator;
-		this->barycenters_.resize(nlocations, Nodes);
 		this->element_ids_.resize(nlocations);
 		for(UInt i=0; i<nlocations;i++)
 		{
-
-			if (fpcaData_.getSearch() == 1) { //use Naive search
-				tri_activated = mesh.findLocationNaive(fpcaData_.getLocations()[i]);
-			} else if (fpcaData_.getSearch() == 2) { //use Tree search (default)
-				tri_activated = mesh.findLocationTree(fpcaData_.getLocations()[i]);
-			}
-
-			if(tri_activated.getId() == Identifier::NVAL)
+			element_ids_(i)=located[i];
+			if(located[i] == Identifier::NVAL)
 			{
 				Rprintf("WARNING: Observation %d is not in the domain, remove point and re-perform smoothing\n", i+1);
 			}
-			else
-			{
-				element_ids_(i)=tri_activated.getId();
-				for(UInt node = 0; node < Nodes ; ++node)
-				{
-					coefficients = Eigen::Matrix<Real,Nodes,1>::Zero();
-					coefficients(node) = 1; //Activates only current base
-					evaluator = evaluate_point<Nodes, mydim, ndim>(tri_activated, fpcaData_.getLocations()[i], coefficients);
-					barycenters_(i,node)=evaluator;
-					Psi_.insert(i, tri_activated[node].getId()) = evaluator;
-				}
-			}
-		} //end of for loop
+		}
 
 		Psi_.prune(tolerance);
 		Psi_.makeCompressed();
 	}
 	else //areal data
 	{
-		constexpr UInt Nodes = mydim==2 ? 3*ORDER : 6*ORDER-2;
-
-		Real *tab; //Psi_i
-		tab = (Real*) malloc(sizeof(Real)*nnodes);
-		for(UInt i=0; i<nlocations;i++) //nlocations = number of regions
-		{
-			for (UInt k=0; k<nnodes; k++) {tab[k]=0;}
-			for (UInt j=0; j<mesh.num_elements(); j++)
-			{
-				if (fpcaData_.getIncidenceMatrix()(i,j) == 1) //element j is in region i
-				{
-					Element<Nodes, mydim, ndim> tri = mesh.getElement(j); //can also be a tetrahedron
-					for (UInt k=0; k<Nodes; k++)
-					{
-						tab[tri[k].getId()] += integratePsi(tri,k); // integral over tri of psi_k
-					}
-				}
-			}
-			for (int k=0; k<nnodes; k++)
-			{
-				if (tab[k] != 0)
-				{
-					Psi_.insert(i,k) = tab[k]/Delta_(i);
-				}
-			}
-		}
-		free(tab);
-		Psi_.makeCompressed();
+		PsiBuilder<ORDER, mydim, ndim> builder(mesh, fpcaData_.getSearch());
+		builder.areal(fpcaData_.getIncidenceMatrix(), Delta_, Psi_);
 	}
 }
 
@@ -168,8 +109,7 @@ void MixedFEFPCABase::SetAndFixParameters(const MeshHandler<ORDER, mydim, ndim>
 
 	typedef EOExpr<Mass> ETMass; Mass EMass; ETMass mass(EMass);
 	typedef EOExpr<Stiff> ETStiff; Stiff EStiff; ETStiff stiff(EStiff);
-	Assembler::operKernel(stiff, mesh, fe, AMat_);
-	Assembler::operKernel(mass, mesh, fe, MMat_);
+	Assembler::operKernel(stiff, mass, mesh, fe, AMat_, MMat_); // both in a single pass over the mesh
 
 
 	/*const static Eigen::IOFormat CSVFormat(Eigen::StreamPrecision,Eigen::DontAlignCols,", ","\n");
@@ -186,7 +186,7 @@ void MixedFEFPCAGCV::computeDegreesOfFreedomExact(UInt output_index, Real lambda
 
 	if (this->isRcomputed_ == false ){
 		this->isRcomputed_ = true;
-		Sparse_LU solver;
+		SparseFactorization solver(SparseMatrixType::SymmetricPositiveDefinite);
 		solver.compute(this->MMat_);
 		auto X2 = solver.solve(this->AMat_);
 		this->R_ = this->AMat_.transpose() * X2;
@@ -236,7 +236,7 @@ void MixedFEFPCAGCV::computeDegreesOfFreedomStochastic(UInt output_index, Real l
 	b.topRows(nnodes) = this->Psi_.transpose()* u;
 	// Resolution of the system
 	//MatrixXr x = system_solve(b);
-	Sparse_LU solver;
+	SparseFactorization solver;
 	solver.compute(this->coeffmatrix_);
 	auto x = solver.solve(b);
 	MatrixXr uTpsi = u.transpose()*this->Psi_;
@@ -0,0 +1,32 @@
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "../../FdaPDE.h"
+
+//! Number of threads used by the parallel sections of the library
+/*!
+ * It is read from the R option fdaPDE.threads; if the option is not set the OpenMP default
+ * is used. Without OpenMP support it is always 1. Call it from the main thread only, the R
+ * API is not thread safe.
+*/
+inline int fdaPDEThreads()
+{
+#ifdef _OPENMP
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.threads"));
+	if(Rf_isNumeric(option) && Rf_length(option) > 0)
+	{
+		int threads = Rf_asInteger(option);
+		if(threads > 0)
+			return threads;
+	}
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+#endif
@@ -1,11 +1,20 @@
 #ifndef __SOLVER_DEFINITIONS_H__
 #define __SOLVER_DEFINITIONS_H__
 
+#include <memory>
+#include <string>
 //Take the code from the linked RcppEigen
 #include "../../FdaPDE.h"
+#include "Make_Unique.h"
 
-//#include <Eigen/SuperLUSupport>
-//#include <Eigen/UmfPackSupport>
+// Optional backends of SparseFactorization, enabled at build time (see Makevars)
+#ifdef FDAPDE_USE_SUITESPARSE
+#include <Eigen/UmfPackSupport>
+#include <Eigen/CholmodSupport>
+#endif
+#ifdef FDAPDE_USE_PARDISO
+#include <Eigen/PardisoSupport>
+#endif
 
 //! Some linear solvers definitions that may be useful for the future
 
@@ -14,7 +23,167 @@ typedef Eigen::SimplicialLDLT<SpMat> Sparse_Cholesky;
 typedef Eigen::ConjugateGradient<SpMat> Sparse_ConjGrad;
 typedef Eigen::BiCGSTAB<SpMat> Sparse_BiCGSTAB;
 typedef Eigen::BiCGSTAB<SpMat,Eigen::IncompleteLUT<Real>> Sparse_BiCGSTAB_ILUT;
-//typedef Eigen::UmfPackLU<SpMat> Sparse_UmfLU;
-//typedef Eigen::SuperLU<SpMat> Sparse_SuperLU;
+
+//! The libraries that can factorize the sparse matrices
+enum class SparseSolver {Eigen, SuiteSparse, Pardiso};
+
+//! The structure of a matrix to factorize, which the backends may exploit
+enum class SparseMatrixType {General, SymmetricPositiveDefinite};
+
+//! Reads the R option fdaPDE.sparse.solver ("eigen", "suitesparse" or "pardiso"), the library of the sparse factorizations
+/*!
+ * The libraries other than Eigen must be enabled at build time; if the chosen one is not, Eigen is used, with a warning
+ * the first time. Call it from the main thread only.
+*/
+inline SparseSolver sparseSolverOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.sparse.solver"));
+	if(!Rf_isString(option) || Rf_length(option) == 0)
+		return SparseSolver::Eigen;
+
+	const std::string name = CHAR(STRING_ELT(option, 0));
+	if(name == "eigen")
+		return SparseSolver::Eigen;
+#ifdef FDAPDE_USE_SUITESPARSE
+	if(name == "suitesparse")
+		return SparseSolver::SuiteSparse;
+#endif
+#ifdef FDAPDE_USE_PARDISO
+	if(name == "pardiso")
+		return SparseSolver::Pardiso;
+#endif
+	static bool warned = false;
+	if(!warned)
+		Rprintf("WARNING: the sparse solver \"%s\" is not available, Eigen is used\n", name.c_str());
+	warned = true;
+	return SparseSolver::Eigen;
+}
+
+//! The interface of the backends of SparseFactorization
+class SparseFactorizationBackend
+{
+	public:
+	virtual ~SparseFactorizationBackend() = default;
+	virtual void analyzePattern(const SpMat & A) = 0;
+	virtual void factorize(const SpMat & A) = 0;
+	virtual MatrixXr solve(const MatrixXr & b) const = 0;
+	virtual SpMat solve(const SpMat & b) const = 0;
+	virtual MatrixXr solveTranspose(const MatrixXr & b) const = 0;
+	virtual Eigen::ComputationInfo info() const = 0;
+};
+
+#ifdef FDAPDE_USE_SUITESPARSE
+//! UMFPACK LU, which also solves the transposed systems, not offered by the Eigen interface
+class UmfPackLUTranspose : public Eigen::UmfPackLU<SpMat>
+{
+	public:
+	MatrixXr solveTranspose(const MatrixXr & b) const
+	{
+		MatrixXr x(b.rows(), b.cols());
+		for(UInt j=0; j<b.cols(); ++j)
+			if(Eigen::umfpack_solve(UMFPACK_At, mp_matrix.outerIndexPtr(), mp_matrix.innerIndexPtr(), mp_matrix.valuePtr(),
+				x.col(j).data(), b.col(j).data(), m_numeric, m_control.data(), m_umfpackInfo.data()) != 0)
+				m_info = Eigen::NumericalIssue;
+		return x;
+	}
+};
+#endif
+
+//! Solves the transposed systems A^T * x = b with a factorization of A; the symmetric ones solve A * x = b
+template<typename Solver>
+inline MatrixXr solveTranspose(Solver & solver, const MatrixXr & b) {return solver.solve(b);}
+inline MatrixXr solveTranspose(Sparse_LU & solver, const MatrixXr & b) {return solver.transpose().solve(b);}
+#ifdef FDAPDE_USE_SUITESPARSE
+inline MatrixXr solveTranspose(UmfPackLUTranspose & solver, const MatrixXr & b) {return solver.solveTranspose(b);}
+#endif
+#ifdef FDAPDE_USE_PARDISO
+inline MatrixXr solveTranspose(Eigen::PardisoLU<SpMat> & solver, const MatrixXr & b)
+{
+	solver.pardisoParameterArray()[11] = 2;	// iparm(12): solve the transposed systems
+	MatrixXr x = solver.solve(b);
+	solver.pardisoParameterArray()[11] = 0;
+	return x;
+}
+#endif
+
+//! A backend of SparseFactorization wrapping a sparse solver with the Eigen interface
+template<typename Solver>
+class EigenSparseFactorization : public SparseFactorizationBackend
+{
+	public:
+	void analyzePattern(const SpMat & A) override {solver_.analyzePattern(A);}
+	void factorize(const SpMat & A) override {solver_.factorize(A);}
+	MatrixXr solve(const MatrixXr & b) const override {return solver_.solve(b);}
+	SpMat solve(const SpMat & b) const override {return solver_.solve(b);}
+	MatrixXr solveTranspose(const MatrixXr & b) const override {return ::solveTranspose(solver_, b);}
+	Eigen::ComputationInfo info() const override {return solver_.info();}
+
+	private:
+	mutable Solver solver_;	//!< mutable, the transposed solves of SparseLU and Pardiso are not const
+};
+
+//!  A sparse direct solver class whose library is chosen at run time
+/*!
+ * It offers the interface of the Eigen sparse solvers: analyzePattern computes the fill-reducing ordering, which can be
+ * reused by factorize for the matrices with the same pattern, and solve accepts dense or sparse right hand sides with any
+ * number of columns; solveTranspose solves the systems with the transposed matrix, for dense right hand sides. The library is read from the option fdaPDE.sparse.solver when the object is built:
+ * 	- Eigen: SparseLU for general matrices, SimplicialLDLT for symmetric positive definite ones;
+ * 	- SuiteSparse: UMFPACK for general matrices, supernodal CHOLMOD for symmetric positive definite ones;
+ * 	- Pardiso (MKL): its LU and Cholesky factorizations.
+ * The SuiteSparse and Pardiso factorizations are multithreaded through the BLAS, or MKL, they are linked to.
+*/
+class SparseFactorization
+{
+	public:
+	explicit SparseFactorization(SparseMatrixType type = SparseMatrixType::General, SparseSolver solver = sparseSolverOption()):
+		solver_(solver)
+	{
+		switch(solver)
+		{
+#ifdef FDAPDE_USE_SUITESPARSE
+			case SparseSolver::SuiteSparse:
+				if(type == SparseMatrixType::SymmetricPositiveDefinite)
+					backend_ = make_unique<EigenSparseFactorization<Eigen::CholmodSupernodalLLT<SpMat> > >();
+				else
+					backend_ = make_unique<EigenSparseFactorization<UmfPackLUTranspose> >();
+				break;
+#endif
+#ifdef FDAPDE_USE_PARDISO
+			case SparseSolver::Pardiso:
+				if(type == SparseMatrixType::SymmetricPositiveDefinite)
+					backend_ = make_unique<EigenSparseFactorization<Eigen::PardisoLLT<SpMat> > >();
+				else
+					backend_ = make_unique<EigenSparseFactorization<Eigen::PardisoLU<SpMat> > >();
+				break;
+#endif
+			default:
+				solver_ = SparseSolver::Eigen;
+				if(type == SparseMatrixType::SymmetricPositiveDefinite)
+					backend_ = make_unique<EigenSparseFactorization<Sparse_Cholesky> >();
+				else
+					backend_ = make_unique<EigenSparseFactorization<Sparse_LU> >();
+		}
+	}
+
+	void analyzePattern(const SpMat & A) {backend_->analyzePattern(A);}
+	void factorize(const SpMat & A) {backend_->factorize(A);}
+	void compute(const SpMat & A) {analyzePattern(A); factorize(A);}
+
+	MatrixXr solve(const MatrixXr & b) const {return backend_->solve(b);}
+	template<typename Derived>
+	MatrixXr solve(const Eigen::MatrixBase<Derived> & b) const {return backend_->solve(MatrixXr(b));}
+	SpMat solve(const SpMat & b) const {return backend_->solve(b);}
+
+	MatrixXr solveTranspose(const MatrixXr & b) const {return backend_->solveTranspose(b);}
+	template<typename Derived>
+	MatrixXr solveTranspose(const Eigen::MatrixBase<Derived> & b) const {return backend_->solveTranspose(MatrixXr(b));}
+
+	Eigen::ComputationInfo info() const {return backend_->info();}
+	SparseSolver solver() const {return solver_;}
+
+	private:
+	SparseSolver solver_;
+	std::unique_ptr<SparseFactorizationBackend> backend_;
+};
 
 #endif
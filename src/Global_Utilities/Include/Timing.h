@@ -10,6 +10,9 @@
 
 #include <time.h>
 #include <sys/time.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
 
 #ifdef __MACH__
 #include <mach/clock.h>
@@ -75,4 +78,21 @@ private:
   timespec begin;
 };
 
+//! Peak resident memory of the process so far in MB, -1 where it is not available
+inline double peakMemory()
+{
+  #ifdef _WIN32
+  return -1.;
+  #else
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0)
+    return -1.;
+  #ifdef __MACH__ // ru_maxrss is in bytes on OS X, in KB elsewhere
+  return usage.ru_maxrss/(1024.*1024.);
+  #else
+  return usage.ru_maxrss/1024.;
+  #endif
+  #endif
+}
+
 #endif
@@ -98,6 +98,52 @@ struct AuxiliaryOptimizer
                 universal_R_setter(MatrixXr & R, const InputCarrier & carrier, AuxiliaryData<InputCarrier> & adt);
         /* -------------------------------------------------------------------*/
 
+        //! SFINAE based method to compute U^t*f in case of Forced problem
+        /*!
+         \param Uf a reference to the vector to be computed
+         \param U a const reference to the matrix to transpose and multiply by f
+         \param adt the AuxiliaryData type storing f_, as computed by universal_R_setter
+         \return an integer signaling the correct ending of the process
+        */
+        template<typename InputCarrier>
+        static typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, InputCarrier>::value>, t_type>::value, UInt>::type
+                universal_Uf_setter(VectorXr & Uf, const MatrixXr & U, const AuxiliaryData<InputCarrier> & adt);
+
+        //! SFINAE based method to compute U^t*f in case of non-Forced problem, where it is empty
+        /*!
+         \param Uf a reference to the vector to be emptied
+         \param U a const reference to the matrix to transpose and multiply by f
+         \param adt the AuxiliaryData type
+         \return an integer signaling the correct ending of the process
+        */
+        template<typename InputCarrier>
+        static typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, InputCarrier>::value>, f_type>::value, UInt>::type
+                universal_Uf_setter(VectorXr & Uf, const MatrixXr & U, const AuxiliaryData<InputCarrier> & adt);
+        /* -------------------------------------------------------------------*/
+
+        //! SFINAE based method to compute f = R1^t*R0^{-1}*u in case of Forced problem, without forming R
+        /*!
+         \param f a reference to the vector to be computed
+         \param carrier the Carrier-type object containing the data
+         \param factorized_R0 the factorization of R0
+         \return an integer signaling the correct ending of the process
+        */
+        template<typename InputCarrier>
+        static typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, InputCarrier>::value>, t_type>::value, UInt>::type
+                universal_f_setter(VectorXr & f, const InputCarrier & carrier, const SparseFactorization & factorized_R0);
+
+        //! SFINAE based method to compute f in case of non-Forced problem, where it is empty
+        /*!
+         \param f a reference to the vector to be emptied
+         \param carrier the Carrier-type object containing the data
+         \param factorized_R0 the factorization of R0
+         \return an integer signaling the correct ending of the process
+        */
+        template<typename InputCarrier>
+        static typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, InputCarrier>::value>, f_type>::value, UInt>::type
+                universal_f_setter(VectorXr & f, const InputCarrier & carrier, const SparseFactorization & factorized_R0);
+        /* -------------------------------------------------------------------*/
+
         //! SFINAE based method to compute matrix T in case of Areal problem
         /*!
          \param T a reference to the matrix to be computed
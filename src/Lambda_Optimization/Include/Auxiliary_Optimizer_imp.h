@@ -34,7 +34,8 @@ typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, Inp
                 const std::vector<UInt> * bc_indices = carrier.get_bc_indicesp();
                 AuxiliaryOptimizer::bc_utility(R1p_, bc_indices);
 
-                Eigen::SparseLU<SpMat> factorized_R0p(*(carrier.get_R0p()));
+                SparseFactorization factorized_R0p(SparseMatrixType::SymmetricPositiveDefinite);
+                factorized_R0p.compute(*(carrier.get_R0p()));
                 R = (R1p_).transpose()*factorized_R0p.solve(R1p_);     // R == _R1^t*R0^{-1}*R1
                 adt.f_ = ((R1p_).transpose())*factorized_R0p.solve((*carrier.get_up()));
 
@@ -49,12 +50,49 @@ typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, Inp
                 const std::vector<UInt> * bc_indices = carrier.get_bc_indicesp();
                 AuxiliaryOptimizer::bc_utility(R1p_, bc_indices);
 
-                Eigen::SparseLU<SpMat>factorized_R0p(*(carrier.get_R0p()));
+                SparseFactorization factorized_R0p(SparseMatrixType::SymmetricPositiveDefinite);
+                factorized_R0p.compute(*(carrier.get_R0p()));
                 R = (R1p_).transpose()*factorized_R0p.solve(R1p_);     // R == _R1^t*R0^{-1}*R1
 
                 return 0;
         }
 
+template<typename InputCarrier>
+typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, InputCarrier>::value>,t_type>::value, UInt>::type
+        AuxiliaryOptimizer::universal_Uf_setter(VectorXr & Uf, const MatrixXr & U, const AuxiliaryData<InputCarrier> & adt)
+        {
+                Uf = U.transpose()*adt.f_;
+
+                return 0;
+        }
+
+template<typename InputCarrier>
+typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, InputCarrier>::value>,f_type>::value, UInt>::type
+        AuxiliaryOptimizer::universal_Uf_setter(VectorXr & Uf, const MatrixXr & U, const AuxiliaryData<InputCarrier> & adt)
+        {
+                Uf.resize(0);
+
+                return 0;
+        }
+
+template<typename InputCarrier>
+typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, InputCarrier>::value>,t_type>::value, UInt>::type
+        AuxiliaryOptimizer::universal_f_setter(VectorXr & f, const InputCarrier & carrier, const SparseFactorization & factorized_R0)
+        {
+                f = (carrier.get_R1p()->transpose())*factorized_R0.solve((*carrier.get_up()));
+
+                return 0;
+        }
+
+template<typename InputCarrier>
+typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Forced, InputCarrier>::value>,f_type>::value, UInt>::type
+        AuxiliaryOptimizer::universal_f_setter(VectorXr & f, const InputCarrier & carrier, const SparseFactorization & factorized_R0)
+        {
+                f.resize(0);
+
+                return 0;
+        }
+
 template<typename InputCarrier>
 typename std::enable_if<std::is_same<multi_bool_type<std::is_base_of<Areal, InputCarrier>::value>,t_type>::value, UInt>::type
         AuxiliaryOptimizer::universal_T_setter(MatrixXr & T, InputCarrier & carrier)
@@ -214,6 +214,29 @@ class Carrier: public Extensions...
                         return (this->model->apply())(0,0);
                 }
 
+                //! Method to solve the systems of a whole grid of lambdas [right hand side is the usual of the problem]
+                /*!
+                 \param lambdas the grid of optimization parameters
+                 \return psi times the first block of the solutions, one column per lambda
+                 \pre get_model()->isMultiShift()
+                */
+                inline MatrixXr apply_grid(const std::vector<Real> & lambdas)
+                {
+                        return this->model->apply_grid(lambdas);
+                }
+
+                //! Method to solve the systems of a whole grid of lambdas given the first block of the right hand side
+                /*!
+                 \param b the first block of the right hand side, the second one being zero
+                 \param lambdas the grid of optimization parameters
+                 \return psi times the first block of the solutions, one matrix per lambda
+                 \pre get_model()->isMultiShift()
+                */
+                inline std::vector<MatrixXr> apply_to_b_grid(const MatrixXr & b, const std::vector<Real> & lambdas)
+                {
+                        return this->model->apply_to_b_grid(b, lambdas);
+                }
+
                 //! Method to take advantage of simplified multiplication by Q
                 /*!
                  \param u the vector or matrix onto which to perform multiplication
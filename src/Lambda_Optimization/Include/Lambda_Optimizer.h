@@ -7,6 +7,8 @@
 #include "Carrier.h"
 #include "Gof_Updater.h"
 #include "../../FE_Assemblers_Solvers/Include/Solver.h"
+#include "../../Global_Utilities/Include/Parallel.h"
+#include "Trace_Estimator.h"
 #include <algorithm>
 
 // CLASSES
@@ -108,6 +110,7 @@ class GCV_Family<InputCarrier, 1>: Lambda_optimizer<InputCarrier, 1>
 
                 // Degrees of freedom
                 Real            dof = 0.0;              //!< tr(S) + q, degrees of freedom of the model
+                Real            dof_var = 0.0;          //!< Variance of the stochastic estimate of dof, 0 if exact
                 Real            dor = 0.0;              //!< s - dof, degrees of freedom of the residuals
 
                 UInt            use_index = -1;         //!< Index of the DOF_matrix to be used, if non empty
@@ -143,6 +146,8 @@ class GCV_Family<InputCarrier, 1>: Lambda_optimizer<InputCarrier, 1>
         public:
                 // UTILITY FOR DOF MATRIX
         inline  void set_index(UInt index){this->use_index = index;}
+                //! Prepares the evaluation of a whole grid of lambdas, before set_index and compute_f are called on it
+        virtual void set_grid(const std::vector<Real> & lambdas) {;}
 
                 // PUBLIC UPDATERS
         virtual void update_parameters(Real lambda) = 0; //!< Utility to update all the prameters of the model
@@ -206,6 +211,12 @@ class GCV_Exact<InputCarrier, 1>: public GCV_Family<InputCarrier, 1>
                 //! Additional utility matrices [just the ones for the specific carrier that is proper of the problem]
                 AuxiliaryData<InputCarrier> adt;
 
+                // Grid solved up front [see set_grid]
+                std::vector<Real> grid_lambdas_;        //!< lambdas of the grid, empty if the grid is solved lambda by lambda
+                MatrixXr grid_z_hat_;                   //!< predicted values in the locations [size s x #lambdas]
+                VectorXr grid_trS_;                     //!< traces of S [size #lambdas]
+                bool in_grid(Real lambda) const {return this->use_index < grid_lambdas_.size() && grid_lambdas_[this->use_index] == lambda;}
+
                 // COMPUTERS and DOF methods
                 void compute_z_hat (Real lambda) override;
                 void update_dof(Real lambda)     override;
@@ -238,6 +249,201 @@ class GCV_Exact<InputCarrier, 1>: public GCV_Family<InputCarrier, 1>
                                 this->set_R_(); // this matrix is unchanged during the whole procedure, thus it's set once and for all
                         }
 
+                // PUBLIC UPDATERS
+                void update_parameters(Real lambda) override;
+                void set_grid(const std::vector<Real> & lambdas) override;
+
+                void first_updater(Real lambda);
+                void second_updater(Real lambda);
+
+                // GCV-COMPUTATION
+                Real compute_f( Real lambda) override;
+                Real compute_fp(Real lambda);
+                Real compute_fs(Real lambda);
+};
+
+//----------------------------------------------------------------------------//
+// ** GCV_EIGEN **
+
+//! Reads the R option fdaPDE.gcv.eigen, setting it to TRUE computes the exact gcv by GCV_Eigen where possible
+inline bool gcvEigenOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.gcv.eigen"));
+	return Rf_isLogical(option) && Rf_length(option) > 0 && LOGICAL(option)[0] == TRUE;
+}
+
+//! Derived class used for multidimensional lambda exact gcv-based methods by eigendecomposition
+/*!
+ \tparam InputCarrier Carrier-type parameter that contains insight about the problem to be solved
+ \tparam size specialization parameter used to characterize the size of the lambda to be used
+ \todo 2-D lambda optimization still to be implemented
+*/
+template<typename InputCarrier, UInt size>
+class GCV_Eigen: public GCV_Family<InputCarrier, size>
+{
+/*
+        [[ VERSION WITH TIMES STILL TO BE IMPLEMENTED ]]
+*/
+};
+
+//! Derived class used for unidimensional lambda exact gcv-based methods by eigendecomposition
+/*!
+ This class computes the same quantities as GCV_Exact, but from a single generalized eigendecomposition
+ computed in the constructor: with D = Psi^t*Q*Psi and R = R1^t*R0^{-1}*R1, the generalized eigenvectors U
+ of R with respect to M = D+lambda0*R satisfy U^t*M*U = I and U^t*R*U = diag(mu), so that
+ T = D+lambda*R = U^{-t}*diag(delta+lambda*mu)*U^{-1}. The traces of S and of its derivatives then cost
+ O(nnodes) for each lambda and the predictions O(nnodes*s), instead of a factorization and solves with
+ nnodes+s right hand sides. It needs D symmetric and no Dirichlet boundary conditions (see is_applicable).
+ \tparam InputCarrier Carrier-type parameter that contains insight about the problem to be solved
+*/
+template<typename InputCarrier>
+class GCV_Eigen<InputCarrier, 1>: public GCV_Family<InputCarrier, 1>
+{
+        private:
+                //! An external updater whose purpose is keeping the internal values coherent with the computations to be made from time to time
+                GOF_updater<GCV_Eigen<InputCarrier, 1>, Real> gu;
+
+                // INTERNAL DATA STRUCTURES
+                VectorXr  mu_;          //!< stores the diagonal of U^t*R*U [size nnodes]
+                VectorXr  delta_;       //!< stores the diagonal of U^t*D*U [size nnodes]
+                MatrixXr  PsiU_;        //!< stores Psi*U [size s x nnodes]
+                VectorXr  w_;           //!< stores the diagonal of U^t*E*Psi*U, E = Psi^t*Q, the weights of the traces [size nnodes]
+                VectorXr  Ez_;          //!< stores U^t*E*z [size nnodes]
+                VectorXr  Uf_;          //!< stores U^t*f, for forced problems [size nnodes]
+                VectorXr  t_;           //!< stores delta+lambda*mu, the eigenvalues of T in the basis U [size nnodes]
+                VectorXr  Uh_;          //!< stores U^{-1}*h, for forced problems [size nnodes]
+                VectorXr  p_;           //!< stores Psi*h-dS*z, for forced problems [size s]
+                Real      trS_ = 0.0;   //!< stores the value of the trace of S
+                Real      trdS_ = 0.0;  //!< stores the value of the trace of dS
+                Real      trddS_ = 0.0; //!< stores the value of the trace of ddS
+
+                //! Additional utility matrices [just the ones for the specific carrier that is proper of the problem]
+                AuxiliaryData<InputCarrier> adt;
+
+                // COMPUTERS and DOF methods
+                void compute_z_hat (Real lambda) override;
+                void update_dof(Real lambda)     override;
+                void update_dor(Real lambda)     override;
+
+                // SETTERS
+                void set_eigendecomposition(void);
+
+        public:
+                // CONSTRUCTORS
+                //! Constructor of the class given the InputCarrier
+                /*!
+                 \param the_carrier the structure from which to take all the data for the derived classes
+                 \pre is_applicable(the_carrier)
+                 \sa set_eigendecomposition()
+                */
+                GCV_Eigen<InputCarrier, 1>(InputCarrier & the_carrier_):
+                        GCV_Family<InputCarrier, 1>(the_carrier_)
+                        {
+                                this->set_eigendecomposition(); // independent of lambda, thus computed once and for all
+                        }
+
+                //! Whether the problem of the carrier can be solved by this class
+                static bool is_applicable(const InputCarrier & carrier)
+                {
+                        // D is not symmetric with areal data and covariates, the penalization of Dirichlet conditions spoils the eigenvalues
+                        return carrier.get_bc_indicesp()->size()==0 && !(carrier.is_areal() && carrier.has_W());
+                }
+
+                // PUBLIC UPDATERS
+                void update_parameters(Real lambda) override;
+
+                void first_updater(Real lambda);
+                void second_updater(Real lambda);
+
+                // GCV-COMPUTATION
+                Real compute_f( Real lambda) override;
+                Real compute_fp(Real lambda);
+                Real compute_fs(Real lambda);
+};
+
+//----------------------------------------------------------------------------//
+// ** GCV_BLOCKED **
+
+//! Derived class used for multidimensional lambda exact gcv-based methods with bounded memory
+/*!
+ \tparam InputCarrier Carrier-type parameter that contains insight about the problem to be solved
+ \tparam size specialization parameter used to characterize the size of the lambda to be used
+ \todo 2-D lambda optimization still to be implemented
+*/
+template<typename InputCarrier, UInt size>
+class GCV_Blocked: public GCV_Family<InputCarrier, size>
+{
+/*
+        [[ VERSION WITH TIMES STILL TO BE IMPLEMENTED ]]
+*/
+};
+
+//! Derived class used for unidimensional lambda exact gcv-based methods with bounded memory
+/*!
+ This class computes the same quantities as GCV_Exact without any dense nnodes x nnodes or s x s matrix:
+ with T = Psi^t*Q*Psi+lambda*R and R = R1^t*R0^{-1}*R1, the products by T^{-1} are solves of the sparse
+ system of the model [see apply_to_b], which is factorized once for each lambda, and the products by R
+ are solves with the factorization of R0. The traces of S = Psi*T^{-1}*Psi^t*Q and of its derivatives are
+ accumulated over blocks of block_size unit vectors of the locations, so that the extra memory is
+ O((nnodes+s)*block_size), and the predictions come from a single solve. It needs no Dirichlet
+ boundary conditions (see is_applicable).
+ \tparam InputCarrier Carrier-type parameter that contains insight about the problem to be solved
+*/
+template<typename InputCarrier>
+class GCV_Blocked<InputCarrier, 1>: public GCV_Family<InputCarrier, 1>
+{
+        private:
+                //! An external updater whose purpose is keeping the internal values coherent with the computations to be made from time to time
+                GOF_updater<GCV_Blocked<InputCarrier, 1>, Real> gu;
+
+                static constexpr UInt block_size = 64;  //!< number of unit vectors solved together in the traces
+
+                // INTERNAL DATA STRUCTURES
+                std::shared_ptr<SparseFactorization> R0dec_;   //!< factorization of R0, shared by the copies of the object
+                VectorXr  f_;           //!< stores R1^t*R0^{-1}*u, for forced problems [size nnodes]
+                VectorXr  KVz_;         //!< stores T^{-1}*R*T^{-1}*E*z [size nnodes]
+                VectorXr  h_;           //!< stores (lambda*T^{-1}*R-I)*T^{-1}*f, for forced problems [size nnodes]
+                VectorXr  p_;           //!< stores Psi*h-dS*z, for forced problems [size s]
+                Real      trS_ = 0.0;   //!< stores the value of the trace of S
+                Real      trdS_ = 0.0;  //!< stores the value of the trace of dS
+                Real      trddS_ = 0.0; //!< stores the value of the trace of ddS
+
+                //! Additional utility matrices [just the ones for the specific carrier that is proper of the problem]
+                AuxiliaryData<InputCarrier> adt;
+
+                // COMPUTERS and DOF methods
+                void compute_z_hat (Real lambda) override;
+                void update_dof(Real lambda)     override;
+                void update_dor(Real lambda)     override;
+
+                // UTILITIES
+                MatrixXr solve_T(const MatrixXr & rhs, Real lambda);
+                MatrixXr multiply_by_R(const MatrixXr & mat) const;
+                void update_traces(Real lambda, UInt order);
+
+        public:
+                // CONSTRUCTORS
+                //! Constructor of the class given the InputCarrier
+                /*!
+                 \param the_carrier the structure from which to take all the data for the derived classes
+                 \pre is_applicable(the_carrier)
+                */
+                GCV_Blocked<InputCarrier, 1>(InputCarrier & the_carrier_):
+                        GCV_Family<InputCarrier, 1>(the_carrier_)
+                        {
+                                // R0 and the forcing term are independent of lambda, thus they are set once and for all
+                                this->R0dec_ = std::make_shared<SparseFactorization>(SparseMatrixType::SymmetricPositiveDefinite);
+                                this->R0dec_->compute(*this->the_carrier.get_R0p());
+                                AuxiliaryOptimizer::universal_f_setter<InputCarrier>(this->f_, this->the_carrier, *this->R0dec_);
+                        }
+
+                //! Whether the problem of the carrier can be solved by this class
+                static bool is_applicable(const InputCarrier & carrier)
+                {
+                        // the penalization of Dirichlet conditions is not part of R [see bc_utility]
+                        return carrier.get_bc_indicesp()->size()==0;
+                }
+
                 // PUBLIC UPDATERS
                 void update_parameters(Real lambda) override;
 
@@ -290,6 +496,15 @@ class GCV_Stochastic<InputCarrier, 1>: public GCV_Family<InputCarrier, 1>
                 // INTERNAL DATA STRUCTURES
                 MatrixXr US_;           //!< binary{+1/-1} random matrix used for stochastic gcv computations [size s x #realizations]
                 bool     us = false;    //!< keeps track of US_ matrix being already computed or not
+                TraceEstimator estimator_;      //!< estimator of the trace of S from the realizations in US_ [see TraceEstimator]
+
+                // Grid solved up front [see set_grid]
+                std::vector<Real> grid_lambdas_;        //!< lambdas of the grid, empty if the grid is solved lambda by lambda
+                MatrixXr grid_z_hat_;                   //!< predicted values in the locations [size s x #lambdas]
+                VectorXr grid_dof_;                     //!< degrees of freedom, empty if not computed [size #lambdas]
+                VectorXr grid_dof_var_;                 //!< variance of the estimated degrees of freedom [size #lambdas]
+                bool in_grid(Real lambda) const {return this->use_index < grid_lambdas_.size() && grid_lambdas_[this->use_index] == lambda;}
+                static constexpr UInt grid_block_size = 16;     //!< number of realizations solved together on the grid
 
                 // COMPUTERS and DOF methods
                 void compute_z_hat (Real lambda) override;
@@ -318,6 +533,7 @@ class GCV_Stochastic<InputCarrier, 1>: public GCV_Family<InputCarrier, 1>
 
                 // PUBLIC UPDATERS
                 void update_parameters(Real lambda) override;
+                void set_grid(const std::vector<Real> & lambdas) override;
 
                 void first_updater(Real lambda)  {; /*Dummy*/} //!< Dummy function needed for consistency of the external updater
                 void second_updater(Real lambda) {; /*Dummy*/} //!< Dummy function needed for consistency of the external updater
@@ -28,7 +28,9 @@ output_Data GCV_Family<InputCarrier, 1>::get_output(std::pair<Real,UInt> optimal
         (this->output.rmse).push_back(this->rmse);
         this->output.sigma_hat_sq       = this->sigma_hat_sq;
         (this->output.dof).push_back(this->dof);
+        (this->output.dof_var).push_back(this->dof_var);
         this->output.time_partial       = time_count.tv_sec + 1e-9*time_count.tv_nsec;
+        this->output.peak_memory        = peakMemory();
         this->output.GCV_evals          = GCV_v;
         this->output.GCV_opt            = GCV_v[GCV_v.size()-1];
         this->output.lambda_vec         = lambda_v;
@@ -46,6 +48,7 @@ void GCV_Family<InputCarrier, 1>::set_output_partial(void)
 {
         (this->output.rmse).push_back(this->rmse);
         (this->output.dof).push_back(this->dof);
+        (this->output.dof_var).push_back(this->dof_var);
 
 }
 
@@ -457,6 +460,13 @@ void GCV_Exact<InputCarrier, 1>::update_dor(Real lambda)
 template<typename InputCarrier>
 void GCV_Exact<InputCarrier, 1>::update_matrices(Real lambda)
 {
+        if(this->in_grid(lambda))
+        {
+                this->z_hat = this->grid_z_hat_.col(this->use_index);
+                this->trS_  = this->grid_trS_[this->use_index];
+                return;
+        }
+
         // this order must be kept
         this->set_T_(lambda);
         this->set_V_();
@@ -478,6 +488,47 @@ void GCV_Exact<InputCarrier, 1>::update_parameters(Real lambda)
         this->update_errors(lambda);
 }
 
+//! Computes the predicted values and the traces of S of all the lambdas of a grid up front, in parallel
+/*!
+ Each thread works on its own copy of the object, with its own T_, V_ and S_, so that the dense matrices are
+ allocated once per thread; the model is only read, the products by Q being set up before the threads start.
+ update_matrices then only reads the results, as long as the index set by set_index points to the same lambda. The derivatives of the gcv are not needed by the grid, thus S_ is not kept for its lambdas.
+ The penalization of Dirichlet conditions goes through the system of the model [see compute_z_hat],
+ in which case the grid is solved lambda by lambda.
+ \param lambdas the grid of lambdas to be evaluated
+*/
+template<typename InputCarrier>
+void GCV_Exact<InputCarrier, 1>::set_grid(const std::vector<Real> & lambdas)
+{
+        this->grid_lambdas_.clear();
+        const int threads = std::min(fdaPDEThreads(), int(lambdas.size()));
+        if(threads < 2 || this->the_carrier.get_bc_indicesp()->size()!=0)
+                return;
+
+        // sets up the products by Q before the threads share them
+        if(this->the_carrier.has_W())
+                this->the_carrier.lmbQ(MatrixXr::Zero(this->s, 1));
+
+        const UInt nl = lambdas.size();
+        this->grid_z_hat_.resize(this->s, nl);
+        this->grid_trS_.resize(nl);
+
+        #pragma omp parallel num_threads(threads)
+        {
+                GCV_Exact<InputCarrier, 1> optim(*this);
+
+                #pragma omp for schedule(dynamic)
+                for(int j = 0; j < int(nl); ++j)
+                {
+                        optim.update_matrices(lambdas[j]);
+                        this->grid_z_hat_.col(j) = optim.z_hat;
+                        this->grid_trS_[j]       = optim.trS_;
+                }
+        }
+
+        this->grid_lambdas_ = lambdas;
+}
+
 //! Update all parameters needed to compute the gcv fist derivative, depending on lambda
 /*!
  \param lambda the actual value of lambda to be used for the update
@@ -580,6 +631,486 @@ Real GCV_Exact<InputCarrier, 1>::compute_fs(Real lambda)
 	return GCV_sec_der_val;
 }
 
+//----------------------------------------------------------------------------//
+// ** GCV_EIGEN **
+
+// -- Setters --
+//! Method to compute the generalized eigendecomposition and the lambda independent terms built on it
+/*!
+ \remark with D = Psi^t*Q*Psi, R = R1^t*R0^{-1}*R1 and M = D+lambda0*R, the eigenvectors U of R*u = mu*M*u
+ satisfy U^t*M*U = I, so that T = D+lambda*R = U^{-t}*diag(delta+lambda*mu)*U^{-1} with delta the diagonal
+ of U^t*D*U. lambda0 = tr(D)/tr(R) gives the two terms of M the same weight, so that neither is lost in rounding.
+ \pre the carrier has neither Dirichlet boundary conditions nor covariates with areal data
+*/
+template<typename InputCarrier>
+void GCV_Eigen<InputCarrier, 1>::set_eigendecomposition(void)
+{
+        const UInt nnodes = this->the_carrier.get_n_nodes();
+        const VectorXr * zp = this->the_carrier.get_zp();
+
+        MatrixXr U;     // holds R until its eigenvectors replace it
+        const UInt ret = AuxiliaryOptimizer::universal_R_setter<InputCarrier>(U, this->the_carrier, this->adt);
+        MatrixXr D = MatrixXr::Zero(nnodes, nnodes);
+        AuxiliaryOptimizer::universal_T_setter<InputCarrier>(D, this->the_carrier); // T for lambda = 0
+
+        const Real trR = U.trace();
+        const Real lambda0 = (trR > 0) ? D.trace()/trR : 1.;
+        {
+                Eigen::GeneralizedSelfAdjointEigenSolver<MatrixXr> solver(U, D+lambda0*U);
+                this->mu_ = solver.eigenvalues();
+                U = solver.eigenvectors();
+        }
+        D = D*U;
+        this->delta_ = (U.array()*D.array()).colwise().sum().transpose();
+        D.resize(0, 0);
+
+        this->PsiU_ = (*this->the_carrier.get_psip())*U;
+        if(this->the_carrier.is_areal() || this->the_carrier.has_W())
+        {
+                MatrixXr E;
+                AuxiliaryOptimizer::universal_E_setter<InputCarrier>(E, this->the_carrier);
+                const MatrixXr EtU = E.transpose()*U;
+                this->w_  = (this->PsiU_.array()*EtU.array()).colwise().sum().transpose();
+                this->Ez_ = EtU.transpose()*(*zp);
+        }
+        else
+        {
+                // E == Psi^t
+                this->w_  = this->PsiU_.colwise().squaredNorm().transpose();
+                this->Ez_ = this->PsiU_.transpose()*(*zp);
+        }
+
+        AuxiliaryOptimizer::universal_Uf_setter<InputCarrier>(this->Uf_, U, this->adt);
+}
+
+// -- Computers and dof --
+//! Utility to compute the predicted values in the locations
+/*!
+ \remark S*z = Psi*U*diag(1/t)*U^t*E*z, and for forced problems Psi*g = Psi*U*diag(1/t)*U^t*f
+ \param lambda value of the optimization parameter
+ \pre t_ must be updated to lambda
+*/
+template<typename InputCarrier>
+void GCV_Eigen<InputCarrier, 1>::compute_z_hat(Real lambda)
+{
+        VectorXr Sz = this->PsiU_*(this->Ez_.array()/this->t_.array()).matrix();
+        if(this->the_carrier.has_W())
+                this->z_hat = (*this->the_carrier.get_Hp())*(*this->the_carrier.get_zp()) + this->the_carrier.lmbQ(Sz);
+        else
+                this->z_hat = Sz;
+
+        if(this->Uf_.size()!=0)
+        {
+                VectorXr r = lambda*this->PsiU_*(this->Uf_.array()/this->t_.array()).matrix();
+                if(this->the_carrier.has_W())
+                        this->z_hat += this->the_carrier.lmbQ(r);
+                else
+                        this->z_hat += r;
+        }
+}
+
+//! Utility to compute the degrees of freedom of the model
+/*!
+ \param lambda value of the optimization parameter
+*/
+template<typename InputCarrier>
+void GCV_Eigen<InputCarrier, 1>::update_dof(Real lambda)
+{
+        // dof = tr(S) + #covariates
+        this->dof = this->trS_;
+
+        if(this->the_carrier.has_W()) // add number of covariates, if present
+                this->dof += (*this->the_carrier.get_Wp()).cols();
+}
+
+//! Utility to compute the degrees of freedom of the residuals
+/*!
+ \param lambda value of the optimization parameter
+ \pre update_dof() must have been called
+ \sa update_dof()
+*/
+template<typename InputCarrier>
+void GCV_Eigen<InputCarrier, 1>::update_dor(Real lambda)
+{
+        // dor = #locations - dof
+        this->dor = this->s-this->dof*this->the_carrier.get_opt_data()->get_tuning();
+
+        if (this->dor < 0)   // Just in case of bad computation
+        {
+                Rprintf("WARNING: Some values of the trace of the matrix S('lambda') are inconstistent.\n");
+                Rprintf("This might be due to ill-conditioning of the linear system.\n");
+                Rprintf("Try increasing value of 'lambda'. Value of 'lambda' that produces an error is: %d \n", lambda);
+        }
+}
+
+// -- Public updaters --
+//! Setting all the parameters which are recursively lambda dependent
+/*!
+ \remark tr(S) = sum_i w_i/t_i
+ \sa compute_z_hat(Real lambda), update_errors(Real lambda)
+*/
+template<typename InputCarrier>
+void GCV_Eigen<InputCarrier, 1>::update_parameters(Real lambda)
+{
+        // this order must be kept
+        this->t_ = this->delta_ + lambda*this->mu_;
+        this->trS_ = (this->w_.array()/this->t_.array()).sum();
+        this->compute_z_hat(lambda);
+        this->update_errors(lambda);
+}
+
+//! Update all parameters needed to compute the gcv fist derivative, depending on lambda
+/*!
+ \remark with K = T^{-1}*R = U*diag(mu/t)*U^{-1}: tr(dS) = -sum_i w_i*mu_i/t_i^2 and dS*z = -Psi*U*diag(mu/t^2)*U^t*E*z,
+ for forced problems h = (lambda*K-I)*T^{-1}*f = U*diag((lambda*mu/t-1)/t)*U^t*f
+ \param lambda the actual value of lambda to be used for the update
+ \sa update_parameters(Real lambda), second_updater(Real lambda)
+*/
+template<typename InputCarrier>
+void GCV_Eigen<InputCarrier, 1>::first_updater(Real lambda)
+{
+        const Eigen::Array<Real, Eigen::Dynamic, 1> mut = this->mu_.array()/this->t_.array();
+
+        this->trdS_ = -(this->w_.array()*mut/this->t_.array()).sum();
+        this->adt.t_ = -this->PsiU_*(mut*this->Ez_.array()/this->t_.array()).matrix();     // dS*z
+
+        if(this->Uf_.size()!=0)
+        {
+                this->Uh_ = ((lambda*mut-1)*this->Uf_.array()/this->t_.array()).matrix();
+                this->p_ = this->PsiU_*this->Uh_ - this->adt.t_;
+                this->adt.a_ = this->eps_hat.dot(this->p_);
+        }
+        else
+                this->adt.a_ = -this->eps_hat.dot(this->adt.t_);
+}
+
+//! Update all parameters needed to compute the gcv second derivative, depending on lambda
+/*!
+ \remark tr(ddS) = 2*sum_i w_i*mu_i^2/t_i^3 and ddS*z = 2*Psi*U*diag(mu^2/t^3)*U^t*E*z
+ \param lambda the actual value of lambda to be used for the update
+ \sa update_parameters(Real lambda), first_updater(Real lambda)
+*/
+template<typename InputCarrier>
+void GCV_Eigen<InputCarrier, 1>::second_updater(Real lambda)
+{
+        const Eigen::Array<Real, Eigen::Dynamic, 1> mut = this->mu_.array()/this->t_.array();
+
+        this->trddS_ = 2*(this->w_.array()*mut*mut/this->t_.array()).sum();
+        const VectorXr ddSz = 2*this->PsiU_*(mut*mut*this->Ez_.array()/this->t_.array()).matrix();
+
+        const VectorXr & v = (this->Uf_.size()!=0) ? this->p_ : this->adt.t_;
+        if(this->the_carrier.has_W())
+                this->adt.b_ = v.dot(VectorXr(this->the_carrier.lmbQ(v)));
+        else
+                this->adt.b_ = v.squaredNorm();
+
+        if(this->Uf_.size()!=0)
+        {
+                const VectorXr aux = -2*this->PsiU_*(mut*this->Uh_.array()).matrix();  // -2*Psi*K*h
+                this->adt.c_ = this->eps_hat.dot(aux-ddSz);
+        }
+        else
+                this->adt.c_ = -this->eps_hat.dot(ddSz);
+}
+
+// -- GCV and derivatives --
+//! Main function computes the gcv in an exact fashion, depending on lambda
+/*!
+ \param lambda the actual value of lambda to be used for the computation
+ \return the value of the gcv
+ \sa GCV_Exact<InputCarrier, 1>::compute_f(Real lambda)
+*/
+template<typename InputCarrier>
+Real GCV_Eigen<InputCarrier, 1>::compute_f(Real lambda)
+{
+        this->gu.call_to(0, lambda, this);
+
+        return AuxiliaryOptimizer::universal_GCV<InputCarrier>(this->s, this->sigma_hat_sq, this->dor);
+}
+
+//! Computes the gcv firt derivative in an exact fashion, depending on lambda
+/*!
+ \param lambda the actual value of lambda to be used for the computation
+ \return the value of the gcv first derivative
+ \sa GCV_Exact<InputCarrier, 1>::compute_fp(Real lambda)
+*/
+template<typename InputCarrier>
+Real GCV_Eigen<InputCarrier, 1>::compute_fp(Real lambda)
+{
+        this->gu.call_to(1, lambda, this);
+
+        return AuxiliaryOptimizer::universal_GCV_d<InputCarrier>(this->adt, this->s, this->sigma_hat_sq, this->dor, this->trdS_);
+}
+
+//! Computes the gcv second derivative in an exact fashion, depending on lambda
+/*!
+ \param lambda the actual value of lambda to be used for the computation
+ \return the value of the gcv second derivative
+ \sa GCV_Exact<InputCarrier, 1>::compute_fs(Real lambda)
+*/
+template<typename InputCarrier>
+Real GCV_Eigen<InputCarrier, 1>::compute_fs(Real lambda)
+{
+        this->gu.call_to(2, lambda, this);
+
+        return AuxiliaryOptimizer::universal_GCV_dd<InputCarrier>(this->adt, this->s, this->sigma_hat_sq, this->dor, this->trdS_, this->trddS_);
+}
+
+//----------------------------------------------------------------------------//
+// ** GCV_BLOCKED **
+
+// -- Utilities --
+//! Utility to left multiply a matrix by T^{-1}, solving the system of the model
+/*!
+ \param rhs the matrix to be left multiplied by T^{-1} [size nnodes x k]
+ \param lambda value of the optimization parameter
+ \return T^{-1}*rhs
+ \note the system is factorized only if lambda changed since the last solve
+*/
+template<typename InputCarrier>
+MatrixXr GCV_Blocked<InputCarrier, 1>::solve_T(const MatrixXr & rhs, Real lambda)
+{
+        const UInt nnodes = this->the_carrier.get_n_nodes();
+        MatrixXr b = MatrixXr::Zero(2*nnodes, rhs.cols());
+        b.topRows(nnodes) = rhs;
+
+        return this->the_carrier.apply_to_b(b, lambda).topRows(nnodes);
+}
+
+//! Utility to left multiply a matrix by R = R1^t*R0^{-1}*R1, without forming R
+/*!
+ \param mat the matrix to be left multiplied by R [size nnodes x k]
+ \return R*mat
+*/
+template<typename InputCarrier>
+MatrixXr GCV_Blocked<InputCarrier, 1>::multiply_by_R(const MatrixXr & mat) const
+{
+        const SpMat * R1p = this->the_carrier.get_R1p();
+
+        return (R1p->transpose())*this->R0dec_->solve(MatrixXr((*R1p)*mat));
+}
+
+//! Utility to compute the traces of S, or of its two derivatives, by blocks of unit vectors
+/*!
+ \remark with the columns X of V = T^{-1}*E for a block of unit vectors, tr(S) adds the diagonal
+ of Psi*X on the block; with Y = K*X and Z = K*Y, K = T^{-1}*R, tr(dS) adds the one of -Psi*Y and
+ tr(ddS) the one of 2*Psi*Z
+ \param lambda value of the optimization parameter
+ \param order 0 for tr(S), 1 for both tr(dS) and tr(ddS)
+*/
+template<typename InputCarrier>
+void GCV_Blocked<InputCarrier, 1>::update_traces(Real lambda, UInt order)
+{
+        const UInt nnodes = this->the_carrier.get_n_nodes();
+        const SpMat * psi_tp = this->the_carrier.get_psi_tp();
+
+        if(order == 0)
+                this->trS_ = 0.0;
+        else
+        {
+                this->trdS_ = 0.0;
+                this->trddS_ = 0.0;
+        }
+
+        for(UInt j0 = 0; j0 < this->s; j0 += block_size)
+        {
+                const UInt k = (this->s-j0 < block_size) ? this->s-j0 : block_size;
+
+                MatrixXr I_block = MatrixXr::Zero(this->s, k);
+                for(UInt i = 0; i < k; ++i)
+                        I_block.coeffRef(j0+i, i) = 1.0;
+
+                MatrixXr b = MatrixXr::Zero(2*nnodes, k);
+                AuxiliaryOptimizer::universal_b_setter(b, this->the_carrier, I_block, nnodes);
+                const MatrixXr X = this->the_carrier.apply_to_b(b, lambda).topRows(nnodes);
+
+                if(order == 0)
+                {
+                        for(UInt i = 0; i < k; ++i)
+                                this->trS_ += psi_tp->col(j0+i).dot(X.col(i));
+                }
+                else
+                {
+                        const MatrixXr Y = this->solve_T(this->multiply_by_R(X), lambda);
+                        const MatrixXr Z = this->solve_T(this->multiply_by_R(Y), lambda);
+                        for(UInt i = 0; i < k; ++i)
+                        {
+                                this->trdS_  -= psi_tp->col(j0+i).dot(Y.col(i));
+                                this->trddS_ += 2*psi_tp->col(j0+i).dot(Z.col(i));
+                        }
+                }
+        }
+}
+
+// -- Computers and dof --
+//! Utility to compute the predicted values in the locations
+/*!
+ \remark z_hat = H*z+Q*Psi*f_hat = z-Q*(z-Psi*f_hat), so that H is never needed
+ \param lambda value of the optimization parameter
+*/
+template<typename InputCarrier>
+void GCV_Blocked<InputCarrier, 1>::compute_z_hat(Real lambda)
+{
+        const UInt nnodes    = this->the_carrier.get_n_nodes();
+        const VectorXr f_hat = VectorXr(this->the_carrier.apply(lambda)).head(nnodes);
+        const VectorXr * zp  = this->the_carrier.get_zp();
+
+        if(this->the_carrier.has_W())
+                this->z_hat = (*zp) - this->the_carrier.lmbQ((*zp) - (*this->the_carrier.get_psip())*f_hat);
+        else
+                this->z_hat = (*this->the_carrier.get_psip())*f_hat;
+}
+
+//! Utility to compute the degrees of freedom of the model
+/*!
+ \param lambda value of the optimization parameter
+*/
+template<typename InputCarrier>
+void GCV_Blocked<InputCarrier, 1>::update_dof(Real lambda)
+{
+        // dof = tr(S) + #covariates
+        this->dof = this->trS_;
+
+        if(this->the_carrier.has_W()) // add number of covariates, if present
+                this->dof += (*this->the_carrier.get_Wp()).cols();
+}
+
+//! Utility to compute the degrees of freedom of the residuals
+/*!
+ \param lambda value of the optimization parameter
+ \pre update_dof() must have been called
+ \sa update_dof()
+*/
+template<typename InputCarrier>
+void GCV_Blocked<InputCarrier, 1>::update_dor(Real lambda)
+{
+        // dor = #locations - dof
+        this->dor = this->s-this->dof*this->the_carrier.get_opt_data()->get_tuning();
+
+        if (this->dor < 0)   // Just in case of bad computation
+        {
+                Rprintf("WARNING: Some values of the trace of the matrix S('lambda') are inconstistent.\n");
+                Rprintf("This might be due to ill-conditioning of the linear system.\n");
+                Rprintf("Try increasing value of 'lambda'. Value of 'lambda' that produces an error is: %d \n", lambda);
+        }
+}
+
+// -- Public updaters --
+//! Setting all the parameters which are recursively lambda dependent
+/*!
+ \remark The order in which functions are invoked is essential for the consistency of the procedure
+ \sa compute_z_hat(Real lambda), update_traces(Real lambda, UInt order), update_errors(Real lambda)
+*/
+template<typename InputCarrier>
+void GCV_Blocked<InputCarrier, 1>::update_parameters(Real lambda)
+{
+        this->compute_z_hat(lambda);
+        this->update_traces(lambda, 0);
+        this->update_errors(lambda);
+}
+
+//! Update all parameters needed to compute the gcv fist derivative, depending on lambda
+/*!
+ \remark dS*z = -Psi*K*V*z, for forced problems h = (lambda*K-I)*T^{-1}*f; tr(ddS) is computed
+ here too, since it needs the same blocks of solves as tr(dS)
+ \param lambda the actual value of lambda to be used for the update
+ \sa update_parameters(Real lambda), second_updater(Real lambda)
+*/
+template<typename InputCarrier>
+void GCV_Blocked<InputCarrier, 1>::first_updater(Real lambda)
+{
+        const UInt nnodes = this->the_carrier.get_n_nodes();
+
+        this->update_traces(lambda, 1);
+
+        MatrixXr b = MatrixXr::Zero(2*nnodes, 1);
+        AuxiliaryOptimizer::universal_b_setter(b, this->the_carrier, MatrixXr(*this->the_carrier.get_zp()), nnodes);
+        const MatrixXr Vz = this->the_carrier.apply_to_b(b, lambda).topRows(nnodes);
+        this->KVz_ = this->solve_T(this->multiply_by_R(Vz), lambda);
+        this->adt.t_ = -(*this->the_carrier.get_psip())*this->KVz_;     // dS*z
+
+        if(this->f_.size()!=0)
+        {
+                const VectorXr g = this->solve_T(this->f_, lambda);
+                this->h_ = lambda*this->solve_T(this->multiply_by_R(g), lambda) - g;
+                this->p_ = (*this->the_carrier.get_psip())*this->h_ - this->adt.t_;
+                this->adt.a_ = this->eps_hat.dot(this->p_);
+        }
+        else
+                this->adt.a_ = -this->eps_hat.dot(this->adt.t_);
+}
+
+//! Update all parameters needed to compute the gcv second derivative, depending on lambda
+/*!
+ \remark ddS*z = 2*Psi*K*K*V*z
+ \param lambda the actual value of lambda to be used for the update
+ \pre first_updater(lambda) must have been called
+ \sa update_parameters(Real lambda), first_updater(Real lambda)
+*/
+template<typename InputCarrier>
+void GCV_Blocked<InputCarrier, 1>::second_updater(Real lambda)
+{
+        const SpMat * psip = this->the_carrier.get_psip();
+        const VectorXr ddSz = 2*(*psip)*this->solve_T(this->multiply_by_R(this->KVz_), lambda);
+
+        const VectorXr & v = (this->f_.size()!=0) ? this->p_ : this->adt.t_;
+        if(this->the_carrier.has_W())
+                this->adt.b_ = v.dot(VectorXr(this->the_carrier.lmbQ(v)));
+        else
+                this->adt.b_ = v.squaredNorm();
+
+        if(this->f_.size()!=0)
+        {
+                const VectorXr aux = -2*(*psip)*this->solve_T(this->multiply_by_R(this->h_), lambda);  // -2*Psi*K*h
+                this->adt.c_ = this->eps_hat.dot(aux-ddSz);
+        }
+        else
+                this->adt.c_ = -this->eps_hat.dot(ddSz);
+}
+
+// -- GCV and derivatives --
+//! Main function computes the gcv in an exact fashion, depending on lambda
+/*!
+ \param lambda the actual value of lambda to be used for the computation
+ \return the value of the gcv
+ \sa GCV_Exact<InputCarrier, 1>::compute_f(Real lambda)
+*/
+template<typename InputCarrier>
+Real GCV_Blocked<InputCarrier, 1>::compute_f(Real lambda)
+{
+        this->gu.call_to(0, lambda, this);
+
+        return AuxiliaryOptimizer::universal_GCV<InputCarrier>(this->s, this->sigma_hat_sq, this->dor);
+}
+
+//! Computes the gcv firt derivative in an exact fashion, depending on lambda
+/*!
+ \param lambda the actual value of lambda to be used for the computation
+ \return the value of the gcv first derivative
+ \sa GCV_Exact<InputCarrier, 1>::compute_fp(Real lambda)
+*/
+template<typename InputCarrier>
+Real GCV_Blocked<InputCarrier, 1>::compute_fp(Real lambda)
+{
+        this->gu.call_to(1, lambda, this);
+
+        return AuxiliaryOptimizer::universal_GCV_d<InputCarrier>(this->adt, this->s, this->sigma_hat_sq, this->dor, this->trdS_);
+}
+
+//! Computes the gcv second derivative in an exact fashion, depending on lambda
+/*!
+ \param lambda the actual value of lambda to be used for the computation
+ \return the value of the gcv second derivative
+ \sa GCV_Exact<InputCarrier, 1>::compute_fs(Real lambda)
+*/
+template<typename InputCarrier>
+Real GCV_Blocked<InputCarrier, 1>::compute_fs(Real lambda)
+{
+        this->gu.call_to(2, lambda, this);
+
+        return AuxiliaryOptimizer::universal_GCV_dd<InputCarrier>(this->adt, this->s, this->sigma_hat_sq, this->dor, this->trdS_, this->trddS_);
+}
+
 //----------------------------------------------------------------------------//
 // ** GCV_STOCHASTIC **
 
@@ -651,39 +1182,38 @@ void GCV_Stochastic<InputCarrier, 1>::update_dof(Real lambda)
                  Rprintf("WARNING: start taking time update_dof\n");
                 */
 
-        	UInt nnodes = this->the_carrier.get_n_nodes();
-                UInt nr     = this->the_carrier.get_opt_data()->get_nrealizations();
+                if(this->in_grid(lambda) && this->grid_dof_.size() != 0)
+                {
+                        this->dof     = this->grid_dof_[this->use_index];
+                        this->dof_var = this->grid_dof_var_[this->use_index];
+                        return;
+                }
+
+        	const UInt nnodes = this->the_carrier.get_n_nodes();
 
                 if(this->us == false) // check is US matrix has been defined
                 {
                         this->set_US_();
                 }
 
-        	// Define the first right hand side : | I  0 |^T * psi^T * Q * u
-        	MatrixXr b = MatrixXr::Zero(2*nnodes, this->US_.cols());
-                UInt ret = AuxiliaryOptimizer::universal_b_setter(b, this->the_carrier, this->US_, nnodes);
-
-        	// Solve the system
-            	MatrixXr x = this->the_carrier.apply_to_b(b, lambda);
+        	// S * v = psi * | I  0 | * x, x solving the system with right hand side | I  0 |^T * psi^T * Q * v
+                const SpMat & psi = *this->the_carrier.get_psip();
+                auto applyS = [&](const MatrixXr & V)
+                {
+                        MatrixXr b = MatrixXr::Zero(2*nnodes, V.cols());
+                        AuxiliaryOptimizer::universal_b_setter(b, this->the_carrier, V, nnodes);
+                        return MatrixXr(psi*this->the_carrier.apply_to_b(b, lambda).topRows(nnodes));
+                };
 
-        	MatrixXr USTpsi = this->US_.transpose()*(*this->the_carrier.get_psip());
-        	VectorXr edf_vect(nr);
         	Real q = 0;
-
-        	// Degrees of freedom = q + E[ u^T * psi * | I  0 |* x ]
         	if (this->the_carrier.has_W())
                 {
         		q = this->the_carrier.get_Wp()->cols();
         	}
 
-        	// For any realization we calculate the degrees of freedom
-        	for (UInt i = 0; i < nr; ++i)
-                {
-        		edf_vect(i) = USTpsi.row(i).dot(x.col(i).head(nnodes)) + q;
-        	}
-
-        	// Estimates: sample mean, sample variance
-        	this->dof = edf_vect.sum()/nr;
+        	// Degrees of freedom = q + E[ u^T * S * u ], estimated on the realizations
+        	this->dof     = this->estimator_.trace(applyS, this->US_) + q;
+                this->dof_var = this->estimator_.variance();
 
                 // Deugging purpose print
                 // Rprintf("DOF:%f\n", this->dof);
@@ -696,7 +1226,8 @@ void GCV_Stochastic<InputCarrier, 1>::update_dof(Real lambda)
         else
         {
                 Rprintf("No DOF computation required\n");
-                this->dof = m(this->use_index,0);
+                this->dof     = m(this->use_index,0);
+                this->dof_var = 0;
                 //std::cout<< this->dof << std::endl;
         }
 }
@@ -737,6 +1268,12 @@ void GCV_Stochastic<InputCarrier, 1>::compute_z_hat(Real lambda)
          Rprintf("WARNING: start taking time compute_z_hat\n");
         */
 
+        if(this->in_grid(lambda))
+        {
+                this->z_hat = this->grid_z_hat_.col(this->use_index);
+                return;
+        }
+
         // Solve the system to find the predicted values of the spline coefficients
         const UInt nnodes    = this->the_carrier.get_n_nodes();
         const VectorXr f_hat = VectorXr(this->the_carrier.apply(lambda)).head(nnodes);
@@ -763,6 +1300,115 @@ void GCV_Stochastic<InputCarrier, 1>::update_parameters(Real lambda)
         this->update_errors(lambda);
 }
 
+//! Solves the systems of all the lambdas of a grid up front, if the model allows it
+/*!
+ The predicted values and the stochastic degrees of freedom of every lambda are computed here and then only read by
+ compute_z_hat and update_dof, as long as the index set by set_index points to the same lambda. The systems are solved
+ together by the multi-shift CG [see MultiShiftCG], grid_block_size realizations at a time to bound the memory, or else
+ lambda by lambda in parallel, each thread with its own factorization [see MixedFERegressionBase::factorize_lambda].
+ The multi-shift CG needs all the right hand sides up front, thus it is used only by the plain estimator of the trace.
+ \param lambdas the grid of lambdas to be evaluated
+*/
+template<typename InputCarrier>
+void GCV_Stochastic<InputCarrier, 1>::set_grid(const std::vector<Real> & lambdas)
+{
+        this->grid_lambdas_.clear();
+        const auto * model = this->the_carrier.get_model();
+        const int threads  = model->isParallelGrid() ? fdaPDEThreads() : 1;
+        const bool multishift = model->isMultiShift() && this->estimator_.isPlain();
+        if(lambdas.empty() || (!multishift && threads < 2))
+                return;
+
+        const UInt nl     = lambdas.size();
+        const UInt nnodes = this->the_carrier.get_n_nodes();
+        const UInt nr     = this->the_carrier.get_opt_data()->get_nrealizations();
+
+        // Degrees of freedom = q + E[ u^T * psi * | I  0 |* x ], unless given
+        MatrixXr m = this->the_carrier.get_opt_data()->get_DOF_matrix();
+        const bool dof_required = m.cols()!=1 || m.rows()<nl;
+        MatrixXr b = MatrixXr::Zero(2*nnodes, dof_required ? nr : 0);
+        if(dof_required)
+        {
+                if(this->us == false)
+                {
+                        this->set_US_();
+                }
+                // also sets up the products by Q before the threads share them
+                AuxiliaryOptimizer::universal_b_setter(b, this->the_carrier, this->US_, nnodes);
+        }
+        this->grid_dof_     = VectorXr::Zero(dof_required ? nl : 0);
+        this->grid_dof_var_ = VectorXr::Zero(dof_required ? nl : 0);
+
+        MatrixXr psif;
+        if(multishift)
+        {
+                psif = this->the_carrier.apply_grid(lambdas);
+                VectorXr sumsq = VectorXr::Zero(this->grid_dof_.size());
+                for(UInt k = 0; k < b.cols(); k += grid_block_size)
+                {
+                        const UInt cols = std::min(UInt(grid_block_size), UInt(b.cols())-k);
+                        std::vector<MatrixXr> x = this->the_carrier.apply_to_b_grid(b.block(0, k, nnodes, cols), lambdas);
+                        for(UInt j = 0; j < nl; ++j)
+                        {
+                                const VectorXr e = (this->US_.middleCols(k, cols).array()*x[j].array()).colwise().sum().transpose();
+                                this->grid_dof_[j] += e.sum();
+                                sumsq[j]           += e.squaredNorm();
+                        }
+                }
+                if(dof_required)
+                {
+                        this->grid_dof_ /= nr;
+                        if(nr > 1)
+                                this->grid_dof_var_ = ((sumsq/nr-this->grid_dof_.cwiseAbs2())/(nr-1)).cwiseMax(0);
+                }
+        }
+        else
+        {
+                psif.resize(this->s, nl);
+                const SpMat & psi = *this->the_carrier.get_psip();
+
+                #pragma omp parallel num_threads(threads)
+                {
+                        LambdaWorkspace workspace = model->lambdaWorkspace();
+                        TraceEstimator estimator  = this->estimator_;
+
+                        #pragma omp for schedule(dynamic)
+                        for(int j = 0; j < int(nl); ++j)
+                        {
+                                model->factorize_lambda(lambdas[j], workspace);
+                                psif.col(j) = psi*model->solve_lambda(model->rightHandSide(lambdas[j]), workspace).topRows(nnodes);
+                                if(dof_required)
+                                {
+                                        auto applyS = [&](const MatrixXr & V)
+                                        {
+                                                MatrixXr bV = MatrixXr::Zero(2*nnodes, V.cols());
+                                                AuxiliaryOptimizer::universal_b_setter(bV, this->the_carrier, V, nnodes);
+                                                return MatrixXr(psi*model->solve_lambda(bV, workspace).topRows(nnodes));
+                                        };
+                                        this->grid_dof_[j]     = estimator.trace(applyS, this->US_);
+                                        this->grid_dof_var_[j] = estimator.variance();
+                                }
+                        }
+                }
+        }
+
+        if(dof_required)
+        {
+                const Real q = this->the_carrier.has_W() ? this->the_carrier.get_Wp()->cols() : 0;
+                this->grid_dof_ = this->grid_dof_.array() + q;
+        }
+
+        // z_hat = H*z + Q*psi*f_hat
+        this->grid_z_hat_ = psif;
+        if(this->the_carrier.has_W())
+        {
+                this->grid_z_hat_ = this->the_carrier.lmbQ(this->grid_z_hat_);
+                this->grid_z_hat_.colwise() += (*this->the_carrier.get_Hp())*(*this->the_carrier.get_zp());
+        }
+
+        this->grid_lambdas_ = lambdas;
+}
+
 // -- GCV function --
 // GCV function and derivatives
 //! Main function computes the gcv in an exact fashion, depending on lambda
@@ -17,10 +17,12 @@ struct output_Data
         std::vector<Real>       rmse;                      //!< Model root mean squared error
         Real                    sigma_hat_sq    = -1.0;    //!< Model estimated variance of errors
         std::vector<Real>       dof             = {};      //!< tr(S) + q, degrees of freedom of the model
+        std::vector<Real>       dof_var         = {};      //!< Variance of the stochastic estimates of dof, 0 if exact
         Real                    lambda_sol      = 0.0;     //!< Lambda obratained in the solution
         UInt                    lambda_pos      = 0;       //!< Position of optimal lambda, only for grid evaluation, in R numebring starting from 1 (0 means no grid used)
         UInt                    n_it            = 0;       //!< Number of iterations for the method
         Real                    time_partial    = 0.0;     //!< Time, from beginning to end of the optimization method
+        Real                    peak_memory     = -1.0;    //!< Peak memory of the process in MB at the end of the optimization method, -1 if not available
         std::vector<Real>       GCV_evals       = {-1};    //!< GCV evaluations vector of explored lambda, with the optimization iterative method or grid
         std::vector<Real>       lambda_vec      = {-1};    //!< Vector of explored lambda with with the optimization iterative method or grid
         Real                    GCV_opt         = -1;      //!< GCV optimal comptued in the vector of lambdas
@@ -38,7 +38,7 @@ SEXP Solution_Builders::build_solution_plain_regression(const MatrixXr & solutio
 
         // ---- Copy results in R memory ----
         SEXP result = NILSXP;  // Define emty term --> never pass to R empty or is "R session aborted"
-        result = PROTECT(Rf_allocVector(VECSXP, 22)); // 22 elements to be allocated
+        result = PROTECT(Rf_allocVector(VECSXP, 25)); // 25 elements to be allocated
 
         // Add solution matrix in position 0
         SET_VECTOR_ELT(result, 0, Rf_allocMatrix(REALSXP, solution.rows(), solution.cols()));
@@ -193,6 +193,24 @@ SEXP Solution_Builders::build_solution_plain_regression(const MatrixXr & solutio
                         rans11[i + barycenters.rows()*j] = barycenters(i,j);
         }
 
+        // Add peak memory
+        SET_VECTOR_ELT(result, 22, Rf_allocVector(REALSXP, 1));
+        rans = REAL(VECTOR_ELT(result, 22));
+        rans[0] = output.peak_memory;
+
+        // Add the variance of the dofs
+        SET_VECTOR_ELT(result, 23, Rf_allocVector(REALSXP, output.dof_var.size()));
+        rans = REAL(VECTOR_ELT(result, 23));
+        for(UInt j = 0; j < output.dof_var.size(); j++)
+        {
+               rans[j] = output.dof_var[j];
+        }
+
+        // Add the memory of the geometry cache of the mesh
+        SET_VECTOR_ELT(result, 24, Rf_allocVector(REALSXP, 1));
+        rans = REAL(VECTOR_ELT(result, 24));
+        rans[0] = mesh.geometryCacheMemory()/(1024.*1024.);
+
         UNPROTECT(1);
 
         return(result);
@@ -0,0 +1,105 @@
+#ifndef __TRACE_ESTIMATOR_H__
+#define __TRACE_ESTIMATOR_H__
+
+#include <algorithm>
+#include <cmath>
+#include "../../FdaPDE.h"
+
+//! Reads the R option fdaPDE.dof.hutchpp, setting it to TRUE estimates the stochastic dofs by Hutch++
+inline bool hutchppOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.dof.hutchpp"));
+	return Rf_isLogical(option) && Rf_length(option) > 0 && LOGICAL(option)[0] == TRUE;
+}
+
+//! Reads the R option fdaPDE.dof.tolerance, the relative standard error of the stochastic dofs at which no more realizations are used (0, all of them, if not set)
+inline Real dofToleranceOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.dof.tolerance"));
+	if(Rf_isNumeric(option) && Rf_length(option) > 0 && Rf_asReal(option) > 0)
+		return Rf_asReal(option);
+	return 0;
+}
+
+//!  A stochastic estimator of the trace of a matrix S known through its products
+/*!
+ * The probes are the columns of a given matrix U of +1/-1 entries, so that the same realizations can be used for every
+ * lambda. The plain Hutchinson estimate is the mean of u^T * S * u over the columns. Hutch++ spends a third of them on the
+ * sketch S * U1, whose orthonormal basis Q gives exactly the trace of Q^T * S * Q, and another third on the Hutchinson
+ * estimate of the trace of the rest, (I - Q * Q^T) * S * (I - Q * Q^T): its variance is far smaller when the trace of S is
+ * concentrated on fewer directions than the sketch, larger when S is close to a diagonal matrix. With a positive tolerance
+ * the probes of the Hutchinson part are taken by blocks, stopping once the standard error is below tolerance times the
+ * trace. The variance of the last estimate (of its Hutchinson part with Hutch++) and the number of columns multiplied by S
+ * are kept. The constructors do not call the R API if hutchpp and tolerance are given.
+*/
+class TraceEstimator{
+	public:
+	TraceEstimator(bool hutchpp, Real tolerance): hutchpp_(hutchpp), tolerance_(tolerance) {}
+	//! Reads fdaPDE.dof.hutchpp and fdaPDE.dof.tolerance
+	TraceEstimator(): TraceEstimator(hutchppOption(), dofToleranceOption()) {}
+
+	//! Whether the estimate is the plain mean over all the probes
+	bool isPlain() const {return !hutchpp_ && tolerance_ <= 0;}
+
+	//! Estimate of the trace of S, applyS(V) returning S * V for a matrix V with the rows of U
+	template<typename ApplyS>
+	Real trace(ApplyS applyS, const MatrixXr & U)
+	{
+		const UInt nr = U.cols();
+		Real lowrank = 0;
+		MatrixXr Q;
+		UInt first = 0, last = nr;
+		products_ = 0;
+		if(hutchpp_ && nr >= 3)
+		{
+			const UInt k = std::min(nr/3, UInt(U.rows()));
+			const MatrixXr Y = applyS(U.leftCols(k));
+			Q = Eigen::HouseholderQR<MatrixXr>(Y).householderQ()*MatrixXr::Identity(U.rows(), k);
+			lowrank = (Q.transpose()*applyS(Q)).trace();
+			products_ = 2*k;
+			first = k;
+			last = nr-k;
+		}
+
+		// Hutchinson on the probes projected out of the range of Q [if any]
+		Real sum = 0, sumsq = 0;
+		UInt count = 0;
+		variance_ = 0;
+		const UInt block = tolerance_ > 0 ? UInt(block_size) : std::max(last-first, UInt(1));
+		for(UInt j = first; j < last; j += block)
+		{
+			const UInt cols = std::min(block, last-j);
+			MatrixXr G = U.middleCols(j, cols);
+			if(Q.cols() != 0)
+				G -= Q*(Q.transpose()*G);
+			const MatrixXr SG = applyS(G);
+			for(UInt i = 0; i < cols; ++i)
+			{
+				const Real e = G.col(i).dot(SG.col(i));
+				sum += e;
+				sumsq += e*e;
+			}
+			count += cols;
+			products_ += cols;
+
+			const Real mean = sum/count;
+			variance_ = count > 1 ? std::max(sumsq-count*mean*mean, Real(0))/(count-1)/count : 0;
+			if(tolerance_ > 0 && count >= 2*block_size && std::sqrt(variance_) <= tolerance_*std::abs(lowrank+mean))
+				break;
+		}
+		return lowrank + (count > 0 ? sum/count : 0);
+	}
+
+	Real variance() const {return variance_;}	//!< Variance of the last estimate
+	UInt products() const {return products_;}	//!< Number of columns multiplied by S for the last estimate
+
+	static constexpr UInt block_size = 10;		//!< Probes added at a time with a positive tolerance
+
+	private:
+	bool hutchpp_;
+	Real tolerance_;
+	Real variance_ = 0;
+	UInt products_ = 0;
+};
+
+#endif
@@ -17,7 +17,23 @@
 #include "Domain.h"
 #include "Tree_Node.h"
 #include "Exception_Handling.h"
+#include "../../Global_Utilities/Include/Parallel.h"
+#include <numeric>
+#include <memory>
 
+/// Largest number of dimensions used for the search (boxes in 3D).
+constexpr int ADTreeMaxDimt = 6;
+/// Number of tree levels the search stack holds before moving to the heap.
+constexpr int ADTreeStackSize = 128;
+/// Number of elements below which a subtree is built by the thread that found it.
+constexpr int ADTreeTaskSize = 4096;
+
+/// A node whose right subtree is still to be searched, with the origin of its cell and its level.
+struct ADTreeStackEntry {
+  int ipoi;
+  Real xl[ADTreeMaxDimt];
+  int lev;
+};
 
 /**	\class ADTree
  * 	\brief Alternating binary range searching tree.
@@ -33,6 +49,10 @@ protected:
   TreeHeader<Shape> header_;
   /// Vector of tree nodes.
   std::vector<TreeNode<Shape>> data_;
+  /// Tree nodes stored outside the tree (in a mesh image), nullptr if they are in data_.
+  TreeNode<Shape> const * nodes_ = nullptr;
+  /// Keeps alive the memory holding nodes_.
+  std::shared_ptr<const void> storage_;
   /** \brief Adds a point to the tree.
    * 	It throws:
    * 	<ul>
@@ -42,6 +62,19 @@ protected:
    * 	</ul>
    */
   int adtrb(Id shapeid, std::vector<Real> const & coords);
+  /// Adds the elements of the mesh to the tree one by one through addtreenode.
+  void insertelements(Real const * const points, UInt const * const triangle, UInt num_nodes, UInt num_triangle, UInt nnodes);
+  /** Fills the tree with all the elements of the mesh at once, building the subtrees in parallel.
+   *
+   *  The resulting tree is the same built by insertelements. It returns false, leaving the tree
+   *  to be filled again, if an element lies out of the domain.
+   */
+  bool bulkload(Real const * const points, UInt const * const triangle, UInt num_nodes, UInt num_triangle, UInt nnodes);
+  /** Builds the subtree of the cell containing the elements in [first, last), sorted by id,
+   *  whose scaled coordinates are in x; scratch has room for last-first ids. It returns the
+   *  deepest level of the subtree.
+   */
+  int buildsubtree(int * first, int * last, int * scratch, Real * x, int lev);
   /// Handles a TreeDomainError exception.
   int handledomerr(Id shapeid, std::vector<Real> const & coords);
   /// Handles a TreeAlloc exception.
@@ -62,7 +95,7 @@ protected:
    * 	\param[in] dim The number of dimensions used for the search.
    */
   inline double delta(int const & lev, int const & dim) const {
-    return std::pow(0.5, int(lev/dim)+1);
+    return std::ldexp(1., -(int(lev/dim)+1));
   }
 public:
   /**	A default constructor.
@@ -94,10 +127,17 @@ public:
   // constructor in case there is already tree information
   ADTree(TreeHeader<Shape> const & header, std::vector<TreeNode<Shape>> const & data):header_(header), data_(data) {};
 
+  /** Constructor in case the tree nodes are already stored in memory (see MeshImage).
+   *
+   *  The nodes are not copied: storage must keep them alive, unless they outlive the tree.
+   */
+  ADTree(TreeHeader<Shape> const & header, TreeNode<Shape> const * nodes, std::shared_ptr<const void> storage = std::shared_ptr<const void>()):
+    header_(header), nodes_(nodes), storage_(storage) {};
+
   /** It fills all the locations of the tree. Object's coordinates are stored to perform searching operations.
-   * 	See mesh_handler to verify what points and triangle must contain.
+   * 	See mesh_handler to verify what points and triangle must contain; each element has nnodes nodes, the vertices first.
    */
-  ADTree(Real const * const points, UInt const * const triangle, UInt num_nodes, UInt num_triangle);
+  ADTree(Real const * const points, UInt const * const triangle, UInt num_nodes, UInt num_triangle, UInt nnodes);
 
   /// Returns a reference to the tree header.
   inline TreeHeader<Shape> gettreeheader() const { return header_; }
@@ -120,7 +160,9 @@ public:
    *
    * 	\param[in] loc Location of the searched node.
    */
-  inline TreeNode<Shape> gettreenode(int const & loc) const{return data_[loc];};
+  inline TreeNode<Shape> gettreenode(int const & loc) const{return nodes()[loc];};
+  /// Returns the tree nodes, the head first.
+  inline TreeNode<Shape> const * nodes() const { return nodes_ ? nodes_ : data_.data(); }
 
   /** Finds all points or (bounding) boxes that intersect a given box.
    *
@@ -130,12 +172,22 @@ public:
    * 	This function returns true if it has completed successfully, false otherwise.
    */
   bool search(std::vector<Real> const & region, std::set<int> & found)const;
+  /** Visits all points or (bounding) boxes that intersect a given box, without allocating memory.
+   *
+   * 	\param[in] region Box where searching (minimum corner followed by maximum corner, as in search).
+   * 	\param[in] visit Callable invoked with the location of every intersecting node, in preorder;
+   * 	it returns true to stop the search.
+   *
+   * 	This function returns true if the search has been stopped by visit, false otherwise.
+   */
+  template<class Visitor>
+  bool searchUntil(Real const * region, Visitor visit) const;
   /// Deletes a specified location in the tree.
   //void deltreenode(int const & index);
   /// Gets the j-th coordinate of the bounding box of the p-th object stored in the node.
-  inline Real pointcoord(int const & p, int const & j) const { return data_[p].getcoord(j); }
+  inline Real pointcoord(int const & p, int const & j) const { return nodes()[p].getcoord(j); }
   /// Gets the the Id of the original object of the p-th treenode.
-  inline Id pointId (int const & p) const { return data_[p].getid(); }
+  inline Id pointId (int const & p) const { return nodes()[p].getid(); }
   /// Outputs informations contained in the tree header.
   template<class S>
   friend std::ostream & operator<<(std::ostream & ostr, ADTree<S> const & myadt);
@@ -21,9 +21,8 @@ ADTree<Shape>::ADTree(TreeHeader<Shape> const & header): header_(header) {
 
 //Shape is given as Element<NNODES,myDim,nDim> from mesh.h
 template<class Shape>
-ADTree<Shape>::ADTree(Real const * const points, UInt const * const triangle, const UInt num_nodes, const UInt num_triangle) {
+ADTree<Shape>::ADTree(Real const * const points, UInt const * const triangle, const UInt num_nodes, const UInt num_triangle, const UInt nnodes) {
     int ndimp = Shape::dp(); //physical dimension
-    int nvertex = Shape::numVertices; //number of nodes at each Element (not total number of nodes!)
 
     // Build the tree.
 
@@ -70,7 +69,20 @@ ADTree<Shape>::ADTree(Real const * const points, UInt const * const triangle, co
     data_.push_back(TreeNode<Shape>(id, obj)); // Id, obj are arbitrary parameters. Remember that data_[0] is the head, not a tree node.
 
 
-    // Step 3: Fill the tree: Add each element to the Treenode
+    // Step 3: Fill the tree, all the elements at once if they lie in the domain (as they should)
+    if(!bulkload(points, triangle, num_nodes, num_triangle, nnodes)) {
+      data_.resize(1);
+      data_[0].setchild(0, 0);
+      insertelements(points, triangle, num_nodes, num_triangle, nnodes);
+    }
+  }
+
+template<class Shape>
+void ADTree<Shape>::insertelements(Real const * const points, UInt const * const triangle, const UInt num_nodes, const UInt num_triangle, const UInt nnodes) {
+    int ndimp = Shape::dp(); //physical dimension
+    int nvertex = Shape::numVertices; //number of nodes at each Element (not total number of nodes!)
+
+    // Add each element to the Treenode
     UInt idpt;
 
     std::vector<Real> elem(nvertex*ndimp); //'elem' is a single Element, composed of vector of points
@@ -86,7 +98,7 @@ ADTree<Shape>::ADTree(Real const * const points, UInt const * const triangle, co
         //else clause to be deleted after integrating mesh structure of 2D vs 2.5,3D
         for (int j=0; j< nvertex; j++) {
           for (int l=0; l < ndimp; l++) {
-            idpt = triangle[j + i*nvertex];
+            idpt = triangle[j + i*nnodes];
             elem[j*ndimp + l] =  points[idpt*ndimp + l];
           }
         }
@@ -95,8 +107,134 @@ ADTree<Shape>::ADTree(Real const * const points, UInt const * const triangle, co
       //insert Element into tree
       this -> addtreenode(i, elem);
      } //end of for loop
+}
+
+template<class Shape>
+bool ADTree<Shape>::bulkload(Real const * const points, UInt const * const triangle, const UInt num_nodes, const UInt num_triangle, const UInt nnodes) {
+  /*
+   * Inserting the elements one by one, the i-th element takes the (i+1)-th location and sits in the
+   * first free cell along its path: every cell is then occupied by the element with the smallest id
+   * among the ones falling in it and not taken by an ancestor cell. The same tree can be built top-down:
+   * the first element of a cell takes it, the others are split between the two halves of the cell
+   * and the two subtrees are built independently (in parallel for large cells).
+   */
+  int ndimp = Shape::dp();
+  int nvertex = Shape::numVertices;
+  int dimt = header_.getndimt();
+
+  if(num_triangle == 0) {
+    return true;
+  }
+
+  data_.resize(num_triangle+1);
+
+  // x stores the scaled coordinates of the bounding boxes, as in adtrb
+  std::vector<Real> x(num_triangle*dimt);
+  bool outside = false;
+  const int threads = fdaPDEThreads();
+
+  #pragma omp parallel num_threads(threads)
+  {
+    std::vector<Real> box(dimt);
+
+    #pragma omp for reduction(||:outside)
+    for(int i = 0; i < num_triangle; ++i) {
+      for(int l = 0; l < ndimp; ++l) {
+        for(int j = 0; j < nvertex; ++j) {
+          //points are stored by columns in 2D and by rows in 2.5D and 3D
+          Real coord = (ndimp == 2) ? points[triangle[j*num_triangle + i] + l*num_nodes] :
+                                      points[triangle[j + i*nnodes]*ndimp + l];
+          box[l] = (j == 0) ? coord : std::min(box[l], coord);
+          box[l+ndimp] = (j == 0) ? coord : std::max(box[l+ndimp], coord);
+        }
+      }
+      data_[i+1] = TreeNode<Shape>(Box<Shape::dp()>(box), i, 0, 0);
+
+      for(int k = 0; k < dimt; ++k) {
+        Real val = (box[k]-header_.domainorig(k))*header_.domainscal(k);
+        if( (val<0.) || (val>1.) )
+          outside = true;
+        x[i*dimt + k] = val;
+      }
+    }
+  }
+
+  if(outside) {
+    // Let the element by element insertion report the problem
+    return false;
+  }
+
+  std::vector<int> elements(num_triangle);
+  std::iota(elements.begin(), elements.end(), 0);
+  std::vector<int> scratch(num_triangle);
+
+  int treelev = 0;
+  #pragma omp parallel num_threads(threads)
+  {
+    #pragma omp single
+    treelev = buildsubtree(elements.data(), elements.data()+num_triangle, scratch.data(), x.data(), 0);
+  }
+
+  // Set the root and the header as the element by element insertion would have done.
+  data_[0].setchild(0, 1);
+  header_.setnele(num_triangle);
+  header_.setiava(num_triangle+1);
+  header_.setiend(num_triangle+1);
+  header_.settreelev(treelev);
+  if(treelev > LevRuntimeError<Shape>::getmaxtreelev()) {
+    std::cout << "warning! maximum number of tree levels exceeded" << std::endl;
+    std::cout << "the limit is " << LevRuntimeError<Shape>::getmaxtreelev() << std::endl;
+    std::cout << "setting the new limit to " << treelev << std::endl;
+    LevRuntimeError<Shape>::setmaxtreelev(treelev);
+  }
+
+  return true;
+}
+
+template<class Shape>
+int ADTree<Shape>::buildsubtree(int * first, int * last, int * scratch, Real * x, int lev) {
+  int dimt = header_.getndimt();
+
+  // The element with the smallest id takes the cell.
+  int ipoi = *first + 1;
+  ++first;
+  if(first == last) {
+    return lev;
   }
 
+  // Split the others between the two halves of the cell, with the same arithmetic of adtrb.
+  int id = searchdim(lev, dimt);
+  // The left ones are compacted in place (keeping the order), the right ones go through scratch.
+  int * middle = first;
+  int nright = 0;
+  for(int * e = first; e != last; ++e) {
+    Real & val = x[(*e)*dimt + id];
+    val *= 2.;
+    if(val < 1.) {
+      *middle++ = *e;
+    } else {
+      --val;
+      scratch[nright++] = *e;
+    }
+  }
+  std::copy(scratch, scratch+nright, middle);
+
+  int levleft = lev;
+  int levright = lev;
+  if(first != middle) {
+    data_[ipoi].setchild(0, *first + 1);
+    #pragma omp task shared(levleft) if(middle - first > ADTreeTaskSize)
+    levleft = buildsubtree(first, middle, scratch, x, lev+1);
+  }
+  if(middle != last) {
+    data_[ipoi].setchild(1, *middle + 1);
+    levright = buildsubtree(middle, last, scratch+(middle-first), x, lev+1);
+  }
+  #pragma omp taskwait
+
+  return std::max(levleft, levright);
+}
+
 
 template<class Shape>
 int ADTree<Shape>::adtrb(Id shapeid, std::vector<Real> const & coords) {
@@ -320,53 +458,77 @@ void ADTree<Shape>::gettri(int const & loc, std::vector<Real> & coord, Id & id)
   coord.clear();
   coord.reserve(Shape::dt());
   for (int i = 0; i< Shape::dt(); ++i) {
-    coord.push_back(data_[loc].getcoord(i));
+    coord.push_back(nodes()[loc].getcoord(i));
   }
-   id = data_[loc].getid();
+   id = nodes()[loc].getid();
 }
 
 template<class Shape>
 bool ADTree<Shape>::search(std::vector<Real> const & region, std::set<int> & found) const {
+  found.clear();
+  searchUntil(region.data(), [&found](int loc) { found.insert(loc); return false; });
+  return !found.empty(); //if empty, return False; if not empty, return True
+}
 
-  // This function returns true if it has completed successfully, false otherwise.
+template<class Shape>
+template<class Visitor>
+bool ADTree<Shape>::searchUntil(Real const * region, Visitor visit) const {
+
+  // This function returns true if visit stopped the search, false otherwise.
+
+  // The nodes may be stored in the tree or in a mesh image.
+  TreeNode<Shape> const * data = nodes();
 
   // Start preorder traversal at level 0 (root).
-  int ipoi = data_[0].getchild(0);
+  int ipoi = data[0].getchild(0);
   int ipoiNext = 0;
   int dimp = header_.getndimp();
   int dimt = header_.getndimt();
 
+  // Domain origin and scaling factors, read once per query.
+  Real orig[ADTreeMaxDimt];
+  Real scal[ADTreeMaxDimt];
+  for(int i = 0; i < dimt; ++i) {
+    orig[i] = header_.domainorig(i);
+    scal[i] = header_.domainscal(i);
+  }
+
   // xl is the origin point for searching.
-  std::vector<Real> xl(dimt, 0);
+  Real xl[ADTreeMaxDimt] = {};
 
-  std::vector<Real> box(2*dimp, 0);
-  std::vector<Real> xel(2*dimp, 0);
+  Real box[ADTreeMaxDimt];
+  Real xel[ADTreeMaxDimt];
 
-  std::stack<std::vector<Real> > _stack;
-  found.clear();
+  /*
+   * The stack holds the nodes whose right subtree is still to be visited, at most one per level:
+   * it lives on the call stack unless the tree is deeper than ADTreeStackSize levels.
+   */
+  ADTreeStackEntry local_stack[ADTreeStackSize];
+  std::vector<ADTreeStackEntry> deep_stack;
+  ADTreeStackEntry * _stack = local_stack;
+  if(header_.gettreelev()+1 > ADTreeStackSize) {
+    deep_stack.resize(header_.gettreelev()+1);
+    _stack = deep_stack.data();
+  }
+  int top = 0;
 
   int lev = 0;
 
   // Check if the region intersects the domain.
   for(int i = 0; i < dimp; ++i) {
-    double orig = header_.domainorig(i);
-    double scal = header_.domainscal(i);
-
-    if(region[i] > orig+(1./scal)) { //region[i]: min of what we are searching for, orig+(1./scal): max of our domain
-      return 0;
+    if(region[i] > orig[i]+(1./scal[i])) { //region[i]: min of what we are searching for, orig+(1./scal): max of our domain
+      return false;
     }
-    if(region[i+dimp] < orig) {  // region[i+dimp]:max of what we are searching for, orig: min of our domain
-      return 0;
+    if(region[i+dimp] < orig[i]) {  // region[i+dimp]:max of what we are searching for, orig: min of our domain
+      return false;
     }
   }
 
   // Rescale the region.
   // box is rescaled region
   for(int i = 0; i < dimp; ++i) {
-    Real orig = header_.domainorig(i);
-    Real scal = header_.domainscal(i);
-    box[i] = (region[i]-orig)*scal;
-    box[i+dimp] = (region[i+dimp]-orig)*scal;
+    box[i] = (region[i]-orig[i])*scal[i];
+    box[i+dimp] = (region[i+dimp]-orig[i])*scal[i];
   }
 
   /*
@@ -378,11 +540,9 @@ bool ADTree<Shape>::search(std::vector<Real> const & region, std::set<int> & fou
    */
   while(ipoi != 0) {
     do {
-      //xel is rescaled data_[ipoi]
+      //xel is rescaled data[ipoi]
       for(int i = 0; i < dimt; ++i) {
-        Real orig = header_.domainorig(i);
-        Real scal = header_.domainscal(i);
-        xel[i] = (data_[ipoi].getcoord(i)-orig)*scal;
+        xel[i] = (data[ipoi].getcoord(i)-orig[i])*scal[i];
       }
 
       if(dimp == dimt) {
@@ -402,15 +562,14 @@ bool ADTree<Shape>::search(std::vector<Real> const & region, std::set<int> & fou
       }
 
       if(flag == 0) {
-        found.insert(ipoi); //insert the first node that if found and then go on with the sub-tree
-        /*
-         * Put here all the action needed when an element is found which
-         * intersects the box.
-         */
+        // Hand the node to the caller, which may end the search here.
+        if(visit(ipoi)) {
+          return true;
+        }
       }
 
       // Traverse left subtree.
-      ipoiNext = data_[ipoi].getchild(0);
+      ipoiNext = data[ipoi].getchild(0);
 
       // Check if subtree intersects box.
       if(ipoiNext != 0) {
@@ -433,14 +592,10 @@ bool ADTree<Shape>::search(std::vector<Real> const & region, std::set<int> & fou
        * Push ipoi onto the stack.
        */
       if (ipoiNext != 0) {
-        std::vector<Real> stackele;
-        stackele.reserve(dimt+2);
-        stackele.push_back(ipoi);
-        for (int i = 0; i < dimt; ++i) {
-          stackele.push_back(xl[i]);
-        }
-        stackele.push_back(lev);
-        _stack.push(stackele);
+        ADTreeStackEntry & stackele = _stack[top++];
+        stackele.ipoi = ipoi;
+        std::copy(xl, xl+dimt, stackele.xl);
+        stackele.lev = lev;
         ipoi = ipoiNext;
         ++lev;
       }
@@ -449,20 +604,17 @@ bool ADTree<Shape>::search(std::vector<Real> const & region, std::set<int> & fou
 
     // Traverse right subtree.
     ++lev;
-    ipoi = data_[ipoi].getchild(1);
+    ipoi = data[ipoi].getchild(1);
     do {
       // If right_link is null we have to get the point from the stack.
       while (ipoi == 0) {
-        if(_stack.empty()) { //when reached last right_link,
-          return !found.empty(); //searching finished
+        if(top == 0) { //when reached last right_link,
+          return false; //searching finished
         }
-        std::vector<Real> stackele(_stack.top());
-        _stack.pop();
-        ipoi = data_[stackele[0]].getchild(1);
-        for(int i = 0; i < dimt; ++i) {
-          xl[i] = stackele[i+1];
-        }
-        lev = stackele[dimt+1]+1;
+        const ADTreeStackEntry & stackele = _stack[--top];
+        ipoi = data[stackele.ipoi].getchild(1);
+        std::copy(stackele.xl, stackele.xl+dimt, xl);
+        lev = stackele.lev+1;
       }
 
       /*
@@ -493,7 +645,7 @@ bool ADTree<Shape>::search(std::vector<Real> const & region, std::set<int> & fou
 
   } //end of while
 
-  return !found.empty(); //if empty, return False; if not empty, return True
+  return false;
 }
 
 // template<class Shape>
@@ -0,0 +1,62 @@
+#ifndef __ASSEMBLY_PATTERN_H__
+#define __ASSEMBLY_PATTERN_H__
+
+#include "../../FdaPDE.h"
+#include "Mesh_Adjacency.h"
+
+/**	\class AssemblyPattern
+ * 	\brief Sparsity pattern of the finite element matrices of a mesh and map from the local matrices to its entries.
+ *	\param Shape: template parameter, the element of the mesh (Element<NNODES,mydim,ndim>)
+ *
+ *	The pattern (the nodes sharing an element, in compressed column storage) depends only on the
+ *	connectivity, so it is computed once per mesh. The local matrices of the elements are given
+ *	one after the other, nnodes x nnodes values by rows per element: value k of the local matrices
+ *	is the "slot" k. For every entry of the pattern the map lists the slots summed into it, in
+ *	increasing order, that is in the order of the elements as setFromTriplets would sum them.
+ *	A numeric assembly then writes the sums straight in the values of the matrix, without
+ *	triplets and without sorting.
+ */
+template<class Shape>
+class AssemblyPattern {
+public:
+	/// Default constructor, the pattern of an empty mesh.
+	AssemblyPattern(): outer_(1, 0), slot_start_(1, 0) {};
+
+	/** It builds the pattern and the map.
+	 * 	Elements are stored as in MeshHandler: by columns in 2D, by rows in 2.5D and 3D.
+	 *	\param[in] adjacency The adjacency tables of the mesh, for the nodes sharing an element.
+	 *	\param[in] nnodes The number of nodes of each element.
+	 */
+	AssemblyPattern(const MeshAdjacency<Shape> & adjacency, UInt const * const elements, UInt num_elements, UInt nnodes);
+
+	/** Sums the local matrices into a matrix with the pattern.
+	 *	\param[in] local The local matrices, nnodes*nnodes values by rows for each element.
+	 *	\param[out] mat The matrix, number of nodes x number of nodes, in compressed storage.
+	 *	\param[in] threads The number of threads summing the entries.
+	 */
+	void assemble(const std::vector<Real> & local, SpMat & mat, int threads) const;
+
+	/// Returns the number of nodes, 0 if the pattern has not been built.
+	inline UInt numNodes() const { return outer_.size()-1; }
+	/// Returns the number of entries of the pattern.
+	inline UInt nonZeros() const { return inner_.size(); }
+	/// Returns the memory, in bytes, used by the pattern and the map.
+	inline std::size_t memory() const
+	{
+		return (outer_.capacity()+inner_.capacity())*sizeof(UInt) + (slot_start_.capacity()+slots_.capacity())*sizeof(std::size_t);
+	}
+
+private:
+	/// Position in inner_ of the first entry of each column (numNodes()+1 values).
+	std::vector<UInt> outer_;
+	/// Row of the entries, column after column, in increasing order.
+	std::vector<UInt> inner_;
+	/// Position in slots_ of the first slot of each entry (nonZeros()+1 values).
+	std::vector<std::size_t> slot_start_;
+	/// Slots summed into the entries, entry after entry: nnodes*nnodes*num_elements may exceed UInt on large meshes.
+	std::vector<std::size_t> slots_;
+};
+
+#include "Assembly_Pattern_imp.h"
+
+#endif
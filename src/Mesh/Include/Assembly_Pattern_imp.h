@@ -0,0 +1,80 @@
+#ifndef __ASSEMBLY_PATTERN_IMP_H__
+#define __ASSEMBLY_PATTERN_IMP_H__
+
+#include <algorithm>
+
+template<class Shape>
+AssemblyPattern<Shape>::AssemblyPattern(const MeshAdjacency<Shape> & adjacency, UInt const * const elements, UInt num_elements, UInt nnodes)
+{
+	const UInt num_nodes = adjacency.numNodes();
+	//elements are stored by columns in 2D and by rows in 2.5D and 3D
+	auto node = [&](UInt element, UInt i) {
+		return (Shape::dp() == 2) ? elements[i*num_elements + element] : elements[element*nnodes + i];
+	};
+
+	// Pattern: column n holds n and the nodes sharing an element with it (the matrices are symmetric in structure)
+	outer_.assign(num_nodes+1, 0);
+	for(UInt n = 0; n < num_nodes; ++n)
+	{
+		UInt const * begin, * end;
+		adjacency.nodeNodes(n, begin, end);
+		outer_[n+1] = outer_[n] + (end-begin) + 1;
+	}
+	inner_.resize(outer_.back());
+	for(UInt n = 0; n < num_nodes; ++n)
+	{
+		UInt const * begin, * end;
+		adjacency.nodeNodes(n, begin, end);
+		UInt * column = inner_.data() + outer_[n];
+		UInt const * middle = std::lower_bound(begin, end, n);
+		column = std::copy(begin, middle, column);
+		*column++ = n;
+		std::copy(middle, end, column);
+	}
+
+	// Map: the slots grouped by entry, counting sort so that they stay in increasing order. The entry of
+	// a slot is found by a binary search in its column, once to count the slots and once to place them
+	auto entry = [&](UInt e, UInt i, UInt j) {
+		const UInt row = node(e, i), col = node(e, j);
+		return std::lower_bound(inner_.begin()+outer_[col], inner_.begin()+outer_[col+1], row) - inner_.begin();
+	};
+	const std::size_t nslots = std::size_t(nnodes)*nnodes*num_elements;
+	slot_start_.assign(inner_.size()+1, 0);
+	for(UInt e = 0; e < num_elements; ++e)
+		for(UInt i = 0; i < nnodes; ++i)
+			for(UInt j = 0; j < nnodes; ++j)
+				++slot_start_[entry(e, i, j)+1];
+	for(UInt p = 0; p < inner_.size(); ++p)
+		slot_start_[p+1] += slot_start_[p];
+
+	slots_.resize(nslots);
+	std::vector<std::size_t> next(slot_start_.begin(), slot_start_.end()-1);
+	std::size_t k = 0;
+	for(UInt e = 0; e < num_elements; ++e)
+		for(UInt i = 0; i < nnodes; ++i)
+			for(UInt j = 0; j < nnodes; ++j, ++k)
+				slots_[next[entry(e, i, j)]++] = k;
+}
+
+template<class Shape>
+void AssemblyPattern<Shape>::assemble(const std::vector<Real> & local, SpMat & mat, int threads) const
+{
+	const UInt num_nodes = numNodes();
+	mat.resize(num_nodes, num_nodes);
+	mat.resizeNonZeros(nonZeros());
+	std::copy(outer_.begin(), outer_.end(), mat.outerIndexPtr());
+	std::copy(inner_.begin(), inner_.end(), mat.innerIndexPtr());
+
+	Real * values = mat.valuePtr();
+	#pragma omp parallel for num_threads(threads) schedule(static)
+	for(int p = 0; p < int(nonZeros()); ++p)
+	{
+		// The first slot is copied and the others added, as setFromTriplets does (a node without elements has none)
+		Real s = (slot_start_[p] < slot_start_[p+1]) ? local[slots_[slot_start_[p]]] : 0.;
+		for(std::size_t k = slot_start_[p]+1; k < slot_start_[p+1]; ++k)
+			s += local[slots_[k]];
+		values[p] = s;
+	}
+}
+
+#endif
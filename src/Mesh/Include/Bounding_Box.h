@@ -15,11 +15,12 @@
 template<int NDIMP>
 class Box {
 protected:
-	/** A vector of rectangle corner coordinates.
+	/** An array of rectangle corner coordinates.
 	 * 	First NDIMP values are the coordinates of the rectangle corner with minimum coordinates,
 	 *  followed by the coordinates of the opposite corner. (2D: xmin, ymin, xmax, ymax)
+	 *  Fixed size storage keeps the tree nodes contiguous in memory.
 	 */
-	std::vector<Real> x_;
+	std::array<Real, 2*NDIMP> x_;
 
 public:
 	/**	Default constructor.
@@ -63,7 +64,7 @@ public:
 
 	/** Gets coordinate values.
 	 */
-	std::vector<Real> get() const {return x_; };
+	std::array<Real, 2*NDIMP> const & get() const {return x_; };
 
 	/** print minimum box point and maximum box point
 	*/
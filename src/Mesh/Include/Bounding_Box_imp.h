@@ -4,16 +4,14 @@
 
 template<int NDIMP>
 Box<NDIMP>::Box() {
-	x_.resize(2*NDIMP); //multiply 2 for min, max
-	for(int i = 0; i < 2*NDIMP; ++i) {
+	for(int i = 0; i < 2*NDIMP; ++i) { //multiply 2 for min, max
 		x_[i] = 0;
 	}
 }
 
 template<int NDIMP>
 Box<NDIMP>::Box(std::vector<Real> const & coord) {
-	x_.resize(2*NDIMP); //multiply 2 for min, max
-	for(int i = 0; i < 2*NDIMP; ++i) {
+	for(int i = 0; i < 2*NDIMP; ++i) { //multiply 2 for min, max
 		x_[i] = coord[i];
 	}
 }
@@ -29,29 +27,15 @@ Box<NDIMP>::Box(Element<NNODES,NDIME,NDIMPP> const & element) {
 	 //    std::exit(EXIT_FAILURE);
 	 //  } else {
 
-	if(NDIME == 2 && NDIMPP == 2) {
-		x_.resize(2*NDIMP); //4
-		x_[0] = std::min(std::min(element[0][0], element[1][0]), element[2][0]); //min x
-		x_[1] = std::min(std::min(element[0][1], element[1][1]), element[2][1]); //min y
-		x_[2] = std::max(std::max(element[0][0], element[1][0]), element[2][0]); //max x
-		x_[3] = std::max(std::max(element[0][1], element[1][1]), element[2][1]); //max y
-  	} else if(NDIME == 2 && NDIMPP == 3) {
-  		x_.resize(3*NDIMP); //6
-		x_[0] = std::min(std::min(element[0][0], element[1][0]), element[2][0]); //min x
-		x_[1] = std::min(std::min(element[0][1], element[1][1]), element[2][1]); //min y
-		x_[2] = std::min(std::min(element[0][2], element[1][2]), element[2][2]); //min z
-		x_[3] = std::max(std::max(element[0][0], element[1][0]), element[2][0]); //max x
-		x_[4] = std::max(std::max(element[0][1], element[1][1]), element[2][1]); //max y
-		x_[5] = std::max(std::max(element[0][2], element[1][2]), element[2][2]); //max z
-  	} else if(NDIME == 3 && NDIMPP == 3) { //Tetrahedron has 4 nodes
-  		x_.resize(3*NDIMP); //6
-		x_[0] = std::min(std::min(std::min(element[0][0], element[1][0]), element[2][0]), element[3][0]); //min x
-		x_[1] = std::min(std::min(std::min(element[0][1], element[1][1]), element[2][1]), element[3][1]); //min y
-		x_[2] = std::min(std::min(std::min(element[0][2], element[1][2]), element[2][2]), element[3][2]); //min z
-		x_[3] = std::max(std::max(std::max(element[0][0], element[1][0]), element[2][0]), element[3][0]); //max x
-		x_[4] = std::max(std::max(std::max(element[0][1], element[1][1]), element[2][1]), element[3][1]); //max y
-		x_[5] = std::max(std::max(std::max(element[0][2], element[1][2]), element[2][2]), element[3][2]); //max z
-  }
+	// min and max of each coordinate over the vertices of the element
+	for(int j = 0; j < NDIMP; ++j) {
+		x_[j] = element[0][j];
+		x_[j+NDIMP] = element[0][j];
+		for(UInt v = 1; v < Element<NNODES,NDIME,NDIMPP>::numVertices; ++v) {
+			x_[j] = std::min(x_[j], element[v][j]);
+			x_[j+NDIMP] = std::max(x_[j+NDIMP], element[v][j]);
+		}
+	}
 }
 
 
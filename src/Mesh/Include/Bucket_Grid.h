@@ -0,0 +1,59 @@
+#ifndef __BUCKET_GRID_H__
+#define __BUCKET_GRID_H__
+
+#include "../../FdaPDE.h"
+#include "Mesh_Objects.h"
+
+/**	\class BucketGrid
+ * 	\brief Uniform grid of buckets over the bounding box of a mesh, for point location.
+ *	\param Shape: template parameter, the element of the mesh (Element<NNODES,mydim,ndim>)
+ *
+ *	Every bucket lists the elements whose bounding box overlaps it, so that the element
+ *	containing a point is among the ones listed in the bucket of the point. The lists are
+ *	stored contiguously (compressed row storage). The bucket size is chosen from the mean
+ *	size of the elements, so that a bucket holds a few elements on quasi-uniform meshes.
+ */
+template<class Shape>
+class BucketGrid {
+public:
+	/// Default constructor, an empty grid (no bucket, every search fails).
+	BucketGrid(): lower_{{0., 0., 0.}}, upper_{{0., 0., 0.}}, scale_{{0., 0., 0.}}, nbuckets_{{0, 0, 0}}, start_(1, 0) {};
+
+	/** It fills the buckets with the elements of the mesh.
+	 * 	Points and elements are stored as in MeshHandler: by columns in 2D, by rows in 2.5D and 3D,
+	 * 	with nnodes nodes per element (the vertices first).
+	 */
+	BucketGrid(Real const * const points, UInt const * const elements, UInt num_nodes, UInt num_elements, UInt nnodes);
+
+	/** Gets the elements listed in the bucket of a point.
+	 *
+	 * 	\param[in] point The point to be located.
+	 *	\param[out] begin, end The range of the ids of the elements whose bounding box overlaps the bucket;
+	 *	it is empty if the point is out of the grid.
+	 */
+	void candidates(Point const & point, UInt const * & begin, UInt const * & end) const;
+
+	/// Returns the number of buckets.
+	inline UInt size() const { return start_.size()-1; }
+	/// Returns the memory, in bytes, used by the buckets.
+	inline std::size_t memory() const { return (start_.capacity()+elements_.capacity())*sizeof(UInt); }
+
+private:
+	/// Returns the index of the bucket along direction k of a coordinate, clamped to the grid.
+	inline UInt bucket(Real x, int k) const;
+
+	/// Lower and upper corners of the grid, inverse of the bucket size along each direction.
+	std::array<Real, 3> lower_;
+	std::array<Real, 3> upper_;
+	std::array<Real, 3> scale_;
+	/// Number of buckets along each direction.
+	std::array<UInt, 3> nbuckets_;
+	/// Position in elements_ of the first element of each bucket (size()+1 values).
+	std::vector<UInt> start_;
+	/// Ids of the elements listed in the buckets, bucket after bucket.
+	std::vector<UInt> elements_;
+};
+
+#include "Bucket_Grid_imp.h"
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef __BUCKET_GRID_IMP_H__
+#define __BUCKET_GRID_IMP_H__
+
+#include <cmath>
+
+//! Largest number of buckets per element, it bounds the memory of the grid on surface meshes
+constexpr Real BucketGridMaxBuckets = 4.;
+
+template<class Shape>
+BucketGrid<Shape>::BucketGrid(Real const * const points, UInt const * const elements, UInt num_nodes, UInt num_elements, UInt nnodes):
+	lower_{{0., 0., 0.}}, upper_{{0., 0., 0.}}, scale_{{0., 0., 0.}}, nbuckets_{{1, 1, 1}}
+{
+	const int ndim = Shape::dp(); //physical dimension
+	const int nvertex = Shape::numVertices; //vertices of each element (not total number of nodes!)
+
+	if(num_elements == 0)
+	{
+		nbuckets_ = {{0, 0, 0}};
+		start_.assign(1, 0);
+		return;
+	}
+
+	// Bounding box of every element, mean size of the elements and bounding box of the mesh
+	std::vector<Real> boxes(2*ndim*num_elements);
+	Real mean_size = 0.;
+	for(int k = 0; k < ndim; ++k)
+	{
+		lower_[k] = std::numeric_limits<Real>::max();
+		upper_[k] = std::numeric_limits<Real>::lowest();
+	}
+
+	for(UInt i = 0; i < num_elements; ++i)
+	{
+		Real * box = &boxes[2*ndim*i];
+		for(int k = 0; k < ndim; ++k)
+		{
+			for(int j = 0; j < nvertex; ++j)
+			{
+				//points are stored by columns in 2D and by rows in 2.5D and 3D
+				Real coord = (ndim == 2) ? points[elements[j*num_elements + i] + k*num_nodes] :
+				                           points[elements[j + i*nnodes]*ndim + k];
+				box[k] = (j == 0) ? coord : std::min(box[k], coord);
+				box[k+ndim] = (j == 0) ? coord : std::max(box[k+ndim], coord);
+			}
+			mean_size += box[k+ndim]-box[k];
+			lower_[k] = std::min(lower_[k], box[k]);
+			upper_[k] = std::max(upper_[k], box[k+ndim]);
+		}
+	}
+	mean_size /= ndim*num_elements;
+
+	// Bucket size: one bucket per element on a mesh filling its bounding box, never larger than the
+	// mean size of the elements; it is enlarged when the mesh would need more than BucketGridMaxBuckets
+	// buckets per element (a surface in 3D only crosses a few of them)
+	Real volume = 1.;
+	for(int k = 0; k < ndim; ++k)
+		volume *= std::max(upper_[k]-lower_[k], mean_size);
+	Real side = std::min(mean_size, std::pow(volume/num_elements, 1./ndim));
+	Real nbuckets = 1.;
+	for(int k = 0; k < ndim; ++k)
+		nbuckets *= std::max(1., (upper_[k]-lower_[k])/side);
+	if(nbuckets > BucketGridMaxBuckets*num_elements)
+		side *= std::pow(nbuckets/(BucketGridMaxBuckets*num_elements), 1./ndim);
+
+	for(int k = 0; k < ndim; ++k)
+	{
+		Real extent = upper_[k]-lower_[k];
+		nbuckets_[k] = (extent > 0. && side > 0.) ? std::max(1, static_cast<UInt>(std::ceil(extent/side))) : 1;
+		scale_[k] = (extent > 0.) ? nbuckets_[k]/extent : 0.;
+	}
+
+	// Compressed row storage of the lists: count, prefix sum, fill
+	start_.assign(nbuckets_[0]*nbuckets_[1]*nbuckets_[2]+1, 0);
+
+	for(int pass = 0; pass < 2; ++pass)
+	{
+		if(pass == 1)
+		{
+			for(UInt b = 1; b < start_.size(); ++b)
+				start_[b] += start_[b-1];
+			elements_.resize(start_.back());
+		}
+
+		for(UInt i = 0; i < num_elements; ++i)
+		{
+			const Real * box = &boxes[2*ndim*i];
+			UInt first[3] = {0, 0, 0}, last[3] = {0, 0, 0};
+			for(int k = 0; k < ndim; ++k)
+			{
+				first[k] = bucket(box[k], k);
+				last[k] = bucket(box[k+ndim], k);
+			}
+
+			for(UInt l = first[2]; l <= last[2]; ++l)
+				for(UInt j = first[1]; j <= last[1]; ++j)
+					for(UInt h = first[0]; h <= last[0]; ++h)
+					{
+						UInt b = (l*nbuckets_[1] + j)*nbuckets_[0] + h;
+						if(pass == 0)
+							++start_[b+1];
+						else
+							elements_[start_[b]++] = i;
+					}
+		}
+	}
+
+	// The fill moved every start_ to the beginning of the next bucket, shift them back
+	for(UInt b = start_.size()-1; b > 0; --b)
+		start_[b] = start_[b-1];
+	start_[0] = 0;
+}
+
+template<class Shape>
+inline UInt BucketGrid<Shape>::bucket(Real x, int k) const
+{
+	UInt b = static_cast<UInt>((x-lower_[k])*scale_[k]);
+	return std::min(std::max(b, 0), nbuckets_[k]-1);
+}
+
+template<class Shape>
+void BucketGrid<Shape>::candidates(Point const & point, UInt const * & begin, UInt const * & end) const
+{
+	begin = end = elements_.data();
+	if(size() == 0)
+		return;
+
+	UInt b[3] = {0, 0, 0};
+	for(int k = 0; k < Shape::dp(); ++k)
+	{
+		if(point[k] < lower_[k] || point[k] > upper_[k])
+			return;
+		b[k] = bucket(point[k], k);
+	}
+
+	UInt id = (b[2]*nbuckets_[1] + b[1])*nbuckets_[0] + b[0];
+	begin = elements_.data() + start_[id];
+	end = elements_.data() + start_[id+1];
+}
+
+#endif
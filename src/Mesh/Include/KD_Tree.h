@@ -0,0 +1,53 @@
+#ifndef __KD_TREE_H__
+#define __KD_TREE_H__
+
+#include "../../FdaPDE.h"
+#include "Mesh_Objects.h"
+
+/**	\class KDTree
+ * 	\brief Balanced k-d tree over a set of points, for nearest point queries.
+ *	\param NDIM: template parameter, the dimension of the space
+ *
+ *	The tree is implicit: the points are sorted so that the median of every range [first, last)
+ *	is the node splitting it, along the direction of largest extent of the range. The
+ *	coordinates are copied in this order, so that a query reads them contiguously.
+ */
+template<int NDIM>
+class KDTree {
+public:
+	/// Default constructor, an empty tree.
+	KDTree() = default;
+
+	/** It sorts the points in the tree.
+	 * 	\param[in] points The coordinates, NDIM consecutive values per point.
+	 * 	\param[in] num_points The number of points, their ids are their positions in points.
+	 */
+	KDTree(Real const * points, UInt num_points);
+
+	/** Returns the id of the point nearest to a given one, Identifier::NVAL if the tree is empty.
+	 *	Among points at the same distance the one with the smallest id is returned, as a linear scan would do.
+	 */
+	UInt nearest(Point const & point) const;
+
+	/// Returns the number of points.
+	inline UInt size() const { return ids_.size(); }
+
+private:
+	/// Sorts the range [first, last) of the ids, points holds the coordinates in the original order.
+	void build(Real const * points, UInt first, UInt last);
+	/// Searches the range [first, last), updating the nearest point found so far.
+	void nearest(UInt first, UInt last, Real const * point, UInt & best, Real & best_distance) const;
+	/// Distance between a point and the point in position i of the tree.
+	inline Real distance(Real const * point, UInt i) const;
+
+	/// Coordinates of the points, in tree order.
+	std::vector<Real> coords_;
+	/// Ids of the points, in tree order.
+	std::vector<UInt> ids_;
+	/// Split direction of the node in each position.
+	std::vector<unsigned char> dims_;
+};
+
+#include "KD_Tree_imp.h"
+
+#endif
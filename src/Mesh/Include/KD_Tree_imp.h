@@ -0,0 +1,103 @@
+#ifndef __KD_TREE_IMP_H__
+#define __KD_TREE_IMP_H__
+
+#include <algorithm>
+#include <cmath>
+
+template<int NDIM>
+KDTree<NDIM>::KDTree(Real const * points, UInt num_points):
+	coords_(NDIM*num_points), ids_(num_points), dims_(num_points)
+{
+	for(UInt i = 0; i < num_points; ++i)
+		ids_[i] = i;
+	build(points, 0, num_points);
+
+	for(UInt i = 0; i < num_points; ++i)
+		for(int k = 0; k < NDIM; ++k)
+			coords_[NDIM*i+k] = points[NDIM*ids_[i]+k];
+}
+
+template<int NDIM>
+void KDTree<NDIM>::build(Real const * points, UInt first, UInt last)
+{
+	if(last-first < 2)
+		return;
+
+	// Split along the direction of largest extent
+	Real lower[NDIM], upper[NDIM];
+	for(int k = 0; k < NDIM; ++k)
+		lower[k] = upper[k] = points[NDIM*ids_[first]+k];
+	for(UInt i = first+1; i < last; ++i)
+		for(int k = 0; k < NDIM; ++k)
+		{
+			lower[k] = std::min(lower[k], points[NDIM*ids_[i]+k]);
+			upper[k] = std::max(upper[k], points[NDIM*ids_[i]+k]);
+		}
+	int dim = 0;
+	for(int k = 1; k < NDIM; ++k)
+		if(upper[k]-lower[k] > upper[dim]-lower[dim])
+			dim = k;
+
+	UInt middle = first + (last-first)/2;
+	std::nth_element(ids_.begin()+first, ids_.begin()+middle, ids_.begin()+last,
+		[points, dim](UInt a, UInt b) { return points[NDIM*a+dim] < points[NDIM*b+dim]; });
+	dims_[middle] = dim;
+
+	build(points, first, middle);
+	build(points, middle+1, last);
+}
+
+template<int NDIM>
+inline Real KDTree<NDIM>::distance(Real const * point, UInt i) const
+{
+	Real squared = 0.;
+	for(int k = 0; k < NDIM; ++k)
+		squared += (point[k]-coords_[NDIM*i+k])*(point[k]-coords_[NDIM*i+k]);
+	return std::sqrt(squared);
+}
+
+template<int NDIM>
+UInt KDTree<NDIM>::nearest(Point const & point) const
+{
+	Real coords[NDIM];
+	for(int k = 0; k < NDIM; ++k)
+		coords[k] = point[k];
+
+	UInt best = Identifier::NVAL;
+	Real best_distance = std::numeric_limits<Real>::max();
+	nearest(0, size(), coords, best, best_distance);
+	return best;
+}
+
+template<int NDIM>
+void KDTree<NDIM>::nearest(UInt first, UInt last, Real const * point, UInt & best, Real & best_distance) const
+{
+	if(first >= last)
+		return;
+
+	UInt middle = first + (last-first)/2;
+	Real dist = distance(point, middle);
+	if(dist < best_distance || (dist == best_distance && ids_[middle] < best))
+	{
+		best = ids_[middle];
+		best_distance = dist;
+	}
+
+	// Visit first the side of the point, then the other one if it may hold a point as near as the best one
+	// (the slack covers the rounding of the distances, so that ties are resolved as in a linear scan)
+	Real diff = point[dims_[middle]] - coords_[NDIM*middle+dims_[middle]];
+	if(diff < 0)
+	{
+		nearest(first, middle, point, best, best_distance);
+		if(-diff <= best_distance*(1.+1e-12))
+			nearest(middle+1, last, point, best, best_distance);
+	}
+	else
+	{
+		nearest(middle+1, last, point, best, best_distance);
+		if(diff <= best_distance*(1.+1e-12))
+			nearest(first, middle, point, best, best_distance);
+	}
+}
+
+#endif
@@ -9,6 +9,11 @@
 #include "Tree_Node.h"
 #include "Exception_Handling.h"
 #include "AD_Tree.h"
+#include "Spatial_Sort.h"
+#include "Bucket_Grid.h"
+#include "Mesh_Adjacency.h"
+#include "Assembly_Pattern.h"
+#include "Mesh_Image.h"
 #include <math.h>
 
 using std::vector;
@@ -38,7 +43,7 @@ public:
     points_(points), edges_(edges), elements_(triangles), neighbors_(neighbors), num_nodes_(num_nodes), num_edges_(num_edges), num_elements_(num_triangles)
     {
       search_=2;
-      ADTree<Element<3*ORDER,2,2>> tmp(points_, elements_, num_nodes_, num_elements_);
+      ADTree<Element<3*ORDER,2,2>> tmp(points_, elements_, num_nodes_, num_elements_, 3*ORDER);
       tree_ = tmp;
     };
 
@@ -69,7 +74,7 @@ public:
      * \param id an Id argument
       \return The point with the specified id
     */
-    Point getPoint(Id id);
+    Point getPoint(Id id) const;
 
     //! A normal member returning an Edge
     /*!
@@ -108,6 +113,18 @@ public:
     */
     const ADTree<Element<3*ORDER,2,2>> &  getTree() const {return tree_;};
 
+    //! A normal member returning the bucket grid, built for search 4 or by buildGrid
+    const BucketGrid<Element<3*ORDER,2,2>> & getGrid() const {return grid_;};
+
+    //! A normal member returning the incidence and adjacency tables of the mesh, built at the first call (see buildAdjacency)
+    const MeshAdjacency<Element<3*ORDER,2,2>> & getAdjacency() const {buildAdjacency(); return adjacency_;};
+
+    //! A normal member returning the sparsity pattern of the finite element matrices, built at the first call (see buildAssemblyPattern)
+    const AssemblyPattern<Element<3*ORDER,2,2>> & getAssemblyPattern() const {buildAssemblyPattern(); return pattern_;};
+
+    //! A normal member returning the description of the binary image of the mesh (see MeshImage)
+    MeshImage<Element<3*ORDER,2,2>> getImage() const {return MeshImage<Element<3*ORDER,2,2>>(ORDER, points_, num_nodes_, elements_, num_elements_, 3*ORDER, edges_, num_edges_, neighbors_);};
+
     void printPoints(std::ostream & out);
     void printEdges(std::ostream & out);
     void printElements(std::ostream & out);
@@ -140,6 +157,29 @@ public:
     */
     Element<3*ORDER,2,2> findLocationTree(const Point& point) const;
 
+     //! A normal member returning the element on which a point is located
+    /*!
+     * This method looks only at the elements listed in the bucket of the point, the grid
+     * must have been built (search 4 or buildGrid)
+     * \param point the point we want to locate
+      \return The element that contains the point
+    */
+    Element<3*ORDER,2,2> findLocationGrid(const Point& point) const;
+
+     //! A normal member returning the elements on which a batch of points is located
+    /*!
+     * The points are visited along a Morton curve, so that consecutive points usually fall in the
+     * same element or in a close one: each search walks from the element found for the previous point
+     * and falls back to the ADTree, or to the bucket grid for search 4, only when the walk fails
+     * (to the naive search if neither has been built). Chunks of MortonChunkSize consecutive points
+     * of the curve are located in parallel
+     * \param points the points we want to locate
+     * \param redundancy if false and neither has been built, the points the walk cannot reach are
+     * not searched any further (as for the walking search)
+      \return The ids of the elements that contain the points, Identifier::NVAL for the points outside the mesh
+    */
+    std::vector<Id> findLocationBatch(const std::vector<Point>& points, bool redundancy=true) const;
+
     //! A normal member returning the area of an Element
     /*!
      * \param id an Id argument
@@ -148,6 +188,40 @@ public:
     Real elementMeasure(Id id) const;
   UInt getSearch() const {return search_;};
 
+    //! A member building the table of the geometric properties of the elements
+    /*!
+     * The Jacobian, its inverse, the metric and the determinant of every element are computed once
+     * and stored contiguously (geometrySize() values per element); from then on getElement reads them
+     * from the table instead of calling computeProperties() again. It does nothing if the table is
+     * already built or if the cache has been disabled (see setGeometryCache).
+    */
+    void buildGeometryCache() const;
+
+    //! A member filling the bucket grid used by findLocationGrid, it does nothing if the grid is already built
+    void buildGrid() const;
+
+    //! A member building the incidence and adjacency tables of the mesh (see MeshAdjacency)
+    /*!
+     * It does nothing if the tables are already built. The tables are built at the first call of
+     * getAdjacency, a parallel region using them must build them before starting.
+    */
+    void buildAdjacency() const;
+
+    //! A member building the sparsity pattern of the finite element matrices and the map from the local matrices to it (see AssemblyPattern)
+    /*!
+     * It does nothing if the pattern is already built; it builds the adjacency tables if needed.
+    */
+    void buildAssemblyPattern() const;
+
+    //! A member enabling or disabling the geometry table, disabling it also frees its memory
+    void setGeometryCache(bool enable);
+
+    //! A normal member returning true if the geometry table has been built
+    bool hasGeometryCache() const {return !geometry_.empty();}
+
+    //! A normal member returning the memory, in bytes, used by the geometry table
+    std::size_t geometryCacheMemory() const {return geometry_.capacity()*sizeof(Real);}
+
 private:
   SEXP mesh_;
   Real *points_;
@@ -159,6 +233,11 @@ private:
   UInt num_nodes_, num_edges_, num_elements_;
   UInt search_;
   ADTree<Element<3*ORDER,2,2>> tree_; // adtree associated to the mesh
+  mutable BucketGrid<Element<3*ORDER,2,2>> grid_; //bucket grid associated to the mesh, built for search 4 or by buildGrid
+  bool geometry_cache_ = true; //false to never build the geometry table
+  mutable std::vector<Real> geometry_; //geometry table, built by buildGeometryCache
+  mutable MeshAdjacency<Element<3*ORDER,2,2>> adjacency_; //incidence and adjacency tables, built by buildAdjacency
+  mutable AssemblyPattern<Element<3*ORDER,2,2>> pattern_; //sparsity pattern of the finite element matrices, built by buildAssemblyPattern
 
 };
 
@@ -177,7 +256,7 @@ public:
     MeshHandler(Real* points, UInt* triangles, UInt num_nodes, UInt num_triangles):
       points_(points), elements_(triangles), num_nodes_(num_nodes), num_elements_(num_triangles) {
         search_=2;
-        ADTree<Element<3*ORDER,2,3>> tmp(points_, elements_, num_nodes_, num_elements_);
+        ADTree<Element<3*ORDER,2,3>> tmp(points_, elements_, num_nodes_, num_elements_, 3*ORDER);
         tree_ = tmp;
       };
 
@@ -221,7 +300,7 @@ public:
      * \param id an Id argument
       \return The point with the specified id
     */
-    Point getPoint(Id id);
+    Point getPoint(Id id) const;
 
     //! A normal member returning an Element
     /*!
@@ -236,6 +315,18 @@ public:
     */
     const ADTree<Element<3*ORDER,2,3>> &  getTree() const {return tree_;};
 
+    //! A normal member returning the bucket grid, built for search 4 or by buildGrid
+    const BucketGrid<Element<3*ORDER,2,3>> & getGrid() const {return grid_;};
+
+    //! A normal member returning the incidence and adjacency tables of the mesh, built at the first call (see buildAdjacency)
+    const MeshAdjacency<Element<3*ORDER,2,3>> & getAdjacency() const {buildAdjacency(); return adjacency_;};
+
+    //! A normal member returning the sparsity pattern of the finite element matrices, built at the first call (see buildAssemblyPattern)
+    const AssemblyPattern<Element<3*ORDER,2,3>> & getAssemblyPattern() const {buildAssemblyPattern(); return pattern_;};
+
+    //! A normal member returning the description of the binary image of the mesh (see MeshImage)
+    MeshImage<Element<3*ORDER,2,3>> getImage() const {return MeshImage<Element<3*ORDER,2,3>>(ORDER, points_, num_nodes_, elements_, num_elements_, 3*ORDER);};
+
     void printPoints(std::ostream & out);
     void printElements(std::ostream & out);
 
@@ -248,6 +339,25 @@ public:
     */
     Element<3*ORDER,2,3> findLocationNaive(Point point) const;
 
+     //! A normal member returning the Neighbors of a element
+    /*!
+     * \param id the id of the element
+     * \param number the number of the vertex
+      \return The element that has as a edge the one opposite to the specified
+      vertex, read from the adjacency tables (see getAdjacency)
+    */
+    Element<3*ORDER,2,3> getNeighbors(Id id_element, UInt number) const;
+
+     //! A normal member returning the element on which a point is located
+    /*!
+     * This method implements a Visibility Walk Algorithm (further details in: Walking in a triangulation, Devillers et al)
+     * across the neighbors of the adjacency tables
+     * \param point the point we want to locate
+     * \param starting_element Element that specifies the poposed starting points for the walking algorithm
+      \return The element that contains the point
+    */
+    Element<3*ORDER,2,3> findLocationWalking(const Point& point, const Element<3*ORDER,2,3>& starting_element) const;
+
      //! A normal member returning the triangle on which a point is located
     /*!
      * This method implements a ADTree algorithm
@@ -256,6 +366,29 @@ public:
     */
     Element<3*ORDER,2,3> findLocationTree(const Point& point) const;
 
+     //! A normal member returning the element on which a point is located
+    /*!
+     * This method looks only at the elements listed in the bucket of the point, the grid
+     * must have been built (search 4 or buildGrid)
+     * \param point the point we want to locate
+      \return The element that contains the point
+    */
+    Element<3*ORDER,2,3> findLocationGrid(const Point& point) const;
+
+     //! A normal member returning the elements on which a batch of points is located
+    /*!
+     * The points are visited along a Morton curve, so that consecutive points usually fall in the
+     * same element or in a close one: each search walks from the element found for the previous point
+     * and falls back to the ADTree, or to the bucket grid for search 4, only when the walk fails
+     * (to the naive search if neither has been built). Chunks of MortonChunkSize consecutive points
+     * of the curve are located in parallel
+     * \param points the points we want to locate
+     * \param redundancy if false and neither has been built, the points the walk cannot reach are
+     * not searched any further (as for the walking search)
+      \return The ids of the elements that contain the points, Identifier::NVAL for the points outside the mesh
+    */
+    std::vector<Id> findLocationBatch(const std::vector<Point>& points, bool redundancy=true) const;
+
     //! A normal member returning the area of an Element
     /*!
      * \param id an Id argument
@@ -264,6 +397,40 @@ public:
     Real elementMeasure(Id id) const;
   UInt getSearch() const {return search_;};
 
+    //! A member building the table of the geometric properties of the elements
+    /*!
+     * The Jacobian, its inverse, the metric and the determinant of every element are computed once
+     * and stored contiguously (geometrySize() values per element); from then on getElement reads them
+     * from the table instead of calling computeProperties() again. It does nothing if the table is
+     * already built or if the cache has been disabled (see setGeometryCache).
+    */
+    void buildGeometryCache() const;
+
+    //! A member filling the bucket grid used by findLocationGrid, it does nothing if the grid is already built
+    void buildGrid() const;
+
+    //! A member building the incidence and adjacency tables of the mesh (see MeshAdjacency)
+    /*!
+     * It does nothing if the tables are already built. The tables are built at the first call of
+     * getAdjacency, a parallel region using them must build them before starting.
+    */
+    void buildAdjacency() const;
+
+    //! A member building the sparsity pattern of the finite element matrices and the map from the local matrices to it (see AssemblyPattern)
+    /*!
+     * It does nothing if the pattern is already built; it builds the adjacency tables if needed.
+    */
+    void buildAssemblyPattern() const;
+
+    //! A member enabling or disabling the geometry table, disabling it also frees its memory
+    void setGeometryCache(bool enable);
+
+    //! A normal member returning true if the geometry table has been built
+    bool hasGeometryCache() const {return !geometry_.empty();}
+
+    //! A normal member returning the memory, in bytes, used by the geometry table
+    std::size_t geometryCacheMemory() const {return geometry_.capacity()*sizeof(Real);}
+
 
 private:
   SEXP mesh_;
@@ -275,6 +442,11 @@ private:
   UInt num_nodes_, num_elements_;
   UInt search_;
   ADTree<Element<3*ORDER,2,3>> tree_; //adtree associated to the mesh
+  mutable BucketGrid<Element<3*ORDER,2,3>> grid_; //bucket grid associated to the mesh, built for search 4 or by buildGrid
+  bool geometry_cache_ = true; //false to never build the geometry table
+  mutable std::vector<Real> geometry_; //geometry table, built by buildGeometryCache
+  mutable MeshAdjacency<Element<3*ORDER,2,3>> adjacency_; //incidence and adjacency tables, built by buildAdjacency
+  mutable AssemblyPattern<Element<3*ORDER,2,3>> pattern_; //sparsity pattern of the finite element matrices, built by buildAssemblyPattern
 
 };
 
@@ -293,7 +465,7 @@ public:
     MeshHandler(Real* points, UInt* tetrahedrons, UInt num_nodes, UInt num_tetrahedrons):
       points_(points), elements_(tetrahedrons), num_nodes_(num_nodes), num_elements_(num_tetrahedrons) {
         search_=2;
-        ADTree<Element<6*ORDER-2,3,3>> tmp(points_, elements_, num_nodes_, num_elements_);
+        ADTree<Element<6*ORDER-2,3,3>> tmp(points_, elements_, num_nodes_, num_elements_, 6*ORDER-2);
         tree_ = tmp;
        };
 
@@ -322,7 +494,7 @@ public:
      * \param id an Id argument
       \return The point with the specified id
     */
-    Point getPoint(Id id);
+    Point getPoint(Id id) const;
 
     //! A normal member returning an Element
     /*!
@@ -337,6 +509,18 @@ public:
     */
     const ADTree<Element<6*ORDER-2,3,3>> &  getTree() const {return tree_;};
 
+    //! A normal member returning the bucket grid, built for search 4 or by buildGrid
+    const BucketGrid<Element<6*ORDER-2,3,3>> & getGrid() const {return grid_;};
+
+    //! A normal member returning the incidence and adjacency tables of the mesh, built at the first call (see buildAdjacency)
+    const MeshAdjacency<Element<6*ORDER-2,3,3>> & getAdjacency() const {buildAdjacency(); return adjacency_;};
+
+    //! A normal member returning the sparsity pattern of the finite element matrices, built at the first call (see buildAssemblyPattern)
+    const AssemblyPattern<Element<6*ORDER-2,3,3>> & getAssemblyPattern() const {buildAssemblyPattern(); return pattern_;};
+
+    //! A normal member returning the description of the binary image of the mesh (see MeshImage)
+    MeshImage<Element<6*ORDER-2,3,3>> getImage() const {return MeshImage<Element<6*ORDER-2,3,3>>(ORDER, points_, num_nodes_, elements_, num_elements_, 6*ORDER-2);};
+
     void printPoints(std::ostream & out);
     void printElements(std::ostream & out);
 
@@ -349,6 +533,25 @@ public:
     */
     Element<6*ORDER-2,3,3> findLocationNaive(Point point) const;
 
+     //! A normal member returning the Neighbors of a element
+    /*!
+     * \param id the id of the element
+     * \param number the number of the vertex
+      \return The element that has as a face the one opposite to the specified
+      vertex, read from the adjacency tables (see getAdjacency)
+    */
+    Element<6*ORDER-2,3,3> getNeighbors(Id id_element, UInt number) const;
+
+     //! A normal member returning the element on which a point is located
+    /*!
+     * This method implements a Visibility Walk Algorithm (further details in: Walking in a triangulation, Devillers et al)
+     * across the neighbors of the adjacency tables
+     * \param point the point we want to locate
+     * \param starting_element Element that specifies the poposed starting points for the walking algorithm
+      \return The element that contains the point
+    */
+    Element<6*ORDER-2,3,3> findLocationWalking(const Point& point, const Element<6*ORDER-2,3,3>& starting_element) const;
+
   //! A normal member returning the triangle on which a point is located
     /*!
      * This method implements a ADTree algorithm
@@ -357,6 +560,29 @@ public:
     */
     Element<6*ORDER-2,3,3> findLocationTree(const Point& point) const;
 
+     //! A normal member returning the element on which a point is located
+    /*!
+     * This method looks only at the elements listed in the bucket of the point, the grid
+     * must have been built (search 4 or buildGrid)
+     * \param point the point we want to locate
+      \return The element that contains the point
+    */
+    Element<6*ORDER-2,3,3> findLocationGrid(const Point& point) const;
+
+     //! A normal member returning the elements on which a batch of points is located
+    /*!
+     * The points are visited along a Morton curve, so that consecutive points usually fall in the
+     * same element or in a close one: each search walks from the element found for the previous point
+     * and falls back to the ADTree, or to the bucket grid for search 4, only when the walk fails
+     * (to the naive search if neither has been built). Chunks of MortonChunkSize consecutive points
+     * of the curve are located in parallel
+     * \param points the points we want to locate
+     * \param redundancy if false and neither has been built, the points the walk cannot reach are
+     * not searched any further (as for the walking search)
+      \return The ids of the elements that contain the points, Identifier::NVAL for the points outside the mesh
+    */
+    std::vector<Id> findLocationBatch(const std::vector<Point>& points, bool redundancy=true) const;
+
     //! A normal member returning the volume of an Element
     /*!
      * \param id an Id argument
@@ -365,6 +591,40 @@ public:
     Real elementMeasure(Id id) const;
   UInt getSearch() const {return search_;};
 
+    //! A member building the table of the geometric properties of the elements
+    /*!
+     * The Jacobian, its inverse, the metric and the determinant of every element are computed once
+     * and stored contiguously (geometrySize() values per element); from then on getElement reads them
+     * from the table instead of calling computeProperties() again. It does nothing if the table is
+     * already built or if the cache has been disabled (see setGeometryCache).
+    */
+    void buildGeometryCache() const;
+
+    //! A member filling the bucket grid used by findLocationGrid, it does nothing if the grid is already built
+    void buildGrid() const;
+
+    //! A member building the incidence and adjacency tables of the mesh (see MeshAdjacency)
+    /*!
+     * It does nothing if the tables are already built. The tables are built at the first call of
+     * getAdjacency, a parallel region using them must build them before starting.
+    */
+    void buildAdjacency() const;
+
+    //! A member building the sparsity pattern of the finite element matrices and the map from the local matrices to it (see AssemblyPattern)
+    /*!
+     * It does nothing if the pattern is already built; it builds the adjacency tables if needed.
+    */
+    void buildAssemblyPattern() const;
+
+    //! A member enabling or disabling the geometry table, disabling it also frees its memory
+    void setGeometryCache(bool enable);
+
+    //! A normal member returning true if the geometry table has been built
+    bool hasGeometryCache() const {return !geometry_.empty();}
+
+    //! A normal member returning the memory, in bytes, used by the geometry table
+    std::size_t geometryCacheMemory() const {return geometry_.capacity()*sizeof(Real);}
+
 
 private:
   SEXP mesh_;
@@ -375,6 +635,11 @@ private:
   UInt num_nodes_, num_elements_;
   UInt search_;
   ADTree<Element<6*ORDER-2,3,3>> tree_; //adtree associated to the mesh
+  mutable BucketGrid<Element<6*ORDER-2,3,3>> grid_; //bucket grid associated to the mesh, built for search 4 or by buildGrid
+  bool geometry_cache_ = true; //false to never build the geometry table
+  mutable std::vector<Real> geometry_; //geometry table, built by buildGeometryCache
+  mutable MeshAdjacency<Element<6*ORDER-2,3,3>> adjacency_; //incidence and adjacency tables, built by buildAdjacency
+  mutable AssemblyPattern<Element<6*ORDER-2,3,3>> pattern_; //sparsity pattern of the finite element matrices, built by buildAssemblyPattern
 };
 
 
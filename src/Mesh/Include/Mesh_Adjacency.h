@@ -0,0 +1,69 @@
+#ifndef __MESH_ADJACENCY_H__
+#define __MESH_ADJACENCY_H__
+
+#include "../../FdaPDE.h"
+#include "Mesh_Objects.h"
+
+/**	\class MeshAdjacency
+ * 	\brief Incidence and adjacency tables of a mesh, in compressed row storage.
+ *	\param Shape: template parameter, the element of the mesh (Element<NNODES,mydim,ndim>)
+ *
+ *	For every node: the elements it belongs to and the nodes sharing an element with it (every
+ *	node of the element, the higher order ones included), both in ascending order. For every
+ *	element: the neighbor across each face, the "number" neighbor being opposite the "number"
+ *	vertex, as the neighbors of the 2D meshes built by Triangle.
+ */
+template<class Shape>
+class MeshAdjacency {
+public:
+	/// Default constructor, the tables of an empty mesh.
+	MeshAdjacency(): node_elements_start_(1, 0), node_nodes_start_(1, 0) {};
+
+	/** It builds the tables.
+	 * 	Elements are stored as in MeshHandler: by columns in 2D, by rows in 2.5D and 3D.
+	 *	\param[in] nnodes The number of nodes of each element.
+	 */
+	MeshAdjacency(UInt const * const elements, UInt num_nodes, UInt num_elements, UInt nnodes);
+
+	/// Gets the range of the ids of the elements a node belongs to.
+	inline void nodeElements(UInt node, UInt const * & begin, UInt const * & end) const
+	{
+		begin = node_elements_.data() + node_elements_start_[node];
+		end = node_elements_.data() + node_elements_start_[node+1];
+	}
+
+	/// Gets the range of the ids of the nodes sharing an element with a node (the node excluded).
+	inline void nodeNodes(UInt node, UInt const * & begin, UInt const * & end) const
+	{
+		begin = node_nodes_.data() + node_nodes_start_[node];
+		end = node_nodes_.data() + node_nodes_start_[node+1];
+	}
+
+	/// Returns the id of the element across the face opposite to a vertex, Identifier::NVAL on the border.
+	inline Id elementNeighbor(UInt element, UInt number) const { return element_elements_[element*Shape::numVertices + number]; }
+
+	/// Returns the number of nodes, 0 if the tables have not been built.
+	inline UInt numNodes() const { return node_elements_start_.size()-1; }
+	/// Returns the memory, in bytes, used by the tables.
+	inline std::size_t memory() const
+	{
+		return (node_elements_start_.capacity()+node_elements_.capacity()+node_nodes_start_.capacity()+
+			node_nodes_.capacity()+element_elements_.capacity())*sizeof(UInt);
+	}
+
+private:
+	/// Position in node_elements_ of the first element of each node (numNodes()+1 values).
+	std::vector<UInt> node_elements_start_;
+	/// Ids of the elements of the nodes, node after node.
+	std::vector<UInt> node_elements_;
+	/// Position in node_nodes_ of the first neighbor of each node (numNodes()+1 values).
+	std::vector<UInt> node_nodes_start_;
+	/// Ids of the neighbors of the nodes, node after node.
+	std::vector<UInt> node_nodes_;
+	/// Neighbors of the elements, Shape::numVertices per element.
+	std::vector<Id> element_elements_;
+};
+
+#include "Mesh_Adjacency_imp.h"
+
+#endif
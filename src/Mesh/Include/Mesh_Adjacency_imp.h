@@ -0,0 +1,89 @@
+#ifndef __MESH_ADJACENCY_IMP_H__
+#define __MESH_ADJACENCY_IMP_H__
+
+#include <algorithm>
+
+template<class Shape>
+MeshAdjacency<Shape>::MeshAdjacency(UInt const * const elements, UInt num_nodes, UInt num_elements, UInt nnodes)
+{
+	const int nvertex = Shape::numVertices; //vertices of each element (not total number of nodes!)
+	//elements are stored by columns in 2D and by rows in 2.5D and 3D
+	auto node = [&](UInt element, UInt i) {
+		return (Shape::dp() == 2) ? elements[i*num_elements + element] : elements[element*nnodes + i];
+	};
+
+	// Node -> elements: count, prefix sum, fill (elements visited in ascending order)
+	node_elements_start_.assign(num_nodes+1, 0);
+	for(UInt e = 0; e < num_elements; ++e)
+		for(UInt i = 0; i < nnodes; ++i)
+			++node_elements_start_[node(e, i)+1];
+	for(UInt n = 0; n < num_nodes; ++n)
+		node_elements_start_[n+1] += node_elements_start_[n];
+
+	node_elements_.resize(node_elements_start_.back());
+	std::vector<UInt> next(node_elements_start_.begin(), node_elements_start_.end()-1);
+	for(UInt e = 0; e < num_elements; ++e)
+		for(UInt i = 0; i < nnodes; ++i)
+			node_elements_[next[node(e, i)]++] = e;
+
+	// Node -> nodes: the nodes of the elements of each node, without repetitions
+	std::vector<UInt> seen(num_nodes, Identifier::NVAL); //last node whose list includes each node
+	node_nodes_start_.assign(num_nodes+1, 0);
+	node_nodes_.reserve(node_elements_.size()*(nnodes-1)/2);
+	for(UInt n = 0; n < num_nodes; ++n)
+	{
+		seen[n] = n;
+		for(UInt k = node_elements_start_[n]; k < node_elements_start_[n+1]; ++k)
+			for(UInt i = 0; i < nnodes; ++i)
+			{
+				UInt m = node(node_elements_[k], i);
+				if(seen[m] != n)
+				{
+					seen[m] = n;
+					node_nodes_.push_back(m);
+				}
+			}
+		std::sort(node_nodes_.begin() + node_nodes_start_[n], node_nodes_.end());
+		node_nodes_start_[n+1] = node_nodes_.size();
+	}
+
+	// Element -> elements: the neighbor opposite to vertex i is the other element containing all
+	// the vertices of the face, it is searched among the elements of one of them
+	element_elements_.assign(num_elements*nvertex, Identifier::NVAL);
+	for(UInt e = 0; e < num_elements; ++e)
+		for(int i = 0; i < nvertex; ++i)
+		{
+			if(element_elements_[e*nvertex + i] != Identifier::NVAL)
+				continue; //already set from the other side
+			const UInt first = node(e, (i+1) % nvertex);
+
+			for(UInt k = node_elements_start_[first]; k < node_elements_start_[first+1]; ++k)
+			{
+				const UInt f = node_elements_[k];
+				if(f == e)
+					continue;
+
+				// Vertex of f not on the face, if f contains the whole face
+				int opposite = -1, shared = 0;
+				for(int j = 0; j < nvertex; ++j)
+				{
+					const UInt v = node(f, j);
+					bool on_face = false;
+					for(int h = 1; h < nvertex; ++h)
+						on_face = on_face || v == node(e, (i+h) % nvertex);
+					if(on_face)
+						++shared;
+					else
+						opposite = j;
+				}
+				if(shared == nvertex-1)
+				{
+					element_elements_[e*nvertex + i] = f;
+					element_elements_[f*nvertex + opposite] = e;
+					break;
+				}
+			}
+		}
+}
+
+#endif
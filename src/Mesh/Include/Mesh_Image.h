@@ -0,0 +1,112 @@
+#ifndef __MESH_IMAGE_H__
+#define __MESH_IMAGE_H__
+
+#include "../../FdaPDE.h"
+#include "AD_Tree.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+/// Version of the binary image of a mesh, to be increased at every change of its layout.
+constexpr std::uint32_t MeshImageVersion = 1;
+
+/**	\struct MeshImageHeader
+ * 	\brief First bytes of the binary image of a mesh and of its ADTree.
+ *
+ *	The header is followed by the sections it points to (offsets in bytes from the beginning of
+ *	the image, multiples of 8): the nodes of the mesh, its elements, the edges and the neighbors
+ *	for 2D meshes, then the tree nodes (head first). Nodes and elements are stored as in
+ *	MeshHandler. The tree nodes are stored as they are in memory, so that the tree can be read in
+ *	place: an image written by a build with a different byte order or node layout is rejected.
+ */
+struct MeshImageHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byte_order; //MeshImageByteOrder as written by the machine that built the image
+	std::uint32_t order, mydim, ndim;
+	std::uint32_t tree_node_size; //sizeof(TreeNode<Shape>)
+	std::int32_t num_nodes, num_elements, num_edges;
+	std::int32_t tree_lev, tree_nodes, unused;
+	Real origin[ADTreeMaxDimt];
+	Real scale[ADTreeMaxDimt];
+	std::uint64_t points, elements, edges, neighbors, tree, size;
+};
+
+/** \class MappedFile
+ *	\brief Read-only view of a whole file, mapped in memory (read in a buffer where mapping is not available).
+ */
+class MappedFile {
+public:
+	/// Opens and maps the file, good() is false if it fails.
+	explicit MappedFile(const char * path);
+	~MappedFile();
+	MappedFile(const MappedFile &) = delete;
+	MappedFile & operator=(const MappedFile &) = delete;
+
+	inline bool good() const { return data_ != nullptr; }
+	inline const char * data() const { return data_; }
+	inline std::size_t size() const { return size_; }
+
+private:
+	const char * data_ = nullptr;
+	std::size_t size_ = 0;
+	bool mapped_ = false;
+	std::vector<char> buffer_;
+};
+
+//! Returns the image attached to an R mesh (its last element, named tree_image), R_NilValue if there is none.
+SEXP meshImageElement(SEXP mesh);
+
+/**	\class MeshImage
+ * 	\brief Writes and reads the binary image of a mesh and of its ADTree (see MeshImageHeader).
+ *	\param Shape: template parameter, the element of the mesh (Element<NNODES,mydim,ndim>)
+ *
+ *	An image is written once (it is returned to R as a raw vector, which can be saved to a file)
+ *	and read by every MeshHandler built on the same mesh: the tree nodes are used where they lie,
+ *	in the raw vector or in the mapped file, instead of being rebuilt or copied.
+ */
+template<class Shape>
+class MeshImage {
+public:
+	/** Describes the mesh, whose arrays are stored as in MeshHandler.
+	 *	nnodes is the number of nodes of each element; edges and neighbors are given for 2D meshes only.
+	 */
+	MeshImage(UInt order, Real const * points, UInt num_nodes, UInt const * elements, UInt num_elements, UInt nnodes,
+		UInt const * edges = nullptr, UInt num_edges = 0, UInt const * neighbors = nullptr);
+
+	/// Returns the size in bytes of the image of the mesh with the given tree.
+	std::size_t size(ADTree<Shape> const & tree) const;
+
+	/// Writes the image of the mesh with the given tree, image has room for size(tree) bytes.
+	void write(ADTree<Shape> const & tree, char * image) const;
+
+	/** Reads the tree from an image, after checking that the image belongs to this mesh.
+	 *
+	 *	\param[in] image, size The image, aligned to 8 bytes.
+	 *	\param[in] storage Keeps the image alive as long as the tree uses it.
+	 *	\param[out] tree The tree, its nodes are not copied.
+	 *	\return false, leaving the tree untouched, if the image is not valid for this mesh.
+	 */
+	bool read(const char * image, std::size_t size, std::shared_ptr<const void> storage, ADTree<Shape> & tree) const;
+
+	/// Reads the tree from the image attached to an R mesh: a raw vector or the name of a file, which is mapped.
+	bool read(SEXP Rimage, ADTree<Shape> & tree) const;
+
+private:
+	/// Fills the header, except for the tree.
+	MeshImageHeader header() const;
+
+	UInt order_;
+	Real const * points_;
+	UInt num_nodes_;
+	UInt const * elements_;
+	UInt num_elements_;
+	UInt nnodes_;
+	UInt const * edges_;
+	UInt num_edges_;
+	UInt const * neighbors_;
+};
+
+#include "Mesh_Image_imp.h"
+
+#endif
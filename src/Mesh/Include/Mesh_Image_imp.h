@@ -0,0 +1,121 @@
+#ifndef __MESH_IMAGE_IMP_H__
+#define __MESH_IMAGE_IMP_H__
+
+//! Magic string at the beginning of every image
+constexpr char MeshImageMagic[8] = {'F', 'D', 'A', 'P', 'D', 'E', 'M', 'I'};
+//! Written as it is in memory, it tells the byte order of the machine that built the image
+constexpr std::uint32_t MeshImageByteOrder = 0x01020304;
+
+//! Rounds a size in bytes up to a multiple of 8, so that every section is aligned
+inline std::uint64_t meshImageAlign(std::uint64_t bytes) { return (bytes+7) & ~std::uint64_t(7); }
+
+template<class Shape>
+MeshImage<Shape>::MeshImage(UInt order, Real const * points, UInt num_nodes, UInt const * elements, UInt num_elements, UInt nnodes,
+	UInt const * edges, UInt num_edges, UInt const * neighbors):
+	order_(order), points_(points), num_nodes_(num_nodes), elements_(elements), num_elements_(num_elements), nnodes_(nnodes),
+	edges_(edges), num_edges_(edges ? num_edges : 0), neighbors_(neighbors) {}
+
+template<class Shape>
+MeshImageHeader MeshImage<Shape>::header() const
+{
+	MeshImageHeader h;
+	std::memset(&h, 0, sizeof(h));
+	std::memcpy(h.magic, MeshImageMagic, sizeof(h.magic));
+	h.version = MeshImageVersion;
+	h.byte_order = MeshImageByteOrder;
+	h.order = order_;
+	h.mydim = Shape::numVertices-1;
+	h.ndim = Shape::dp();
+	h.tree_node_size = sizeof(TreeNode<Shape>);
+	h.num_nodes = num_nodes_;
+	h.num_elements = num_elements_;
+	h.num_edges = num_edges_;
+
+	h.points = meshImageAlign(sizeof(MeshImageHeader));
+	h.elements = meshImageAlign(h.points + sizeof(Real)*num_nodes_*Shape::dp());
+	h.edges = meshImageAlign(h.elements + sizeof(UInt)*num_elements_*nnodes_);
+	h.neighbors = meshImageAlign(h.edges + sizeof(UInt)*num_edges_*2);
+	h.tree = meshImageAlign(h.neighbors + (neighbors_ ? sizeof(UInt)*num_elements_*Shape::numVertices : 0));
+	return h;
+}
+
+template<class Shape>
+std::size_t MeshImage<Shape>::size(ADTree<Shape> const & tree) const
+{
+	return header().tree + sizeof(TreeNode<Shape>)*(tree.gettreeheader().getnele()+1);
+}
+
+template<class Shape>
+void MeshImage<Shape>::write(ADTree<Shape> const & tree, char * image) const
+{
+	MeshImageHeader h = header();
+	const TreeHeader<Shape> & tree_header = tree.gettreeheader();
+	h.tree_lev = tree_header.gettreelev();
+	h.tree_nodes = tree_header.getnele()+1;
+	for(int i = 0; i < Shape::dt(); ++i)
+	{
+		h.origin[i] = tree_header.domainorig(i);
+		h.scale[i] = tree_header.domainscal(i);
+	}
+	h.size = size(tree);
+
+	std::memset(image, 0, h.size); //padding included, two images of the same mesh are equal
+	std::memcpy(image, &h, sizeof(h));
+	std::memcpy(image + h.points, points_, sizeof(Real)*num_nodes_*Shape::dp());
+	std::memcpy(image + h.elements, elements_, sizeof(UInt)*num_elements_*nnodes_);
+	if(edges_)
+		std::memcpy(image + h.edges, edges_, sizeof(UInt)*num_edges_*2);
+	if(neighbors_)
+		std::memcpy(image + h.neighbors, neighbors_, sizeof(UInt)*num_elements_*Shape::numVertices);
+	std::memcpy(image + h.tree, tree.nodes(), sizeof(TreeNode<Shape>)*h.tree_nodes);
+}
+
+template<class Shape>
+bool MeshImage<Shape>::read(const char * image, std::size_t size, std::shared_ptr<const void> storage, ADTree<Shape> & tree) const
+{
+	MeshImageHeader expected = header();
+	MeshImageHeader h;
+	if(image == nullptr || size < sizeof(h) || reinterpret_cast<std::uintptr_t>(image) % alignof(TreeNode<Shape>) != 0)
+		return false;
+	std::memcpy(&h, image, sizeof(h));
+
+	// Format and layout of the tree nodes
+	if(std::memcmp(h.magic, MeshImageMagic, sizeof(h.magic)) != 0 || h.version != MeshImageVersion ||
+		h.byte_order != MeshImageByteOrder || h.tree_node_size != expected.tree_node_size)
+		return false;
+
+	// The image must belong to this mesh: same sizes, same nodes and elements
+	if(h.order != expected.order || h.mydim != expected.mydim || h.ndim != expected.ndim ||
+		h.num_nodes != expected.num_nodes || h.num_elements != expected.num_elements || h.num_edges != expected.num_edges ||
+		h.points != expected.points || h.elements != expected.elements || h.tree != expected.tree)
+		return false;
+	if(h.tree_nodes != num_elements_+1 || h.size > size || h.size != h.tree + sizeof(TreeNode<Shape>)*h.tree_nodes)
+		return false;
+	if(std::memcmp(image + h.points, points_, sizeof(Real)*num_nodes_*Shape::dp()) != 0 ||
+		std::memcmp(image + h.elements, elements_, sizeof(UInt)*num_elements_*nnodes_) != 0)
+		return false;
+
+	std::vector<Real> origin(h.origin, h.origin + Shape::dt());
+	std::vector<Real> scale(h.scale, h.scale + Shape::dt());
+	TreeHeader<Shape> tree_header(num_elements_, h.tree_lev, Shape::dp(), Shape::dt(), num_elements_,
+		num_elements_+1, num_elements_+1, Domain<Shape>(origin, scale));
+
+	tree = ADTree<Shape>(tree_header, reinterpret_cast<TreeNode<Shape> const *>(image + h.tree), storage);
+	return true;
+}
+
+template<class Shape>
+bool MeshImage<Shape>::read(SEXP Rimage, ADTree<Shape> & tree) const
+{
+	if(TYPEOF(Rimage) == RAWSXP) //the raw vector lives in the R mesh, as long as the MeshHandler
+		return read(reinterpret_cast<const char *>(RAW(Rimage)), XLENGTH(Rimage), std::shared_ptr<const void>(), tree);
+
+	if(TYPEOF(Rimage) == STRSXP && XLENGTH(Rimage) > 0)
+	{
+		std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(R_ExpandFileName(CHAR(STRING_ELT(Rimage, 0))));
+		return file->good() && read(file->data(), file->size(), file, tree);
+	}
+	return false;
+}
+
+#endif
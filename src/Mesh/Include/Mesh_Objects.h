@@ -3,6 +3,8 @@
 
 
 #include "../../FdaPDE.h"
+#include <array>
+#include <algorithm>
 
 //Accord the NotValid meaning value
 //const UInt NVAL=std::numeric_limits<UInt>::max();
@@ -43,20 +45,16 @@ public:
 	//set as default 3
    //myDim setting is used when calling T::dp() as template (used in domain_imp.h)
 
-	Point(): Identifier(NVAL, NVAL){coord_.resize(3);
-			ndim=3;}
-   	Point(Real x, Real y):Identifier(NVAL, NVAL)
-		{coord_.resize(3);coord_[0]=x; coord_[1]=y; coord_[2]=0;
-			ndim=2;}
-	Point(Real x, Real y, Real z):Identifier(NVAL, NVAL)
-		{coord_.resize(3);coord_[0]=x; coord_[1]=y; coord_[2]=z;
-			ndim=3;}
-	Point(Id id, BcId bcId, Real x, Real y):Identifier(id, bcId)
-		{coord_.resize(3);coord_[0]=x; coord_[1]=y; coord_[2]=0;
-			ndim=2;}
-	Point(Id id, BcId bcId, Real x, Real y, Real z):Identifier(id, bcId)
-		{coord_.resize(3);coord_[0]=x; coord_[1]=y; coord_[2]=z;
-			ndim=3;}
+	Point(): Identifier(NVAL, NVAL), coord_{{0.,0.,0.}}
+			{ndim=3;}
+   	Point(Real x, Real y):Identifier(NVAL, NVAL), coord_{{x,y,0.}}
+		{ndim=2;}
+	Point(Real x, Real y, Real z):Identifier(NVAL, NVAL), coord_{{x,y,z}}
+		{ndim=3;}
+	Point(Id id, BcId bcId, Real x, Real y):Identifier(id, bcId), coord_{{x,y,0.}}
+		{ndim=2;}
+	Point(Id id, BcId bcId, Real x, Real y, Real z):Identifier(id, bcId), coord_{{x,y,z}}
+		{ndim=3;}
 	void print(std::ostream & out) const;
 	Real operator[](UInt i) const {return coord_[i];}
 	// Returns the number of physical space dimension.
@@ -67,7 +65,9 @@ public:
 	inline static int coordsize() { return myDim; }
 
 private:
-	std::vector<Real> coord_;
+	// Fixed size storage: a Point never touches the heap, so that it can be
+	// freely copied inside the Element objects built by MeshHandler::getElement
+	std::array<Real,3> coord_;
 
 };
 
@@ -79,24 +79,21 @@ class Edge: public Identifier{
     static const UInt numSides=1;
     static const UInt myDim=1;
 
-    Edge():Identifier(NVAL, NVAL){points_.resize(2);};
-    Edge(Id id, BcId bcId, const Point& start,const Point& end):Identifier(id, bcId)
-    {points_.resize(2); points_[0] = start; points_[1] = end;}
+    Edge():Identifier(NVAL, NVAL){};
+    Edge(Id id, BcId bcId, const Point& start,const Point& end):Identifier(id, bcId), points_{{start, end}}
+    {}
 
     void print(std::ostream & out) const;
-    Point getFirst() const {return points_[0];}
-    Point getEnd() const {return points_[1];}
+    const Point& getFirst() const {return points_[0];}
+    const Point& getEnd() const {return points_[1];}
 
 
-    Point operator[](UInt i) const {return points_[i];}
+    const Point& operator[](UInt i) const {return points_[i];}
 
  private:
 	// I don't store directly a eigen matrix because of the limitations
 	// of the current problems of alignement (see eigen 3.0 documentation)
-	// It is not very efficient and should be changed asap
-    //std::array<Point, NNODES> points_;
-    std::vector<Point> points_;
-    //std::array<std::reference_wrapper<Point>, NNODES> M_points;
+    std::array<Point, NNODES> points_;
   };
 
 //! This is an abstract template class called Element
@@ -138,22 +135,31 @@ public:
 	static const UInt nDim=2; //ndim is the dimension of the space in which the object is embedded
 
     //! This constructor creates an "empty" Element, with an Id Not Valid
-	Element():Identifier(NVAL){points_.resize(NNODES);}
+	Element():Identifier(NVAL){}
 
-	//! This constructor creates an Element, given its Id and an std array with the three object Point the will define the Element
-    Element(Id id, const std::vector<Point>& points) : Identifier(id),points_(points)
+	//! This constructor creates an Element, given its Id and an std vector with the object Point that will define the Element
+    Element(Id id, const std::vector<Point>& points) : Identifier(id)
+	{ std::copy_n(points.begin(), NNODES, points_.begin()); this->computeProperties(); }
+
+	//! This constructor creates an Element, given its Id and an std array with the object Point that will define the Element
+    Element(Id id, const std::array<Point, NNODES>& points) : Identifier(id),points_(points)
 	{ this->computeProperties(); }
 
+	//! This constructor creates an Element, given its Id, its nodes and its geometric properties already computed
+	/*!
+	 * The geometric properties are read from a table built once per mesh (see MeshHandler::buildGeometryCache),
+	 * so that computeProperties() is not called again each time the element is rebuilt
+	*/
+    Element(Id id, const std::array<Point, NNODES>& points, const Real* geometry) : Identifier(id),points_(points)
+	{ this->loadGeometry(geometry); }
+
 	//! This constructor creates an Element, given its a std::vector that will define the Element.
 	// It's necessary for communicate with ADTree structure
     Element(const std::vector<Real> & points) : Identifier(NVAL) {
-    //need to reconstruct vector<Real> points to vector<Point> points_
-    std::vector<Point> tmp;
-	tmp.resize(NNODES);
-	tmp[0]=(Point(points[0],points[1]));
-	tmp[1]=(Point(points[2],points[3]));
-	tmp[2]=(Point(points[4],points[5]));
-	points_ = tmp;
+    //need to reconstruct vector<Real> points to the Point array points_
+	points_[0]=Point(points[0],points[1]);
+	points_[1]=Point(points[2],points[3]);
+	points_[2]=Point(points[4],points[5]);
 	this->computeProperties();
 	}
 
@@ -163,7 +169,7 @@ public:
       \param i an integer argument.
       \return the Point object
     */
-	Point operator[](UInt i) const {return points_[i];}
+	const Point& operator[](UInt i) const {return points_[i];}
 
 	// Returns the number of physical space dimension.
 	inline static constexpr int dp() { return nDim; }
@@ -174,6 +180,12 @@ public:
 	// Returns the size of coordinate array. (3*2)
 	inline static constexpr int coordsize() { return numVertices*nDim; }
 
+	// Returns the number of Real values needed to store the geometric properties of the element
+	inline static constexpr int geometrySize() { return 13; }
+
+	//! A member copying the geometric properties of the element in a contiguous buffer of geometrySize() values
+	void storeGeometry(Real* geometry) const;
+
 
 	//! A member that computes the barycentric coordinates.
     /*!
@@ -216,13 +228,13 @@ public:
 	void print(std::ostream & out) const;
 
 private:
-	//std::array<Point, NNODES> points_;
-	std::vector<Point> points_;
+	std::array<Point, NNODES> points_;
 	Eigen::Matrix<Real,2,2> M_J_;
 	Eigen::Matrix<Real,2,2> M_invJ_;
 	Eigen::Matrix<Real,2,2> metric_;
 	Real detJ_;
 	void computeProperties();
+	void loadGeometry(const Real* geometry);
 };
 
 
@@ -266,21 +278,30 @@ public:
 	static const UInt nDim=3; //ndim is the dimension of the space in which the object is embedded
 
     //! This constructor creates an "empty" Element, with an Id Not Valid
-	Element():Identifier(NVAL){points_.resize(NNODES);}
+	Element():Identifier(NVAL){}
+
+	//! This constructor creates an Element, given its Id and an std vector with the object Point that will define the Element
+    Element(Id id, const std::vector<Point>& points) : Identifier(id)
+	{ std::copy_n(points.begin(), NNODES, points_.begin()); this->computeProperties(); }
 
-	//! This constructor creates an Element, given its Id and an std array with the three object Point the will define the Element
-    Element(Id id, const std::vector<Point> points) : Identifier(id),points_(points)
+	//! This constructor creates an Element, given its Id and an std array with the object Point that will define the Element
+    Element(Id id, const std::array<Point, NNODES>& points) : Identifier(id),points_(points)
 	{ this->computeProperties(); }
 
+	//! This constructor creates an Element, given its Id, its nodes and its geometric properties already computed
+	/*!
+	 * The geometric properties are read from a table built once per mesh (see MeshHandler::buildGeometryCache),
+	 * so that computeProperties() is not called again each time the element is rebuilt
+	*/
+    Element(Id id, const std::array<Point, NNODES>& points, const Real* geometry) : Identifier(id),points_(points)
+	{ this->loadGeometry(geometry); }
+
 	//! This constructor creates an Element, given its a std::vector that will define the Element, it's necessary for communicate with ADTree structure
     Element(const std::vector<Real> & points) : Identifier(NVAL) {
-    //need to reconstruct vector<Real> points to vector<Point> points_
-    std::vector<Point> tmp;
-	tmp.resize(NNODES);
-	tmp[0]=(Point(points[0],points[1],points[2]));
-	tmp[1]=(Point(points[3],points[4],points[5]));
-	tmp[2]=(Point(points[6],points[7],points[8]));
-	points_ = tmp;
+    //need to reconstruct vector<Real> points to the Point array points_
+	points_[0]=Point(points[0],points[1],points[2]);
+	points_[1]=Point(points[3],points[4],points[5]);
+	points_[2]=Point(points[6],points[7],points[8]);
 	this->computeProperties();
 	}
 
@@ -290,7 +311,7 @@ public:
       \param i an integer argument.
       \return the Point object
     */
-	Point operator[](UInt i) const {return points_[i];}
+	const Point& operator[](UInt i) const {return points_[i];}
 
 	// Returns the number of physical space dimension.
 	inline static constexpr int dp() { return nDim; }
@@ -301,6 +322,12 @@ public:
 	// Returns the size of coordinate array. (3*3)
 	inline static constexpr int coordsize() { return numVertices*nDim; }
 
+	// Returns the number of Real values needed to store the geometric properties of the element
+	inline static constexpr int geometrySize() { return 15; }
+
+	//! A member copying the geometric properties of the element in a contiguous buffer of geometrySize() values
+	void storeGeometry(Real* geometry) const;
+
 	//! A member that computes the barycentric coordinates.
     /*!
       \param point a Point object
@@ -321,6 +348,14 @@ public:
     */
 	bool isPointInside(const Point& point) const;
 
+	//! A memeber that verifies which edge separates the Triangle from a Point.
+    /*!
+      \param point a Point object, the barycentric coordinates are those of its projection on the plane of the triangle.
+      \return The number of the Edge that separates the point
+      from the triangle and -1 if the projection of the point is inside the triangle.
+    */
+	int getPointDirection(const Point& point) const;
+
 	//! A member that prints the main properties of the triangle
     /*!
       \param out a std::outstream.
@@ -329,12 +364,13 @@ public:
 
 private:
 
-	std::vector<Point> points_;
+	std::array<Point, NNODES> points_;
 	Eigen::Matrix<Real,3,2> M_J_;
 	Eigen::Matrix<Real,2,2> G_J_; //M_J^t*M_J
 	Eigen::Matrix<Real,2,2> metric_; //inv(GJ)
 	Real detJ_;
 	void computeProperties();
+	void loadGeometry(const Real* geometry);
 };
 
 
@@ -354,22 +390,31 @@ public:
 	static const UInt nDim=3; //ndim is the dimension of the space in which the object is embedded
 
     //! This constructor creates an "empty" Tetrahedron, with an Id Not Valid
-	Element():Identifier(NVAL){points_.resize(NNODES);}
+	Element():Identifier(NVAL){}
 
-	//! This constructor creates a Tetrahedron, given its Id and an std array with the three object Point the will define the Tetrahedron
-    Element(Id id, const std::vector<Point> points) : Identifier(id),points_(points)
+	//! This constructor creates a Tetrahedron, given its Id and an std vector with the object Point that will define the Tetrahedron
+    Element(Id id, const std::vector<Point>& points) : Identifier(id)
+	{ std::copy_n(points.begin(), NNODES, points_.begin()); this->computeProperties(); }
+
+	//! This constructor creates a Tetrahedron, given its Id and an std array with the object Point that will define the Tetrahedron
+    Element(Id id, const std::array<Point, NNODES>& points) : Identifier(id),points_(points)
 	{ this->computeProperties(); }
 
+	//! This constructor creates an Tetrahedron, given its Id, its nodes and its geometric properties already computed
+	/*!
+	 * The geometric properties are read from a table built once per mesh (see MeshHandler::buildGeometryCache),
+	 * so that computeProperties() is not called again each time the element is rebuilt
+	*/
+    Element(Id id, const std::array<Point, NNODES>& points, const Real* geometry) : Identifier(id),points_(points)
+	{ this->loadGeometry(geometry); }
+
 	//! This constructor creates an Element, given its a std::vector that will define the Element, it's necessary for communicate with ADTree structure
     Element(const std::vector<Real> & points) : Identifier(NVAL) {
-    //need to reconstruct vector<Real> points to vector<Point> points_
-    std::vector<Point> tmp;
-	tmp.resize(NNODES);
-	tmp[0]=(Point(points[0],points[1],points[2]));
-	tmp[1]=(Point(points[3],points[4],points[5]));
-	tmp[2]=(Point(points[6],points[7],points[8]));
-	tmp[3]=(Point(points[9],points[10],points[11]));
-	points_ = tmp;
+    //need to reconstruct vector<Real> points to the Point array points_
+	points_[0]=Point(points[0],points[1],points[2]);
+	points_[1]=Point(points[3],points[4],points[5]);
+	points_[2]=Point(points[6],points[7],points[8]);
+	points_[3]=Point(points[9],points[10],points[11]);
 	this->computeProperties();
 	}
 
@@ -379,7 +424,7 @@ public:
       \param i an integer argument.
       \return the Point object
     */
-	Point operator[](UInt i) const {return points_[i];}
+	const Point& operator[](UInt i) const {return points_[i];}
 
 	// Returns the number of physical space dimension.
 	inline static constexpr int dp() { return nDim; }
@@ -390,6 +435,12 @@ public:
 	// Returns the size of coordinate array. (4*3)
 	inline static constexpr int coordsize() { return numVertices*nDim; }
 
+	// Returns the number of Real values needed to store the geometric properties of the element
+	inline static constexpr int geometrySize() { return 38; }
+
+	//! A member copying the geometric properties of the element in a contiguous buffer of geometrySize() values
+	void storeGeometry(Real* geometry) const;
+
 	//! A member that computes the barycentric coordinates.
     /*!
       \param point a Point object
@@ -413,6 +464,14 @@ public:
     */
 	bool isPointInside(const Point& point) const;
 
+	//! A memeber that verifies which face separates the Tetrahedron from a Point.
+    /*!
+      \param point a Point object.
+      \return The number of the Face that separates the point
+      from the tetrahedron and -1 if the point is inside the tetrahedron.
+    */
+	int getPointDirection(const Point& point) const;
+
 	//! A member that prints the main properties of the tetrahedron
     /*!
       \param out a std::outstream.
@@ -421,7 +480,7 @@ public:
 
 private:
 
-	std::vector<Point> points_;
+	std::array<Point, NNODES> points_;
 	Eigen::Matrix<Real,3,3> M_J_;
 	Eigen::Matrix<Real,3,3> G_J_; //M_J^t*M_J
 	Eigen::Matrix<Real,3,3> M_invJ_;
@@ -429,6 +488,7 @@ private:
 	Real detJ_;
 	Real Volume_;
 	void computeProperties();
+	void loadGeometry(const Real* geometry);
 };
 
 
@@ -503,6 +563,70 @@ inline Real evaluate_point<4,3,3>(const Element<4,3,3>& t, const Point& point, c
 	return(coefficients.dot(bary_coeff));
 }
 
+//! Values of all the basis functions of an element at a point
+/*!
+ * The same values as evaluate_point with the coefficients of one basis function set to 1,
+ * computing the barycentric coordinates of the point only once
+*/
+template <UInt Nodes, UInt mydim, UInt ndim>
+inline Eigen::Matrix<Real,Nodes,1> evaluate_basis(const Element<Nodes,mydim,ndim>& t, const Point& point)
+{
+	Eigen::Matrix<Real,Nodes,1> values, coefficients;
+	for(UInt node = 0; node < Nodes; ++node)
+	{
+		coefficients = Eigen::Matrix<Real,Nodes,1>::Zero();
+		coefficients(node) = 1;
+		values(node) = evaluate_point<Nodes,mydim,ndim>(t, point, coefficients);
+	}
+	return values;
+}
+
+template <>
+inline Eigen::Matrix<Real,3,1> evaluate_basis<3,2,2>(const Element<3,2,2>& t, const Point& point)
+{
+	return t.getBaryCoordinates(point);
+}
+
+template <>
+inline Eigen::Matrix<Real,6,1> evaluate_basis<6,2,2>(const Element<6,2,2>& t, const Point& point)
+{
+	Eigen::Matrix<Real,3,1> bary_coeff = t.getBaryCoordinates(point);
+	Eigen::Matrix<Real,6,1> values;
+	values << 2*bary_coeff[0]*bary_coeff[0] - bary_coeff[0],
+	          2*bary_coeff[1]*bary_coeff[1] - bary_coeff[1],
+	          2*bary_coeff[2]*bary_coeff[2] - bary_coeff[2],
+	          4*bary_coeff[1]*bary_coeff[2],
+	          4*bary_coeff[2]*bary_coeff[0],
+	          4*bary_coeff[0]*bary_coeff[1];
+	return values;
+}
+
+template <>
+inline Eigen::Matrix<Real,3,1> evaluate_basis<3,2,3>(const Element<3,2,3>& t, const Point& point)
+{
+	return t.getBaryCoordinates(point);
+}
+
+template <>
+inline Eigen::Matrix<Real,6,1> evaluate_basis<6,2,3>(const Element<6,2,3>& t, const Point& point)
+{
+	Eigen::Matrix<Real,3,1> bary_coeff = t.getBaryCoordinates(point);
+	Eigen::Matrix<Real,6,1> values;
+	values << 2*bary_coeff[0]*bary_coeff[0] - bary_coeff[0],
+	          2*bary_coeff[1]*bary_coeff[1] - bary_coeff[1],
+	          2*bary_coeff[2]*bary_coeff[2] - bary_coeff[2],
+	          4*bary_coeff[1]*bary_coeff[2],
+	          4*bary_coeff[2]*bary_coeff[0],
+	          4*bary_coeff[0]*bary_coeff[1];
+	return values;
+}
+
+template <>
+inline Eigen::Matrix<Real,4,1> evaluate_basis<4,3,3>(const Element<4,3,3>& t, const Point& point)
+{
+	return t.getBaryCoordinates(point);
+}
+
 template <UInt Nodes,UInt mydim, UInt ndim>
 inline Eigen::Matrix<Real,ndim,1> evaluate_der_point(const Element<Nodes,mydim,ndim>& t, const Point& point, const Eigen::Matrix<Real,Nodes,1>& coefficients)
 {
@@ -28,10 +28,28 @@ void Element<NNODES,2,2>::computeProperties()
 	metric_ = M_invJ_ * M_invJ_.transpose();
 }
 
+template <UInt NNODES>
+void Element<NNODES,2,2>::storeGeometry(Real* geometry) const
+{
+	geometry = std::copy(M_J_.data(), M_J_.data()+4, geometry);
+	geometry = std::copy(M_invJ_.data(), M_invJ_.data()+4, geometry);
+	geometry = std::copy(metric_.data(), metric_.data()+4, geometry);
+	*geometry++ = detJ_;
+}
+
+template <UInt NNODES>
+void Element<NNODES,2,2>::loadGeometry(const Real* geometry)
+{
+	std::copy(geometry, geometry+4, M_J_.data()); geometry += 4;
+	std::copy(geometry, geometry+4, M_invJ_.data()); geometry += 4;
+	std::copy(geometry, geometry+4, metric_.data()); geometry += 4;
+	detJ_ = *geometry++;
+}
+
 template <UInt NNODES>
 Eigen::Matrix<Real,3,1> Element<NNODES,2,2>::getBaryCoordinates(const Point& point) const{
 
-	Element<NNODES,2,2> t=*this;
+	const Element<NNODES,2,2>& t=*this;
 	Eigen::Matrix<Real,3,1> lambda;
 	Eigen::Matrix<Real,4,1> bary_coef;
 	//Real eps = 2.2204e-016,
@@ -149,6 +167,24 @@ void Element<NNODES,2,3>::computeProperties()
 
 }
 
+template <UInt NNODES>
+void Element<NNODES,2,3>::storeGeometry(Real* geometry) const
+{
+	geometry = std::copy(M_J_.data(), M_J_.data()+6, geometry);
+	geometry = std::copy(G_J_.data(), G_J_.data()+4, geometry);
+	geometry = std::copy(metric_.data(), metric_.data()+4, geometry);
+	*geometry++ = detJ_;
+}
+
+template <UInt NNODES>
+void Element<NNODES,2,3>::loadGeometry(const Real* geometry)
+{
+	std::copy(geometry, geometry+6, M_J_.data()); geometry += 6;
+	std::copy(geometry, geometry+4, G_J_.data()); geometry += 4;
+	std::copy(geometry, geometry+4, metric_.data()); geometry += 4;
+	detJ_ = *geometry++;
+}
+
 template <UInt NNODES>
 Eigen::Matrix<Real,3,1> Element<NNODES,2,3>::getBaryCoordinates(const Point& point) const{
 
@@ -184,7 +220,7 @@ Eigen::Matrix<Real,3,1> Element<NNODES,2,3>::getBaryCoordinates(const Point& poi
 //
 //	return lambda;
 
-    Element<NNODES,2,3> t=*this;         // implementation using the linear system-> not perfect but the best implementation so far
+    const Element<NNODES,2,3>& t=*this;         // implementation using the linear system-> not perfect but the best implementation so far
     Eigen::Matrix<Real,3,1> lambda;
 
 	Eigen::Matrix<Real,3,2> A;
@@ -239,7 +275,7 @@ bool Element<NNODES,2,3>::isPointInside(const Point& point) const
 	Real eps = 2.2204e-016;
 	Real tolerance = 10 * eps;
 	//THIS COMMENT IS FROM BERAHA, COSMO First: check consistency trough Rouchè-Capelli theorem
-	Element<NNODES,2,3> t=*this;
+	const Element<NNODES,2,3>& t=*this;
 
 	Eigen::Matrix<Real,3,2> A;
 	Eigen::Matrix<Real,3,1> b;
@@ -270,14 +306,21 @@ bool Element<NNODES,2,3>::isPointInside(const Point& point) const
 }
 
 
-/*
 template <UInt NNODES>
-int Triangle<NNODES,2,3>::getPointDirection(const Point& point) const
+int Element<NNODES,2,3>::getPointDirection(const Point& point) const
 {
-	//da implementare
-	std::cerr<<"ancora da implementare";
+	Real eps = 2.2204e-016,
+		 tolerance = 10 * eps;
+
+	Eigen::Matrix<Real,3,1> lambda = getBaryCoordinates(point);
+
+	//Find the minimum coordinate (if negative stronger straight to the point searched)
+	int min_index;
+	lambda.minCoeff(&min_index);
+
+	if(lambda[min_index] < -tolerance) 	return min_index;
+	else 							   	return -1;
 }
-*/
 
 template <UInt NNODES>
 void Element<NNODES,2,3>::print(std::ostream & out) const
@@ -390,11 +433,35 @@ void Element<NNODES,3,3>::computeProperties()
 
 
 
+template <UInt NNODES>
+void Element<NNODES,3,3>::storeGeometry(Real* geometry) const
+{
+	geometry = std::copy(M_J_.data(), M_J_.data()+9, geometry);
+	geometry = std::copy(G_J_.data(), G_J_.data()+9, geometry);
+	geometry = std::copy(M_invJ_.data(), M_invJ_.data()+9, geometry);
+	geometry = std::copy(metric_.data(), metric_.data()+9, geometry);
+	*geometry++ = detJ_;
+	*geometry++ = Volume_;
+}
+
+template <UInt NNODES>
+void Element<NNODES,3,3>::loadGeometry(const Real* geometry)
+{
+	std::copy(geometry, geometry+9, M_J_.data()); geometry += 9;
+	std::copy(geometry, geometry+9, G_J_.data()); geometry += 9;
+	std::copy(geometry, geometry+9, M_invJ_.data()); geometry += 9;
+	std::copy(geometry, geometry+9, metric_.data()); geometry += 9;
+	detJ_ = *geometry++;
+	Volume_ = *geometry++;
+}
+
+
+
 template <UInt NNODES>
 Eigen::Matrix<Real,4,1> Element<NNODES,3,3>::getBaryCoordinates(const Point& point) const{
 
 
-	Element<NNODES,3,3> t=*this;
+	const Element<NNODES,3,3>& t=*this;
 	Eigen::Matrix<Real,4,1> lambda;
 	Eigen::Matrix<Real,3,3> M_J_point;
 	Eigen::Matrix<Real,3,1> rhs;
@@ -440,12 +507,29 @@ bool Element<NNODES,3,3>::isPointInside(const Point& point) const
 	Real eps = 2.2204e-016;
 	Real tolerance = 10 * eps;
 
-	Element<NNODES,3,3> t=*this;
+	const Element<NNODES,3,3>& t=*this;
 	Eigen::Matrix<Real,4,1> bary_coeff = t.getBaryCoordinates(point);
 	return -tolerance <= bary_coeff[0] && -tolerance <= bary_coeff[1] && -tolerance <= bary_coeff[2] && -tolerance <= bary_coeff[3];
 }
 
 
+template <UInt NNODES>
+int Element<NNODES,3,3>::getPointDirection(const Point& point) const
+{
+	Real eps = 2.2204e-016,
+		 tolerance = 10 * eps;
+
+	Eigen::Matrix<Real,4,1> lambda = getBaryCoordinates(point);
+
+	//Find the minimum coordinate (if negative stronger straight to the point searched)
+	int min_index;
+	lambda.minCoeff(&min_index);
+
+	if(lambda[min_index] < -tolerance) 	return min_index;
+	else 							   	return -1;
+}
+
+
 template <UInt NNODES>
 void Element<NNODES,3,3>::print(std::ostream & out) const
 {
@@ -0,0 +1,154 @@
+#ifndef __MESH_REORDERING_H__
+#define __MESH_REORDERING_H__
+
+#include <algorithm>
+#include <numeric>
+
+#include "../../FdaPDE.h"
+#include "Mesh_Adjacency.h"
+#include "Spatial_Sort.h"
+
+//! A function returning the farthest node from start, in the graph of the nodes, among those with the lowest degree
+/*!
+ * It is the pseudo-peripheral node heuristic of George and Liu: starting from a node of low degree,
+ * a breadth-first visit is repeated from the node of lowest degree of the last level while the
+ * number of levels grows. Only the component of start is visited.
+ * \param adjacency the adjacency tables of the mesh
+ * \param start a node
+ * \param level a vector with one entry per node, used as workspace
+ * \return a node at the end of a long path from start
+*/
+template<class Shape>
+UInt pseudoPeripheralNode(const MeshAdjacency<Shape>& adjacency, UInt start, std::vector<UInt>& level)
+{
+	const UInt none = Identifier::NVAL;
+	std::vector<UInt> queue;
+	queue.reserve(adjacency.numNodes());
+
+	UInt eccentricity = 0;
+	for(;;)
+	{
+		// Breadth-first visit from start, then reset of the levels of the visited nodes
+		queue.assign(1, start);
+		level[start] = 0;
+		for(UInt q = 0; q < queue.size(); ++q)
+		{
+			UInt const * begin, * end;
+			adjacency.nodeNodes(queue[q], begin, end);
+			for(UInt const * m = begin; m != end; ++m)
+				if(level[*m] == none)
+				{
+					level[*m] = level[queue[q]]+1;
+					queue.push_back(*m);
+				}
+		}
+		const UInt depth = level[queue.back()];
+
+		UInt candidate = queue.back(), degree = none;
+		for(auto it = queue.rbegin(); it != queue.rend() && level[*it] == depth; ++it)
+		{
+			UInt const * begin, * end;
+			adjacency.nodeNodes(*it, begin, end);
+			if(UInt(end-begin) < degree)
+			{
+				degree = end-begin;
+				candidate = *it;
+			}
+		}
+		for(UInt n : queue)
+			level[n] = none;
+
+		if(depth <= eccentricity)
+			return start;
+		eccentricity = depth;
+		start = candidate;
+	}
+}
+
+//! A function returning the reverse Cuthill-McKee order of the nodes of a mesh
+/*!
+ * Every connected component is visited breadth-first from a pseudo-peripheral node, the neighbors of
+ * each node being added by increasing degree; the order of the visit is then reversed. Numbering the
+ * nodes in this order reduces the bandwidth of the finite element matrices.
+ * \param adjacency the adjacency tables of the mesh
+ * \return a permutation p such that p[i] is the node to be numbered i
+*/
+template<class Shape>
+std::vector<UInt> reverseCuthillMcKee(const MeshAdjacency<Shape>& adjacency)
+{
+	const UInt num_nodes = adjacency.numNodes();
+	const UInt none = Identifier::NVAL;
+
+	std::vector<UInt> degree(num_nodes);
+	for(UInt n = 0; n < num_nodes; ++n)
+	{
+		UInt const * begin, * end;
+		adjacency.nodeNodes(n, begin, end);
+		degree[n] = end-begin;
+	}
+
+	// The nodes by increasing degree: the first one not yet numbered starts a new component
+	std::vector<UInt> by_degree(num_nodes);
+	std::iota(by_degree.begin(), by_degree.end(), 0);
+	std::stable_sort(by_degree.begin(), by_degree.end(), [&degree](UInt a, UInt b) {return degree[a] < degree[b];});
+
+	std::vector<UInt> order;
+	order.reserve(num_nodes);
+	std::vector<bool> numbered(num_nodes, false);
+	std::vector<UInt> level(num_nodes, none);
+	std::vector<UInt> neighbors;
+
+	for(UInt seed : by_degree)
+	{
+		if(numbered[seed])
+			continue;
+
+		const UInt start = pseudoPeripheralNode(adjacency, seed, level);
+		numbered[start] = true;
+		order.push_back(start);
+		for(UInt q = order.size()-1; q < order.size(); ++q)
+		{
+			UInt const * begin, * end;
+			adjacency.nodeNodes(order[q], begin, end);
+			neighbors.clear();
+			for(UInt const * m = begin; m != end; ++m)
+				if(!numbered[*m])
+				{
+					numbered[*m] = true;
+					neighbors.push_back(*m);
+				}
+			std::stable_sort(neighbors.begin(), neighbors.end(), [&degree](UInt a, UInt b) {return degree[a] < degree[b];});
+			order.insert(order.end(), neighbors.begin(), neighbors.end());
+		}
+	}
+
+	std::reverse(order.begin(), order.end());
+	return order;
+}
+
+//! A function returning the order of the elements of a mesh along a Morton curve through their centroids
+/*!
+ * Numbering the elements in this order makes the elements visited one after the other by the mesh
+ * loops (assembly, search) close in space, and so their nodes close in memory.
+ * \param mesh the mesh
+ * \param ndim the number of coordinates of the nodes (2 or 3)
+ * \return a permutation p such that p[i] is the element to be numbered i
+*/
+template<class Mesh>
+std::vector<UInt> elementMortonOrder(const Mesh& mesh, UInt ndim)
+{
+	std::vector<Point> centroids(mesh.num_elements());
+	for(UInt e = 0; e < mesh.num_elements(); ++e)
+	{
+		auto element = mesh.getElement(e);
+		const UInt nvertex = decltype(element)::numVertices;
+		Real centroid[3] = {0., 0., 0.};
+		for(UInt i = 0; i < nvertex; ++i)
+			for(UInt k = 0; k < ndim; ++k)
+				centroid[k] += element[i][k]/nvertex;
+		centroids[e] = (ndim == 2) ? Point(centroid[0], centroid[1]) : Point(centroid[0], centroid[1], centroid[2]);
+	}
+	return mortonOrder(centroids, ndim);
+}
+
+#endif
@@ -5,6 +5,13 @@
 #include<fstream>
 #include<sstream>
 
+//! Reads the R option fdaPDE.geometry.cache, setting it to FALSE disables the per-mesh geometry table
+inline bool geometryCacheOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.geometry.cache"));
+	return !(Rf_isLogical(option) && Rf_length(option) > 0 && LOGICAL(option)[0] == FALSE);
+}
+
 template <UInt ORDER>
 MeshHandler<ORDER,2,2>::MeshHandler(SEXP mesh, UInt search)
 {
@@ -18,15 +25,18 @@ MeshHandler<ORDER,2,2>::MeshHandler(SEXP mesh, UInt search)
 	num_elements_ = INTEGER(Rf_getAttrib(VECTOR_ELT(mesh_, 3), R_DimSymbol))[0];
 	num_edges_ = INTEGER(Rf_getAttrib(VECTOR_ELT(mesh_, 6), R_DimSymbol))[0];
 	search_ = search;
+	geometry_cache_ = geometryCacheOption();
 
 	if (search == 2) { //if tree search, construct a tree mesh
 		// Rprintf("mesh TYPE: %d \n",TYPEOF(mesh_)); //VECSXP, list (generic vector), 19
 		// Rprintf("mesh LENGTH: %d \n",XLENGTH(mesh_));
 
-		int mesh_len = XLENGTH(mesh_);
-		if (mesh_len == 11) { //don't have tree mesh information (length==11)
-			ADTree<Element<3*ORDER,2,2>> tmp(points_, elements_, num_nodes_, num_elements_);
-			tree_ = tmp;
+		SEXP image = meshImageElement(mesh_);
+		int mesh_len = XLENGTH(mesh_) - (image != R_NilValue); //the image, if any, is the last element
+		if (image != R_NilValue && getImage().read(image, tree_)) {
+			//tree read in place from the image of the mesh, see MeshImage
+		} else if (mesh_len == 11) { //don't have tree mesh information (length==11)
+			tree_ = ADTree<Element<3*ORDER,2,2>>(points_, elements_, num_nodes_, num_elements_, 3*ORDER);
 		} else {
 			//RECIEVE TREE INFORMATION FROM R
 			//tree_header information
@@ -58,10 +68,11 @@ MeshHandler<ORDER,2,2>::MeshHandler(SEXP mesh, UInt search)
 
 			UInt num_tree_nodes = id_.size();
 			std::vector<TreeNode<Element<3*ORDER,2,2>>> tree_nodes;
+			tree_nodes.reserve(num_tree_nodes);
+			std::vector<Real> coord(ndimt_);
 			for (UInt i=0; i<num_tree_nodes; i++) {
-				std::vector<Real> coord;
 				for (UInt j=0; j<ndimt_; j++) {
-					coord.push_back(box_[i + num_tree_nodes*j]);
+					coord[j] = box_[i + num_tree_nodes*j];
 				}
 				Box<2> box (coord);
 				TreeNode<Element<3*ORDER,2,2>> tree_node(box, id_[i], node_left_child_[i], node_right_child_[i]);
@@ -69,14 +80,15 @@ MeshHandler<ORDER,2,2>::MeshHandler(SEXP mesh, UInt search)
 			}
 
 
-			ADTree<Element<3*ORDER,2,2>> tmp(tree_header, tree_nodes);
-			tree_ = tmp;
+			tree_ = ADTree<Element<3*ORDER,2,2>>(tree_header, tree_nodes);
 		}
-	} //if tree search, construct a tree mesh
+	} else if (search == 4) { //if grid search, fill the buckets
+		buildGrid();
+	}
 }
 
 template <UInt ORDER>
-Point MeshHandler<ORDER,2,2>::getPoint(Id id)
+Point MeshHandler<ORDER,2,2>::getPoint(Id id) const
 {
 	Point point(id, Identifier::NVAL, points_[id], points_[num_nodes_+id]);
 	return point;
@@ -95,8 +107,7 @@ Edge MeshHandler<ORDER,2,2>::getEdge(Id id)
 template <UInt ORDER>
 Element<3*ORDER,2,2> MeshHandler<ORDER,2,2>::getElement(Id id) const
 {
-	std::vector<Point> element_points;
-	element_points.resize(3*ORDER);
+	std::array<Point, 3*ORDER> element_points;
 	Id id_current_point;
 	for (int i=0; i<3*ORDER; ++i)
 	{
@@ -109,9 +120,53 @@ Element<3*ORDER,2,2> MeshHandler<ORDER,2,2>::getElement(Id id) const
 
 
 	}
+	if(!geometry_.empty())
+		return Element<3*ORDER,2,2>(id, element_points, &geometry_[Element<3*ORDER,2,2>::geometrySize()*id]);
 	return Element<3*ORDER,2,2>(id, element_points);
 }
 
+template <UInt ORDER>
+void MeshHandler<ORDER,2,2>::buildGeometryCache() const
+{
+	if(!geometry_cache_ || !geometry_.empty())
+		return;
+
+	const UInt size = Element<3*ORDER,2,2>::geometrySize();
+	std::vector<Real> geometry(size*num_elements_);
+	for(Id id=0; id < num_elements_; ++id)
+		getElement(id).storeGeometry(&geometry[size*id]);
+	geometry_.swap(geometry);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,2,2>::setGeometryCache(bool enable)
+{
+	geometry_cache_ = enable;
+	if(!enable)
+		std::vector<Real>().swap(geometry_);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,2,2>::buildGrid() const
+{
+	if(grid_.size() == 0 && num_elements_ > 0)
+		grid_ = BucketGrid<Element<3*ORDER,2,2>>(points_, elements_, num_nodes_, num_elements_, 3*ORDER);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,2,2>::buildAdjacency() const
+{
+	if(adjacency_.numNodes() == 0 && num_nodes_ > 0)
+		adjacency_ = MeshAdjacency<Element<3*ORDER,2,2>>(elements_, num_nodes_, num_elements_, 3*ORDER);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,2,2>::buildAssemblyPattern() const
+{
+	if(pattern_.numNodes() == 0 && num_nodes_ > 0)
+		pattern_ = AssemblyPattern<Element<3*ORDER,2,2>>(getAdjacency(), elements_, num_elements_, 3*ORDER);
+}
+
 template <UInt ORDER>
 Element<3*ORDER,2,2>MeshHandler<ORDER,2,2>::getNeighbors(Id id_element, UInt number) const
 {
@@ -163,39 +218,99 @@ Element<3*ORDER,2,2> MeshHandler<ORDER,2,2>::findLocationWalking(const Point& po
 
 template <UInt ORDER>
 Element<3*ORDER,2,2> MeshHandler<ORDER,2,2>::findLocationTree(const Point& point) const {
-		std::vector<Real> region(4);
-		bool result;
-		std::set<int> found;
-		int index;
-		Element<3*ORDER,2,2> tmp;
-		region[0] = point[0];
-		region[1] = point[1];
-		region[2] = point[0];
-		region[3] = point[1];
-
-		result = tree_.search(region, found);
-		if(result == 0) {
-			return Element<3*ORDER,2,2>();
-		}
+	const Real region[4] = {point[0], point[1], point[0], point[1]};
+	Element<3*ORDER,2,2> found;
 
-		for (std::set<int>::iterator i = found.begin(); i != found.end(); i++) {
-			index = *i;
-			index = this -> tree_.pointId(index);
-	  		tmp = this -> getElement(index);
-			result = tmp.isPointInside(point);
-			if(result == 1) {
-				return tmp;
-			}
-		}
+	// The boxes containing the point are visited until the first element containing it
+	bool inside = tree_.searchUntil(region, [&](int index) {
+		found = this -> getElement(this -> tree_.pointId(index));
+		return found.isPointInside(point);
+	});
+
+	return inside ? found : Element<3*ORDER,2,2>();
+}
+
+
+template <UInt ORDER>
+Element<3*ORDER,2,2> MeshHandler<ORDER,2,2>::findLocationGrid(const Point& point) const {
+	const UInt * begin;
+	const UInt * end;
+	grid_.candidates(point, begin, end);
+
+	Element<3*ORDER,2,2> tmp;
+	for(const UInt * it = begin; it != end; ++it) {
+		tmp = getElement(*it);
+		if(tmp.isPointInside(point))
+			return tmp;
+	}
 	return Element<3*ORDER,2,2>();
 }
 
+template <UInt ORDER>
+std::vector<Id> MeshHandler<ORDER,2,2>::findLocationBatch(const std::vector<Point>& points, bool redundancy) const
+{
+	std::vector<Id> located(points.size(), Identifier::NVAL);
+	const std::vector<UInt> order = mortonOrder(points, 2);
+
+	// With the tree available the walk is only worth a few steps, a longer one is replaced by a tree
+	// query; without it the bound only protects against the (rare) cycles of the visibility walk
+	const UInt max_steps = (search_ == 2 || search_ == 4) ? 64 : num_elements_;
+
+	buildGeometryCache();
+
+	// The curve is cut in chunks of consecutive points, located in parallel: every chunk walks on
+	// its own, so that the result does not depend on the number of threads
+	const int chunks = (points.size()+MortonChunkSize-1)/MortonChunkSize;
+	const int threads = fdaPDEThreads();
+	#pragma omp parallel for num_threads(threads) schedule(dynamic)
+	for(int chunk = 0; chunk < chunks; ++chunk)
+	{
+		Element<3*ORDER,2,2> current_element;
+		Id previous = (search_ == 2 || search_ == 4) ? Identifier::NVAL : 0;
+		const UInt last = std::min<UInt>(points.size(), (chunk+1)*MortonChunkSize);
+
+		for(UInt k = chunk*MortonChunkSize; k < last; ++k)
+		{
+			const UInt i = order[k];
+			const Point& point = points[i];
+			Id found = Identifier::NVAL;
+
+			if(previous != Identifier::NVAL)
+			{
+				current_element = getElement(previous);
+				for(UInt step = 0; step < max_steps && current_element.getId() != Identifier::NVAL; ++step)
+				{
+					if(current_element.isPointInside(point))
+					{
+						found = current_element.getId();
+						break;
+					}
+					current_element = getNeighbors(current_element.getId(), current_element.getPointDirection(point));
+				}
+			}
+
+			if(found == Identifier::NVAL)
+			{
+				if(search_ == 2)
+					found = findLocationTree(point).getId();
+				else if(search_ == 4)
+					found = findLocationGrid(point).getId();
+				else if(redundancy)
+					found = findLocationNaive(point).getId();
+			}
+
+			if(found != Identifier::NVAL)
+				previous = found;
+			located[i] = found;
+		}
+	}
+	return located;
+}
 
 template <UInt ORDER>
 Real MeshHandler<ORDER,2,2>::elementMeasure(Id id) const
 {
-	std::vector<Point> p;
-	p.resize(3*ORDER);
+	std::array<Point, 3*ORDER> p;
 	Id id_current_point;
 	for (int i=0; i<3*ORDER; ++i)
 	{
@@ -309,13 +424,16 @@ MeshHandler<ORDER,2,3>::MeshHandler(SEXP mesh, UInt search)
 	points_ = REAL(VECTOR_ELT(mesh_, 2));
 	elements_ = INTEGER(VECTOR_ELT(mesh_, 3));
 	search_ = search;
+	geometry_cache_ = geometryCacheOption();
 
 	if (search == 2) { //if tree search, construct a tree mesh
 		//Rprintf("mesh LENGTH: %d \n", XLENGTH(mesh_));
-		int mesh_len = XLENGTH(mesh_);
-		if (mesh_len == 5) { //don't have tree mesh information (length==5)
-			ADTree<Element<3*ORDER,2,3>> tmp(points_, elements_, num_nodes_, num_elements_);
-			tree_ = tmp;
+		SEXP image = meshImageElement(mesh_);
+		int mesh_len = XLENGTH(mesh_) - (image != R_NilValue); //the image, if any, is the last element
+		if (image != R_NilValue && getImage().read(image, tree_)) {
+			//tree read in place from the image of the mesh, see MeshImage
+		} else if (mesh_len == 5) { //don't have tree mesh information (length==5)
+			tree_ = ADTree<Element<3*ORDER,2,3>>(points_, elements_, num_nodes_, num_elements_, 3*ORDER);
 		} else {
 			//RECIEVE TREE INFORMATION FROM R
 			//tree_header information
@@ -347,19 +465,21 @@ MeshHandler<ORDER,2,3>::MeshHandler(SEXP mesh, UInt search)
 
 			UInt num_tree_nodes = id_.size();
 			std::vector<TreeNode<Element<3*ORDER,2,3>>> tree_nodes;
+			tree_nodes.reserve(num_tree_nodes);
+			std::vector<Real> coord(ndimt_);
 			for (UInt i=0; i<num_tree_nodes; i++) {
-				std::vector<Real> coord;
 				for (UInt j=0; j<ndimt_; j++) {
-					coord.push_back(box_[i + num_tree_nodes*j]);
+					coord[j] = box_[i + num_tree_nodes*j];
 				}
 				Box<3> box (coord);
 				TreeNode<Element<3*ORDER,2,3>> tree_node(box, id_[i], node_left_child_[i], node_right_child_[i]);
 				tree_nodes.push_back(tree_node);
 			}
 
-			ADTree<Element<3*ORDER,2,3>> tmp(tree_header, tree_nodes);
-			tree_ = tmp;
+			tree_ = ADTree<Element<3*ORDER,2,3>>(tree_header, tree_nodes);
 		}
+	} else if (search == 4) { //if grid search, fill the buckets
+		buildGrid();
 	}
 
 }
@@ -437,7 +557,7 @@ void MeshHandler<ORDER,2,3>::importfromCSV(std::string &filename){
 
 
 template <UInt ORDER>
-Point MeshHandler<ORDER,2,3>::getPoint(Id id)
+Point MeshHandler<ORDER,2,3>::getPoint(Id id) const
 {
 	Point point(id, Identifier::NVAL, points_[3*id], points_[3*id+1], points_[3*id+2]);
 	return point;
@@ -446,8 +566,7 @@ Point MeshHandler<ORDER,2,3>::getPoint(Id id)
 template <UInt ORDER>
 Element<3*ORDER,2,3> MeshHandler<ORDER,2,3>::getElement(Id id) const
 {
-	std::vector<Point> element_points;
-	element_points.resize(3*ORDER);
+	std::array<Point, 3*ORDER> element_points;
 	Id id_current_point;
 	for (int i=0; i<3*ORDER; ++i)
 	{
@@ -458,9 +577,53 @@ Element<3*ORDER,2,3> MeshHandler<ORDER,2,3>::getElement(Id id) const
 								 points_[3*id_current_point+1],
 								 points_[3*id_current_point+2]);
 	}
+	if(!geometry_.empty())
+		return Element<3*ORDER,2,3>(id, element_points, &geometry_[Element<3*ORDER,2,3>::geometrySize()*id]);
 	return Element<3*ORDER,2,3>(id, element_points);
 }
 
+template <UInt ORDER>
+void MeshHandler<ORDER,2,3>::buildGeometryCache() const
+{
+	if(!geometry_cache_ || !geometry_.empty())
+		return;
+
+	const UInt size = Element<3*ORDER,2,3>::geometrySize();
+	std::vector<Real> geometry(size*num_elements_);
+	for(Id id=0; id < num_elements_; ++id)
+		getElement(id).storeGeometry(&geometry[size*id]);
+	geometry_.swap(geometry);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,2,3>::setGeometryCache(bool enable)
+{
+	geometry_cache_ = enable;
+	if(!enable)
+		std::vector<Real>().swap(geometry_);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,2,3>::buildGrid() const
+{
+	if(grid_.size() == 0 && num_elements_ > 0)
+		grid_ = BucketGrid<Element<3*ORDER,2,3>>(points_, elements_, num_nodes_, num_elements_, 3*ORDER);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,2,3>::buildAdjacency() const
+{
+	if(adjacency_.numNodes() == 0 && num_nodes_ > 0)
+		adjacency_ = MeshAdjacency<Element<3*ORDER,2,3>>(elements_, num_nodes_, num_elements_, 3*ORDER);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,2,3>::buildAssemblyPattern() const
+{
+	if(pattern_.numNodes() == 0 && num_nodes_ > 0)
+		pattern_ = AssemblyPattern<Element<3*ORDER,2,3>>(getAdjacency(), elements_, num_elements_, 3*ORDER);
+}
+
 
 template <UInt ORDER>
 Element<3*ORDER,2,3> MeshHandler<ORDER,2,3>::findLocationNaive(Point point) const
@@ -477,41 +640,133 @@ Element<3*ORDER,2,3> MeshHandler<ORDER,2,3>::findLocationNaive(Point point) cons
 	return Element<3*ORDER,2,3>(); //default element with NVAL ID
 }
 
+template <UInt ORDER>
+Element<3*ORDER,2,3> MeshHandler<ORDER,2,3>::getNeighbors(Id id_element, UInt number) const
+{
+	Id id_neighbour = getAdjacency().elementNeighbor(id_element, number);
+	if (id_neighbour == Identifier::NVAL) return Element<3*ORDER,2,3>(); //Element with NVAL ID
+
+	return getElement(id_neighbour);
+}
+
+// Visibility walk algorithm which uses barycentric coordinate [Sundareswara et al]
+template <UInt ORDER>
+Element<3*ORDER,2,3> MeshHandler<ORDER,2,3>::findLocationWalking(const Point& point, const Element<3*ORDER,2,3>& starting_element) const
+{
+	//Walking algorithm to the point, the number of steps bounds the (rare) cycles of the walk
+	Element<3*ORDER,2,3> current_element = starting_element;
+
+	for(UInt step = 0; step < num_elements_ && current_element.getId() != Identifier::NVAL; ++step)
+	{
+		if(current_element.isPointInside(point))
+			return current_element;
+		int direction = current_element.getPointDirection(point);
+		if(direction < 0)
+			break; //the point is not beyond any face of the element, but it is not inside it (off the surface)
+		current_element = getNeighbors(current_element.getId(), direction);
+	}
+
+	return Element<3*ORDER,2,3>();
+}
+
 template <UInt ORDER>
 Element<3*ORDER,2,3> MeshHandler<ORDER,2,3>::findLocationTree(const Point& point) const {
-	std::vector<Real> region(6);
-	bool result;
-	std::set<int> found;
-	int index;
+	const Real region[6] = {point[0], point[1], point[2], point[0], point[1], point[2]};
+	Element<3*ORDER,2,3> found;
+
+	// The boxes containing the point are visited until the first element containing it
+	bool inside = tree_.searchUntil(region, [&](int index) {
+		found = this -> getElement(this -> tree_.pointId(index));
+		return found.isPointInside(point);
+	});
+
+	return inside ? found : Element<3*ORDER,2,3>();
+}
+
+template <UInt ORDER>
+Element<3*ORDER,2,3> MeshHandler<ORDER,2,3>::findLocationGrid(const Point& point) const {
+	const UInt * begin;
+	const UInt * end;
+	grid_.candidates(point, begin, end);
+
 	Element<3*ORDER,2,3> tmp;
-	region[0] = point[0];
-	region[1] = point[1];
-	region[2] = point[2];
-	region[3] = point[0];
-	region[4] = point[1];
-	region[5] =	point[2];
-
-	result = tree_.search(region, found);
-	if(result == 0) {
-		return Element<3*ORDER,2,3>();
-	}
-	for (std::set<int>::iterator i = found.begin(); i != found.end(); i++) {
-		index = *i;
-		index = this -> tree_.pointId(index);
-  		tmp = this -> getElement(index);
-		result = tmp.isPointInside(point);
-		if(result == 1) {
+	for(const UInt * it = begin; it != end; ++it) {
+		tmp = getElement(*it);
+		if(tmp.isPointInside(point))
 			return tmp;
-		}
 	}
 	return Element<3*ORDER,2,3>();
 }
 
+template <UInt ORDER>
+std::vector<Id> MeshHandler<ORDER,2,3>::findLocationBatch(const std::vector<Point>& points, bool redundancy) const
+{
+	std::vector<Id> located(points.size(), Identifier::NVAL);
+	const std::vector<UInt> order = mortonOrder(points, 3);
+
+	// With the tree (or the grid) available the walk is only worth a few steps, a longer one is
+	// replaced by a query; without it the bound only protects against the cycles of the walk
+	const UInt max_steps = (search_ == 2 || search_ == 4) ? 64 : num_elements_;
+
+	buildGeometryCache();
+	buildAdjacency();
+
+	// The curve is cut in chunks of consecutive points, located in parallel: every chunk walks on
+	// its own, so that the result does not depend on the number of threads
+	const int chunks = (points.size()+MortonChunkSize-1)/MortonChunkSize;
+	const int threads = fdaPDEThreads();
+	#pragma omp parallel for num_threads(threads) schedule(dynamic)
+	for(int chunk = 0; chunk < chunks; ++chunk)
+	{
+		Element<3*ORDER,2,3> current_element;
+		Id previous = (search_ == 2 || search_ == 4) ? Identifier::NVAL : 0;
+		const UInt last = std::min<UInt>(points.size(), (chunk+1)*MortonChunkSize);
+
+		for(UInt k = chunk*MortonChunkSize; k < last; ++k)
+		{
+			const UInt i = order[k];
+			const Point& point = points[i];
+			Id found = Identifier::NVAL;
+
+			if(previous != Identifier::NVAL)
+			{
+				current_element = getElement(previous);
+				for(UInt step = 0; step < max_steps && current_element.getId() != Identifier::NVAL; ++step)
+				{
+					if(current_element.isPointInside(point))
+					{
+						found = current_element.getId();
+						break;
+					}
+					int direction = current_element.getPointDirection(point);
+					if(direction < 0)
+						break;
+					current_element = getNeighbors(current_element.getId(), direction);
+				}
+			}
+
+			if(found == Identifier::NVAL)
+			{
+				if(search_ == 2)
+					found = findLocationTree(point).getId();
+				else if(search_ == 4)
+					found = findLocationGrid(point).getId();
+				else if(redundancy)
+					found = findLocationNaive(point).getId();
+			}
+
+			if(found != Identifier::NVAL)
+				previous = found;
+			located[i] = found;
+		}
+	}
+	return located;
+}
+
 template <UInt ORDER>
 Real MeshHandler<ORDER,2,3>::elementMeasure(Id id) const
 {
-	std::vector<Point> p;
-	p.resize(3*ORDER);
+	std::array<Point, 3*ORDER> p;
 	Id id_current_point;
 	for (int i=0; i<3*ORDER; ++i)
 	{
@@ -570,13 +825,16 @@ MeshHandler<ORDER,3,3>::MeshHandler(SEXP mesh, UInt search)
 	points_ = REAL(VECTOR_ELT(mesh_, 2));
 	elements_ = INTEGER(VECTOR_ELT(mesh_, 3));
 	search_ = search;
+	geometry_cache_ = geometryCacheOption();
 
 	if (search == 2) { //if tree search, construct a tree mesh
 		// Rprintf("mesh LENGTH: %d \n",XLENGTH(mesh_));
-		int mesh_len = XLENGTH(mesh_);
-		if (mesh_len == 5) { //don't have tree mesh information (length==5)
-			ADTree<Element<6*ORDER-2,3,3>> tmp(points_, elements_, num_nodes_, num_elements_);
-			tree_ = tmp;
+		SEXP image = meshImageElement(mesh_);
+		int mesh_len = XLENGTH(mesh_) - (image != R_NilValue); //the image, if any, is the last element
+		if (image != R_NilValue && getImage().read(image, tree_)) {
+			//tree read in place from the image of the mesh, see MeshImage
+		} else if (mesh_len == 5) { //don't have tree mesh information (length==5)
+			tree_ = ADTree<Element<6*ORDER-2,3,3>>(points_, elements_, num_nodes_, num_elements_, 6*ORDER-2);
 		} else {
 			//RECIEVE TREE INFORMATION FROM R
 			//tree_header information
@@ -608,25 +866,27 @@ MeshHandler<ORDER,3,3>::MeshHandler(SEXP mesh, UInt search)
 
 			UInt num_tree_nodes = id_.size();
 			std::vector<TreeNode<Element<6*ORDER-2,3,3>>> tree_nodes;
+			tree_nodes.reserve(num_tree_nodes);
+			std::vector<Real> coord(ndimt_);
 			for (UInt i=0; i<num_tree_nodes; i++) {
-				std::vector<Real> coord;
 				for (UInt j=0; j<ndimt_; j++) {
-					coord.push_back(box_[i + num_tree_nodes*j]);
+					coord[j] = box_[i + num_tree_nodes*j];
 				}
 				Box<3> box (coord);
 				TreeNode<Element<6*ORDER-2,3,3>> tree_node(box, id_[i], node_left_child_[i], node_right_child_[i]);
 				tree_nodes.push_back(tree_node);
 			}
 
-			ADTree<Element<6*ORDER-2,3,3>> tmp(tree_header, tree_nodes);
-			tree_ = tmp;
+			tree_ = ADTree<Element<6*ORDER-2,3,3>>(tree_header, tree_nodes);
 		}
+	} else if (search == 4) { //if grid search, fill the buckets
+		buildGrid();
 	}
 }
 
 
 template <UInt ORDER>
-Point MeshHandler<ORDER,3,3>::getPoint(Id id)
+Point MeshHandler<ORDER,3,3>::getPoint(Id id) const
 {
 	Point point(id, Identifier::NVAL, points_[3*id], points_[3*id+1], points_[3*id+2]);
 	return point;
@@ -635,8 +895,7 @@ Point MeshHandler<ORDER,3,3>::getPoint(Id id)
 template <UInt ORDER>
 Element<6*ORDER-2,3,3> MeshHandler<ORDER,3,3>::getElement(Id id) const
 {
-	std::vector<Point> element_points;
-	element_points.resize(6*ORDER-2);
+	std::array<Point, 6*ORDER-2> element_points;
 	Id id_current_point;
 	for (int i=0; i<6*ORDER-2; ++i)
 	{
@@ -647,9 +906,53 @@ Element<6*ORDER-2,3,3> MeshHandler<ORDER,3,3>::getElement(Id id) const
 								 points_[3*id_current_point+1],
 								 points_[3*id_current_point+2]);
 	}
+	if(!geometry_.empty())
+		return Element<6*ORDER-2,3,3>(id, element_points, &geometry_[Element<6*ORDER-2,3,3>::geometrySize()*id]);
 	return Element<6*ORDER-2,3,3>(id, element_points);
 }
 
+template <UInt ORDER>
+void MeshHandler<ORDER,3,3>::buildGeometryCache() const
+{
+	if(!geometry_cache_ || !geometry_.empty())
+		return;
+
+	const UInt size = Element<6*ORDER-2,3,3>::geometrySize();
+	std::vector<Real> geometry(size*num_elements_);
+	for(Id id=0; id < num_elements_; ++id)
+		getElement(id).storeGeometry(&geometry[size*id]);
+	geometry_.swap(geometry);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,3,3>::setGeometryCache(bool enable)
+{
+	geometry_cache_ = enable;
+	if(!enable)
+		std::vector<Real>().swap(geometry_);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,3,3>::buildGrid() const
+{
+	if(grid_.size() == 0 && num_elements_ > 0)
+		grid_ = BucketGrid<Element<6*ORDER-2,3,3>>(points_, elements_, num_nodes_, num_elements_, 6*ORDER-2);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,3,3>::buildAdjacency() const
+{
+	if(adjacency_.numNodes() == 0 && num_nodes_ > 0)
+		adjacency_ = MeshAdjacency<Element<6*ORDER-2,3,3>>(elements_, num_nodes_, num_elements_, 6*ORDER-2);
+}
+
+template <UInt ORDER>
+void MeshHandler<ORDER,3,3>::buildAssemblyPattern() const
+{
+	if(pattern_.numNodes() == 0 && num_nodes_ > 0)
+		pattern_ = AssemblyPattern<Element<6*ORDER-2,3,3>>(getAdjacency(), elements_, num_elements_, 6*ORDER-2);
+}
+
 template <UInt ORDER>
 Element<6*ORDER-2,3,3> MeshHandler<ORDER,3,3>::findLocationNaive(Point point) const
 {
@@ -665,41 +968,133 @@ Element<6*ORDER-2,3,3> MeshHandler<ORDER,3,3>::findLocationNaive(Point point) co
 	return Element<6*ORDER-2,3,3>(); //default element with NVAL ID
 }
 
+template <UInt ORDER>
+Element<6*ORDER-2,3,3> MeshHandler<ORDER,3,3>::getNeighbors(Id id_element, UInt number) const
+{
+	Id id_neighbour = getAdjacency().elementNeighbor(id_element, number);
+	if (id_neighbour == Identifier::NVAL) return Element<6*ORDER-2,3,3>(); //Element with NVAL ID
+
+	return getElement(id_neighbour);
+}
+
+// Visibility walk algorithm which uses barycentric coordinate [Sundareswara et al]
+template <UInt ORDER>
+Element<6*ORDER-2,3,3> MeshHandler<ORDER,3,3>::findLocationWalking(const Point& point, const Element<6*ORDER-2,3,3>& starting_element) const
+{
+	//Walking algorithm to the point, the number of steps bounds the (rare) cycles of the walk
+	Element<6*ORDER-2,3,3> current_element = starting_element;
+
+	for(UInt step = 0; step < num_elements_ && current_element.getId() != Identifier::NVAL; ++step)
+	{
+		if(current_element.isPointInside(point))
+			return current_element;
+		int direction = current_element.getPointDirection(point);
+		if(direction < 0)
+			break; //the point is not beyond any face of the element, but it is not inside it
+		current_element = getNeighbors(current_element.getId(), direction);
+	}
+
+	return Element<6*ORDER-2,3,3>();
+}
+
 template <UInt ORDER>
 Element<6*ORDER-2,3,3> MeshHandler<ORDER,3,3>::findLocationTree(const Point& point) const {
-	std::vector<Real> region(6);
-	bool result;
-	std::set<int> found;
-	int index;
+	const Real region[6] = {point[0], point[1], point[2], point[0], point[1], point[2]};
+	Element<6*ORDER-2,3,3> found;
+
+	// The boxes containing the point are visited until the first element containing it
+	bool inside = tree_.searchUntil(region, [&](int index) {
+		found = this -> getElement(this -> tree_.pointId(index));
+		return found.isPointInside(point);
+	});
+
+	return inside ? found : Element<6*ORDER-2,3,3>();
+}
+
+template <UInt ORDER>
+Element<6*ORDER-2,3,3> MeshHandler<ORDER,3,3>::findLocationGrid(const Point& point) const {
+	const UInt * begin;
+	const UInt * end;
+	grid_.candidates(point, begin, end);
+
 	Element<6*ORDER-2,3,3> tmp;
-	region[0] = point[0];
-	region[1] = point[1];
-	region[2] = point[2];
-	region[3] = point[0];
-	region[4] = point[1];
-	region[5] =	point[2];
-
-	result = tree_.search(region, found);
-	if(result == 0) {
-		return Element<6*ORDER-2,3,3>();
-	}
-	for (std::set<int>::iterator i = found.begin(); i != found.end(); i++) {
-		index = *i;
-		index = this -> tree_.pointId(index);
-  		tmp = this -> getElement(index);
-		result = tmp.isPointInside(point);
-		if(result == 1) {
+	for(const UInt * it = begin; it != end; ++it) {
+		tmp = getElement(*it);
+		if(tmp.isPointInside(point))
 			return tmp;
-		}
 	}
 	return Element<6*ORDER-2,3,3>();
 }
 
+template <UInt ORDER>
+std::vector<Id> MeshHandler<ORDER,3,3>::findLocationBatch(const std::vector<Point>& points, bool redundancy) const
+{
+	std::vector<Id> located(points.size(), Identifier::NVAL);
+	const std::vector<UInt> order = mortonOrder(points, 3);
+
+	// With the tree (or the grid) available the walk is only worth a few steps, a longer one is
+	// replaced by a query; without it the bound only protects against the cycles of the walk
+	const UInt max_steps = (search_ == 2 || search_ == 4) ? 64 : num_elements_;
+
+	buildGeometryCache();
+	buildAdjacency();
+
+	// The curve is cut in chunks of consecutive points, located in parallel: every chunk walks on
+	// its own, so that the result does not depend on the number of threads
+	const int chunks = (points.size()+MortonChunkSize-1)/MortonChunkSize;
+	const int threads = fdaPDEThreads();
+	#pragma omp parallel for num_threads(threads) schedule(dynamic)
+	for(int chunk = 0; chunk < chunks; ++chunk)
+	{
+		Element<6*ORDER-2,3,3> current_element;
+		Id previous = (search_ == 2 || search_ == 4) ? Identifier::NVAL : 0;
+		const UInt last = std::min<UInt>(points.size(), (chunk+1)*MortonChunkSize);
+
+		for(UInt k = chunk*MortonChunkSize; k < last; ++k)
+		{
+			const UInt i = order[k];
+			const Point& point = points[i];
+			Id found = Identifier::NVAL;
+
+			if(previous != Identifier::NVAL)
+			{
+				current_element = getElement(previous);
+				for(UInt step = 0; step < max_steps && current_element.getId() != Identifier::NVAL; ++step)
+				{
+					if(current_element.isPointInside(point))
+					{
+						found = current_element.getId();
+						break;
+					}
+					int direction = current_element.getPointDirection(point);
+					if(direction < 0)
+						break;
+					current_element = getNeighbors(current_element.getId(), direction);
+				}
+			}
+
+			if(found == Identifier::NVAL)
+			{
+				if(search_ == 2)
+					found = findLocationTree(point).getId();
+				else if(search_ == 4)
+					found = findLocationGrid(point).getId();
+				else if(redundancy)
+					found = findLocationNaive(point).getId();
+			}
+
+			if(found != Identifier::NVAL)
+				previous = found;
+			located[i] = found;
+		}
+	}
+	return located;
+}
+
 template <UInt ORDER>
 Real MeshHandler<ORDER,3,3>::elementMeasure(Id id) const
 {
-	std::vector<Point> p;
-	p.resize(6*ORDER-2);
+	std::array<Point, 6*ORDER-2> p;
 	Id id_current_point;
 	for (int i=0; i<6*ORDER-2; ++i)
 	{
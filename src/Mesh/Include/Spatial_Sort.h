@@ -0,0 +1,101 @@
+#ifndef __SPATIAL_SORT_H__
+#define __SPATIAL_SORT_H__
+
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
+#include <limits>
+
+#include "../../FdaPDE.h"
+#include "Mesh_Objects.h"
+
+//! Number of consecutive points of the Morton curve located by the same thread in findLocationBatch
+constexpr UInt MortonChunkSize = 4096;
+
+//! Spreads the lowest 32 bits of x so that they occupy the even bits of the result
+inline std::uint64_t mortonSpread2(std::uint64_t x)
+{
+	x &= 0x00000000ffffffffULL;
+	x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+	x = (x | (x << 8))  & 0x00ff00ff00ff00ffULL;
+	x = (x | (x << 4))  & 0x0f0f0f0f0f0f0f0fULL;
+	x = (x | (x << 2))  & 0x3333333333333333ULL;
+	x = (x | (x << 1))  & 0x5555555555555555ULL;
+	return x;
+}
+
+//! Spreads the lowest 21 bits of x so that they occupy every third bit of the result
+inline std::uint64_t mortonSpread3(std::uint64_t x)
+{
+	x &= 0x00000000001fffffULL;
+	x = (x | (x << 32)) & 0x001f00000000ffffULL;
+	x = (x | (x << 16)) & 0x001f0000ff0000ffULL;
+	x = (x | (x << 8))  & 0x100f00f00f00f00fULL;
+	x = (x | (x << 4))  & 0x10c30c30c30c30c3ULL;
+	x = (x | (x << 2))  & 0x1249249249249249ULL;
+	return x;
+}
+
+//! A function returning the Morton (Z-order) codes of a set of points
+/*!
+ * The coordinates are normalized on the bounding box of the points and quantized on
+ * 2^32 (ndim=2) or 2^21 (ndim=3) levels per direction before interleaving their bits,
+ * so that points close in space get close codes.
+ * \param points the points to encode
+ * \param ndim the number of coordinates to be used (2 or 3)
+ * \return a vector with the code of each point
+*/
+inline std::vector<std::uint64_t> mortonCodes(const std::vector<Point>& points, UInt ndim)
+{
+	std::vector<std::uint64_t> codes(points.size());
+	if(points.empty())
+		return codes;
+
+	Real min[3], max[3];
+	for(UInt k=0; k<ndim; ++k)
+	{
+		min[k] = std::numeric_limits<Real>::max();
+		max[k] = std::numeric_limits<Real>::lowest();
+	}
+	for(const Point& p : points)
+		for(UInt k=0; k<ndim; ++k)
+		{
+			min[k] = std::min(min[k], p[k]);
+			max[k] = std::max(max[k], p[k]);
+		}
+
+	const Real levels = (ndim == 2) ? 4294967295. : 2097151.;
+	Real scale[3];
+	for(UInt k=0; k<ndim; ++k)
+		scale[k] = (max[k] > min[k]) ? levels/(max[k]-min[k]) : 0.;
+
+	for(std::size_t i=0; i<points.size(); ++i)
+	{
+		std::uint64_t q[3];
+		for(UInt k=0; k<ndim; ++k)
+			q[k] = static_cast<std::uint64_t>((points[i][k]-min[k])*scale[k]);
+
+		if(ndim == 2)
+			codes[i] = mortonSpread2(q[0]) | (mortonSpread2(q[1]) << 1);
+		else
+			codes[i] = mortonSpread3(q[0]) | (mortonSpread3(q[1]) << 1) | (mortonSpread3(q[2]) << 2);
+	}
+	return codes;
+}
+
+//! A function returning the order in which a set of points is visited along a Morton curve
+/*!
+ * \param points the points to sort
+ * \param ndim the number of coordinates to be used (2 or 3)
+ * \return a permutation p such that points[p[0]], points[p[1]], ... follow the curve
+*/
+inline std::vector<UInt> mortonOrder(const std::vector<Point>& points, UInt ndim)
+{
+	std::vector<std::uint64_t> codes = mortonCodes(points, ndim);
+	std::vector<UInt> order(points.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&codes](UInt a, UInt b) {return codes[a] < codes[b];});
+	return order;
+}
+
+#endif
@@ -1546,9 +1546,9 @@ void Test_ADTree1_c(int *n){
 
 	//*************only possible for triangle to have this kind of constructor
 	//constructor from 2D/2.5D/3D mesh
-	ADTree<Element<3,2,2>> ADTk(points, triangle, num_nodes, num_triangle); //11th
-	// ADTree<Element<3,2,3>> ADTl(points, triangle, num_nodes, num_triangle); //12th
-	// ADTree<Element<3,3,3>> ADTm(points, triangle, num_nodes, num_triangle); //13th
+	ADTree<Element<3,2,2>> ADTk(points, triangle, num_nodes, num_triangle, 3); //11th
+	// ADTree<Element<3,2,3>> ADTl(points, triangle, num_nodes, num_triangle, 3); //12th
+	// ADTree<Element<3,3,3>> ADTm(points, triangle, num_nodes, num_triangle, 4); //13th
 	///*******Can there be ADTree<Box<2>> or ADTree<Box<3>> as well??? I assume that
 	//*********Shape will always be Element so I am using that logic at ADTree constructor
 
@@ -1713,9 +1713,9 @@ void Test_ADTree2_c(int *n){
 
 	//*************only possible for triangle to have this kind of constructor
 	//constructor from 2D/2.5D/3D mesh
-	ADTree<Element<3,2,2>> ADTk(points, triangle, num_nodes, num_triangle); //11th
-	// ADTree<Element<3,2,3>> ADTl(points, triangle, num_nodes, num_triangle); //12th
-	// ADTree<Element<3,3,3>> ADTm(points, triangle, num_nodes, num_triangle); //13th
+	ADTree<Element<3,2,2>> ADTk(points, triangle, num_nodes, num_triangle, 3); //11th
+	// ADTree<Element<3,2,3>> ADTl(points, triangle, num_nodes, num_triangle, 3); //12th
+	// ADTree<Element<3,3,3>> ADTm(points, triangle, num_nodes, num_triangle, 4); //13th
 	///*******Can there be ADTree<Box<2>> or ADTree<Box<3>> as well??? I assume that
 	//*********Shape will always be Element so I am using that logic at ADTree constructor
 
@@ -0,0 +1,63 @@
+#include "../Include/Mesh_Image.h"
+
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const char * path)
+{
+#ifndef _WIN32
+	int fd = open(path, O_RDONLY);
+	if(fd < 0)
+		return;
+
+	struct stat info;
+	if(fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		void * map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(map != MAP_FAILED)
+		{
+			data_ = static_cast<const char *>(map);
+			size_ = info.st_size;
+			mapped_ = true;
+		}
+	}
+	close(fd); //the mapping stays valid
+#else
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if(!file)
+		return;
+
+	std::streamsize size = file.tellg();
+	file.seekg(0);
+	buffer_.resize(size);
+	if(size > 0 && file.read(buffer_.data(), size))
+	{
+		data_ = buffer_.data();
+		size_ = size;
+	}
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+	if(mapped_)
+		munmap(const_cast<char *>(data_), size_);
+#endif
+}
+
+SEXP meshImageElement(SEXP mesh)
+{
+	R_xlen_t length = XLENGTH(mesh);
+	SEXP names = Rf_getAttrib(mesh, R_NamesSymbol);
+	if(length == 0 || TYPEOF(names) != STRSXP)
+		return R_NilValue;
+	if(std::strcmp(CHAR(STRING_ELT(names, length-1)), "tree_image") != 0)
+		return R_NilValue;
+	return VECTOR_ELT(mesh, length-1);
+}
@@ -68,6 +68,12 @@ class FPIRLS_Base {
    void compute_GCV(UInt& lambda_index);
    //! A method that computes the estimates of the variance. It depends on the scale flags: only the Gamma and InvGaussian distributions have the scale parameter.
    void compute_variance_est();
+   //! A method that sizes the algorithm variables and the outputs for all the lambdas.
+   void initialize();
+   //! A method that performs f-PIRLS for the lambda of index lambda_index.
+   void apply_lambda(UInt lambda_index);
+   //! A method that copies the results of the lambda of index lambda_index from a solver that performed it.
+   void gather(const FPIRLS_Base & solver, UInt lambda_index);
 
    // link and other functions. Definited as pure virtual methods, the implementaton depend on the choosen distributions
 
@@ -81,6 +87,8 @@ class FPIRLS_Base {
    virtual Real var_function(const Real& mu)const = 0;
    //! A pure virtual method that represents the deviation function: used as norm in GCV
    virtual Real dev_function(const Real&mu, const Real& x)const = 0;
+   //! A pure virtual method returning a solver of the same distribution, before apply, on the given data: used by the threads of apply
+   virtual std::unique_ptr<FPIRLS_Base> clone(InputHandler& inputData, OptimizationData & optimizationData)const = 0;
 
 
   public:
@@ -168,6 +176,10 @@ class FPIRLS_Bernoulli : public FPIRLS <InputHandler, Integrator, ORDER, mydim,
 
     inline Real dev_function(const Real& mu, const Real& x)const{return (x == 0)? 2*log(1/(1-mu)) : 2*log(1/mu);}
 
+    inline std::unique_ptr<FPIRLS_Base<InputHandler, Integrator, ORDER, mydim, ndim>> clone(InputHandler& inputData, OptimizationData & optimizationData)const{
+      return make_unique<FPIRLS_Bernoulli>(this->mesh_, inputData, optimizationData, this->mu_.front());
+    }
+
   public:
 
     FPIRLS_Bernoulli(const MeshHandler<ORDER,mydim,ndim>& mesh, InputHandler& inputData, OptimizationData & optimizationData, VectorXr mu0):
@@ -191,6 +203,10 @@ class FPIRLS_Poisson : public FPIRLS <InputHandler, Integrator, ORDER, mydim, nd
 
       inline Real dev_function(const Real&mu, const Real& x)const{ return (x>0) ? x*log(x/mu) - (x-mu): mu; }
 
+      inline std::unique_ptr<FPIRLS_Base<InputHandler, Integrator, ORDER, mydim, ndim>> clone(InputHandler& inputData, OptimizationData & optimizationData)const{
+        return make_unique<FPIRLS_Poisson>(this->mesh_, inputData, optimizationData, this->mu_.front());
+      }
+
     public:
 
     FPIRLS_Poisson(const MeshHandler<ORDER,mydim,ndim>& mesh, InputHandler& inputData, OptimizationData & optimizationData, VectorXr mu0):
@@ -215,6 +231,10 @@ class FPIRLS_Exponential : public FPIRLS <InputHandler, Integrator, ORDER, mydim
 
       inline Real dev_function(const Real&mu, const Real& x)const{ return 2*(((x-mu)/mu)-log(x/mu)); }
 
+      inline std::unique_ptr<FPIRLS_Base<InputHandler, Integrator, ORDER, mydim, ndim>> clone(InputHandler& inputData, OptimizationData & optimizationData)const{
+        return make_unique<FPIRLS_Exponential>(this->mesh_, inputData, optimizationData, this->mu_.front());
+      }
+
     public:
 
     FPIRLS_Exponential(const MeshHandler<ORDER,mydim,ndim>& mesh, InputHandler& inputData, OptimizationData & optimizationData, VectorXr mu0):
@@ -240,6 +260,10 @@ class FPIRLS_Gamma : public FPIRLS <InputHandler, Integrator, ORDER, mydim, ndim
 
       inline Real dev_function(const Real&mu, const Real& x)const{ return 2*(((x-mu)/mu)-log(x/mu)); }
 
+      inline std::unique_ptr<FPIRLS_Base<InputHandler, Integrator, ORDER, mydim, ndim>> clone(InputHandler& inputData, OptimizationData & optimizationData)const{
+        return make_unique<FPIRLS_Gamma>(this->mesh_, inputData, optimizationData, this->mu_.front(), this->scale_parameter_flag_, this->_scale_param);
+      }
+
     public:
 
     FPIRLS_Gamma(const MeshHandler<ORDER,mydim,ndim>& mesh, InputHandler& inputData, OptimizationData & optimizationData, VectorXr mu0, bool scale_parameter_flag, Real scale_param):
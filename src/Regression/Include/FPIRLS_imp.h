@@ -27,6 +27,88 @@ void FPIRLS_Base<InputHandler,Integrator,ORDER, mydim, ndim>::apply( const Forci
   //Initialize the containers size, as LambdaS_len
   const UInt LambdaS_len = mu_.size();
 
+  initialize();
+
+  if(isSpaceVarying)
+  {
+    FiniteElement<Integrator, ORDER, mydim, ndim> fe;
+  	Assembler::forcingTerm(mesh_, fe, u, forcingTerm);
+  }
+
+  // The lambdas are independent of each other: each thread performs f-PIRLS for its lambdas on its own copy of the
+  // data and of the model, the first preapply assembling the matrices and reading R before the threads start
+  int threads = std::min(fdaPDEThreads(), int(LambdaS_len));
+  if(threads > 1)
+  {
+    regression_. template preapply<ORDER,mydim,ndim, Integrator, IntegratorGaussP3, 0, 0>(this->mesh_);
+    if(regression_.isIterativeSolver()) // MINRES warns through R
+      threads = 1;
+  }
+
+  if(threads < 2)
+  {
+    for(UInt i=0 ; i < LambdaS_len ; i++){//for-cycle for each spatial penalization (lambdaS).
+
+      Rprintf("Start FPIRLS for the lambda number %d \n", i+1);
+      apply_lambda(i);
+      Rprintf("\t n. iterations: %d\n \n", n_iterations[i]);
+
+    }// end for
+  }
+  else
+  {
+    std::vector<std::unique_ptr<InputHandler>> inputCopies;
+    std::vector<std::unique_ptr<OptimizationData>> optimizationCopies;
+    std::vector<std::unique_ptr<FPIRLS_Base>> solvers;
+    for(int t = 1; t < threads; t++)
+    {
+      inputCopies.push_back(make_unique<InputHandler>(inputData_));
+      optimizationCopies.push_back(make_unique<OptimizationData>(optimizationData_));
+      solvers.push_back(clone(*inputCopies.back(), *optimizationCopies.back()));
+      solvers.back()->isSpaceVarying = isSpaceVarying;
+      solvers.back()->forcingTerm = forcingTerm;
+      solvers.back()->initialize();
+      solvers.back()->regression_. template preapply<ORDER,mydim,ndim, Integrator, IntegratorGaussP3, 0, 0>(this->mesh_);
+    }
+
+    // the lambdas are taken in turn, the solver t performing t, t+threads, ...
+    #pragma omp parallel for num_threads(threads) schedule(static,1)
+    for(int t = 0; t < threads; t++)
+    {
+      FPIRLS_Base & solver = (t == 0) ? *this : *solvers[t-1];
+      for(UInt i = t; i < LambdaS_len; i += threads)
+        solver.apply_lambda(i);
+    }
+
+    for(UInt i=0 ; i < LambdaS_len ; i++){
+      if(i % threads != 0)
+        gather(*solvers[i % threads - 1], i);
+
+      Rprintf("Start FPIRLS for the lambda number %d \n", i+1);
+      Rprintf("\t n. iterations: %d\n \n", n_iterations[i]);
+    }
+  }
+
+  //best lambda
+  if(this->optimizationData_.get_loss_function()=="GCV"){
+    for(UInt i=0 ; i < LambdaS_len ; i++){
+      if(_GCV[i] < optimizationData_.get_best_value())
+      {
+        optimizationData_.set_best_lambda_S(i);
+        optimizationData_.set_best_value(_GCV[i]);
+      }
+    }
+  }
+
+  // Variance Estimate
+  compute_variance_est();
+}
+
+template <typename InputHandler, typename Integrator, UInt ORDER, UInt mydim, UInt ndim>
+void FPIRLS_Base<InputHandler,Integrator,ORDER, mydim, ndim>::initialize(){
+
+  const UInt LambdaS_len = mu_.size();
+
   // initialize the algorithm variables
   G_.resize(LambdaS_len);
   WeightsMatrix_.resize(LambdaS_len);
@@ -40,25 +122,19 @@ void FPIRLS_Base<InputHandler,Integrator,ORDER, mydim, ndim>::apply( const Forci
   _solution.resize(LambdaS_len,1);
 
   _GCV.resize(LambdaS_len,-1);//If GCV is not computed the vector stores -1
+  _J_minima.resize(LambdaS_len);
+}
 
+template <typename InputHandler, typename Integrator, UInt ORDER, UInt mydim, UInt ndim>
+void FPIRLS_Base<InputHandler,Integrator,ORDER, mydim, ndim>::apply_lambda(UInt lambda_index){
 
-  if(isSpaceVarying)
-  {
-    FiniteElement<Integrator, ORDER, mydim, ndim> fe;
-  	Assembler::forcingTerm(mesh_, fe, u, forcingTerm);
-  }
-
-
-  for(UInt i=0 ; i < LambdaS_len ; i++){//for-cycle for each spatial penalization (lambdaS).
+    UInt i = lambda_index;
 
     current_J_values[i][0] = past_J_values[i][0] + 2*inputData_.get_treshold();
     current_J_values[i][1] = past_J_values[i][1] + 2*inputData_.get_treshold();
 
     this->optimizationData_.setCurrentLambda(i); // set right lambda for the current iteration.
 
-    Rprintf("Start FPIRLS for the lambda number %d \n", i+1);
-
-
     // start the iterative method for the lambda index i
     while(stopping_criterion(i)){
 
@@ -84,18 +160,33 @@ void FPIRLS_Base<InputHandler,Integrator,ORDER, mydim, ndim>::apply( const Forci
 
     } //end while
 
-    Rprintf("\t n. iterations: %d\n \n", n_iterations[i]);
-
-    _J_minima.push_back(current_J_values[i][0]+current_J_values[i][1]); // compute the minimum value of the J fuctional
+    _J_minima[i] = current_J_values[i][0]+current_J_values[i][1]; // compute the minimum value of the J fuctional
 
     if(this->optimizationData_.get_loss_function()=="GCV"){ // compute GCV if it is required
       compute_GCV(i);
     }
+}
+
+template <typename InputHandler, typename Integrator, UInt ORDER, UInt mydim, UInt ndim>
+void FPIRLS_Base<InputHandler,Integrator,ORDER, mydim, ndim>::gather(const FPIRLS_Base & solver, UInt lambda_index){
 
-  }// end for
+  const UInt i = lambda_index;
 
-  // Variance Estimate
-  compute_variance_est();
+  mu_[i] = solver.mu_[i];
+  pseudoObservations_[i] = solver.pseudoObservations_[i];
+  G_[i] = solver.G_[i];
+  WeightsMatrix_[i] = solver.WeightsMatrix_[i];
+  current_J_values[i] = solver.current_J_values[i];
+  past_J_values[i] = solver.past_J_values[i];
+  n_iterations[i] = solver.n_iterations[i];
+
+  _solution(i,0) = solver._solution(i,0);
+  _dof(i,0) = solver._dof(i,0);
+  if(inputData_.getCovariates()->rows()>0)
+    _beta_hat(i,0) = solver._beta_hat(i,0);
+  _fn_hat(i,0) = solver._fn_hat(i,0);
+  _J_minima[i] = solver._J_minima[i];
+  _GCV[i] = solver._GCV[i];
 }
 
 template <typename InputHandler, typename Integrator, UInt ORDER, UInt mydim, UInt ndim>
@@ -236,7 +327,7 @@ std::array<Real,2> FPIRLS_Base<InputHandler,Integrator,ORDER, mydim, ndim>::comp
   }
 
   non_parametric_value = Lf.transpose() * (*(regression_.getR0_())) * Lf;
-  non_parametric_value = (optimizationData_.get_lambda_S())[lambda_index]*non_parametric_value;
+  non_parametric_value = (*optimizationData_.get_LambdaS_vector())[lambda_index]*non_parametric_value;
 
   std::array<Real,2> returnObject{parametric_value, non_parametric_value};
 
@@ -266,13 +357,6 @@ void FPIRLS_Base<InputHandler,Integrator,ORDER, mydim, ndim>::compute_GCV(UInt &
 
         _GCV[lambda_index] = GCV_value;
 
-        //best lambda
-        if(GCV_value < optimizationData_.get_best_value())
-        {
-        optimizationData_.set_best_lambda_S(lambda_index);
-        optimizationData_.set_best_value(GCV_value);
-        }
-
 }
 
 template <typename InputHandler, typename Integrator, UInt ORDER, UInt mydim, UInt ndim>
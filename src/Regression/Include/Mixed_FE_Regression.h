@@ -8,12 +8,66 @@
 #include "../../FE_Assemblers_Solvers/Include/Integrate_Psi.h"
 #include "../../FE_Assemblers_Solvers/Include/Kronecker_Product.h"
 #include "../../FE_Assemblers_Solvers/Include/Matrix_Assembler.h"
+#include "../../FE_Assemblers_Solvers/Include/Matrix_Free.h"
 #include "../../FE_Assemblers_Solvers/Include/Param_Functors.h"
+#include "../../FE_Assemblers_Solvers/Include/Psi_Builder.h"
 #include "../../FE_Assemblers_Solvers/Include/Solver.h"
+#include "../../Global_Utilities/Include/Make_Unique.h"
+#include "../../Global_Utilities/Include/Parallel.h"
+#include "../../Global_Utilities/Include/Solver_Definitions.h"
 #include "../../Mesh/Include/Mesh.h"
 #include "../../Lambda_Optimization/Include/Optimization_Data.h"
+#include "../../Lambda_Optimization/Include/Trace_Estimator.h"
 #include "Regression_Data.h"
 
+//! Reads the R option fdaPDE.reduced.system, setting it to TRUE solves the spatial regression with a lumped mass matrix
+inline bool reducedSystemOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.reduced.system"));
+	return Rf_isLogical(option) && Rf_length(option) > 0 && LOGICAL(option)[0] == TRUE;
+}
+
+//! Reads the R option fdaPDE.iterative.solver, setting it to TRUE solves the regression systems by preconditioned MINRES
+inline bool iterativeSolverOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.iterative.solver"));
+	return Rf_isLogical(option) && Rf_length(option) > 0 && LOGICAL(option)[0] == TRUE;
+}
+
+//! Reads the R option fdaPDE.solver.tolerance, the relative residual of the iterative solvers (1e-10 if not set)
+inline Real solverToleranceOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.solver.tolerance"));
+	if(Rf_isNumeric(option) && Rf_length(option) > 0 && Rf_asReal(option) > 0)
+		return Rf_asReal(option);
+	return 1e-10;
+}
+
+//! Reads the R option fdaPDE.gcv.blocked, setting it to TRUE computes the exact gcv by GCV_Blocked where possible
+inline bool gcvBlockedOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.gcv.blocked"));
+	return Rf_isLogical(option) && Rf_length(option) > 0 && LOGICAL(option)[0] == TRUE;
+}
+
+//! Reads the R option fdaPDE.multishift.grid, setting it to TRUE solves the reduced systems of a grid of lambdas together
+inline bool multiShiftGridOption()
+{
+	SEXP option = Rf_GetOption1(Rf_install("fdaPDE.multishift.grid"));
+	return Rf_isLogical(option) && Rf_length(option) > 0 && LOGICAL(option)[0] == TRUE;
+}
+
+//! The state of a thread solving the systems of single lambdas, see MixedFERegressionBase::apply_lambda
+struct LambdaWorkspace
+{
+	LambdaWorkspace(SparseMatrixType type, SparseSolver solver): dec(type, solver) {}
+	SparseFactorization dec;	//!< Factorization of the system matrix of the last lambda
+	bool isAnalyzed = false;	//!< Whether the ordering of dec has been computed, the pattern being the same for every lambda
+	Real lambda = 0;		//!< Last lambda factorized
+	MatrixXr MU;			//!< matrixNoCov^-1 * U, for the Woodbury decomposition [covariates only]
+	Eigen::PartialPivLU<MatrixXr> Gdec;	//!< Factorization of G = C + V * matrixNoCov^-1 * U [covariates only]
+};
+
 /*! A base class for the smooth regression.
 */
 template<typename InputHandler>
@@ -40,6 +94,7 @@ class MixedFERegressionBase
 		//	                | -lambdaS*(R1k^T+lambdaT*LR0k)  |        -lambdaS*R0k	          |      |         O          |  O |
 
 		SpMat 		matrixNoCov_;	//!< System matrix without
+		std::vector<UInt> matrixNoCovPositions_;	//!< Positions in the values of matrixNoCov_ of the entries of its blocks
 		SpMat 		DMat_;
 		SpMat 		R1_;		//!< R1 matrix of the model
 		SpMat 		R0_;	 	//!< Mass matrix in space
@@ -59,16 +114,58 @@ class MixedFERegressionBase
 		VectorXi 	element_ids_; 	//!< elements id information
 
 		// Factorizations
-		Eigen::SparseLU<SpMat> matrixNoCovdec_; //!< Stores the factorization of matrixNoCov_
+		SparseFactorization matrixNoCovdec_; //!< Stores the factorization of matrixNoCov_
+		bool isMatrixNoCovAnalyzed_ = false;	//!< Whether the ordering of matrixNoCovdec_ fits the pattern of matrixNoCov_
 		//std::unique_ptr<Eigen::PartialPivLU<MatrixXr>>  matrixNoCovdec_{new Eigen::PartialPivLU<MatrixXr>}; //!< Stores the factorization of matrixNoCov_
 		Eigen::PartialPivLU<MatrixXr> Gdec_;	//!< Stores factorization of G =  C + [V * matrixNoCov^-1 * U]
 
 		Eigen::PartialPivLU<MatrixXr> WTW_;	//!< Stores the factorization of W^T * W
 		bool isWTWfactorized_ = false;
 		bool isRcomputed_ = false;
-		Eigen::SparseLU<SpMat> R0dec_; 		//!< Stores the factorization of R0_
+		SparseFactorization R0dec_; 		//!< Stores the factorization of R0_ (negated, as in matrixNoCov_)
+		TraceEstimator dofEstimator_;		//!< Estimator of the stochastic dofs, reading its R options when the model is built
+
+		// Matrix-free solution (see the R option fdaPDE.matrix.free): R0_, R1_ and matrixNoCov_ are not assembled
+		bool isMatrixFree_ = false;
+		std::unique_ptr<LinearOperator> R0op_;		//!< Applies R0 element by element
+		std::unique_ptr<LinearOperator> R1op_;		//!< Applies R1 element by element
+		std::unique_ptr<SaddlePointOperator> matrixNoCovop_;	//!< Applies matrixNoCov_ through R0op_ and R1op_
+		SaddlePointMINRES<LinearOperator> matrixNoCovopminres_; //!< Solves the systems with matrixNoCovop_
+
+		// Iterative solution (see the R option fdaPDE.iterative.solver): matrixNoCov_ is assembled but not factorized
+		bool isIterative_ = false;
+		SaddlePointMINRES<SpMat> matrixNoCovminres_; //!< Solves the systems with matrixNoCov_
+
+		// Reduced system (see the R option fdaPDE.reduced.system): with R0 lumped to the diagonal matrix M, the second
+		// block of unknowns is eliminated and the first one solves the SPD system (DMat + lambda * R1^T * M^-1 * R1) x1 = b1 - R1^T * M^-1 * b2
+		bool isReduced_ = false;
+		bool isReducedAnalyzed_ = false;	//!< Whether the ordering of reducedMatrixdec_ fits the pattern of reducedMatrix_
+		Real reducedLambda_;
+		VectorXr	R0lumpedinv_;		//!< Inverse of the HRZ lumping of R0
+		SpMat		Rlumped_;		//!< R1^T * M^-1 * R1
+		SpMat		reducedMatrix_;		//!< DMat + lambda * Rlumped_
+		SparseFactorization reducedMatrixdec_{SparseMatrixType::SymmetricPositiveDefinite}; //!< Stores the factorization of reducedMatrix_
+
+		// Grid of lambdas (see the R option fdaPDE.multishift.grid): the reduced systems of all the lambdas differ by a
+		// multiple of Rlumped_, and are solved together by a multi-shift CG
+		bool isMultiShift_ = false;
+		MultiShiftCG multiShiftcg_;
+
+		// Grid of lambdas in parallel: apply_lambda solves the systems of one lambda (one pair in space-time) with a
+		// factorization owned by the calling thread, reading the matrices of the model without changing them
+		bool isParallelGrid_ = false;
+
+		// R options, read when the model is built: once the matrices are assembled, preapply reads no R object and
+		// can be called again by any thread [see FPIRLS_Base::apply]
+		const bool gcvBlocked_ = gcvBlockedOption();
+		const bool matrixFree_ = matrixFreeOption();
+		const bool reducedSystem_ = reducedSystemOption();
+		const bool multiShiftGrid_ = multiShiftGridOption();
+		const bool iterativeSolver_ = iterativeSolverOption();
+		const Real solverTolerance_ = solverToleranceOption();
 
 		VectorXr rhs_ft_correction_;	//!< right hand side correction for the forcing term:
+		bool isForcingComputed_ = false;	//!< Whether rhs_ft_correction_ has been computed, it does not change with the GAM iterations
 		VectorXr rhs_ic_correction_;	//!< Initial condition correction (parabolic case)
 		VectorXr _rightHandSide;      	//!< A Eigen::VectorXr: Stores the system right hand side.
 		MatrixXv _solution; 		//!< A Eigen::MatrixXv: Stores the system solution.
@@ -90,6 +187,8 @@ class MixedFERegressionBase
 	        void setPsi(const MeshHandler<ORDER, mydim, ndim> & mesh_);
 		//! A method computing the no-covariates version of the system matrix
 		void buildMatrixNoCov(const SpMat & NWblock, const SpMat & SWblock,  const SpMat & SEblock);
+		//! A method writing the values of the blocks in the pattern of matrixNoCov_, it returns false if the pattern does not fit them
+		bool updateMatrixNoCov(const SpMat & NWblock, const SpMat & SWblock,  const SpMat & SEblock);
 
 		//! A function which adds Dirichlet boundary conditions before solving the system ( Remark: BC for areal data are not implemented!)
 		void addDirichletBC();
@@ -117,8 +216,18 @@ class MixedFERegressionBase
 		void computeDegreesOfFreedomExact(UInt output_indexS, UInt output_indexT, Real lambdaS, Real lambdaT);
 		//! A method computing dofs in case of stochastic GCV, it is called by computeDegreesOfFreedom
 		void computeDegreesOfFreedomStochastic(UInt output_indexS, UInt output_indexT, Real lambdaS, Real lambdaT);
+		//! A method factorizing R0 and computing R_, needed by the exact dofs
+		void setR(const SpMat & R0);
+		//! A method returning the exact dofs from X1 = psi^T * Q * psi, B = I(:,k) * Q [locations by nodes only] and the factorization of R0 [thread safe]
+		Real degreesOfFreedomExact(const MatrixXr & X1, const MatrixXr & B, const SparseFactorization & R0dec, Real lambdaS, Real lambdaT) const;
+		//! A method returning the +1/-1 realizations of the stochastic dofs [thread safe]
+		MatrixXr dofProbes(void) const;
+		//! A method computing the beta coefficients from the solution of the given lambdas
+		void computeBeta(UInt output_indexS, UInt output_indexT);
 		//! A method computing GCV from the dofs
 		void computeGeneralizedCrossValidation(UInt output_indexS, UInt output_indexT, Real lambdaS, Real lambdaT);
+		//! A method solving the pairs of lambdas of a space-time problem concurrently, it is called by apply
+		void apply_space_time_grid(int threads);
 
 		// -- BUILD SYSTEM --
 		 //! Spatial version
@@ -134,6 +243,12 @@ class MixedFERegressionBase
 		//! A function which solves the factorized system
 		template<typename Derived>
 		MatrixXr system_solve(const Eigen::MatrixBase<Derived>&);
+		//! A function which solves matrixNoCov * x = b, by its factorization or, in the matrix-free case, by MINRES
+		template<typename Derived>
+		MatrixXr matrixNoCov_solve(const Eigen::MatrixBase<Derived>&);
+		//! A function which solves matrixNoCov * x = b by the reduced system, factorized in dec for the given lambda
+		template<typename Derived>
+		MatrixXr reduced_solve(const SparseFactorization & dec, Real lambda, const Eigen::MatrixBase<Derived> & b) const;
 
 	public:
 		//!A Constructor.
@@ -153,6 +268,28 @@ class MixedFERegressionBase
 		void computeDegreesOfFreedom(UInt output_indexS, UInt output_indexT, Real lambdaS, Real lambdaT);
 		//! A method that set WTW flag to false, in order to recompute the matrix WTW.
 		inline void recomputeWTW(void){ this->isWTWfactorized_ = false;}
+		//! A method returning whether the systems are solved by MINRES (matrix-free or iterative solution)
+		inline bool isIterativeSolver(void) const {return isIterative_ || isMatrixFree_;}
+		//! A method returning the largest number of MINRES iterations of all the solves
+		inline UInt getSolverIterations(void) const {return isMatrixFree_ ? matrixNoCovopminres_.maxIterations() : matrixNoCovminres_.maxIterations();}
+		//! A method returning the largest relative residual of MINRES of all the solves
+		inline Real getSolverResidual(void) const {return isMatrixFree_ ? matrixNoCovopminres_.maxError() : matrixNoCovminres_.maxError();}
+		//! A method returning whether the grid of lambdas can be solved by apply_grid and apply_to_b_grid
+		inline bool isMultiShift(void) const {return isMultiShift_;}
+		//! A method returning the largest number of multi-shift CG iterations of all the solves
+		inline UInt getMultiShiftIterations(void) const {return multiShiftcg_.maxIterations();}
+		//! A method returning the largest relative residual of the multi-shift CG of all the solves
+		inline Real getMultiShiftResidual(void) const {return multiShiftcg_.maxError();}
+		//! A method returning whether the systems of different lambdas can be solved concurrently by apply_lambda
+		inline bool isParallelGrid(void) const {return isParallelGrid_;}
+		//! A method returning the state of a thread calling apply_lambda, it can be called by the thread itself
+		inline LambdaWorkspace lambdaWorkspace(void) const
+		{
+			return isReduced_ ? LambdaWorkspace(SparseMatrixType::SymmetricPositiveDefinite, reducedMatrixdec_.solver()) :
+				LambdaWorkspace(SparseMatrixType::General, matrixNoCovdec_.solver());
+		}
+		//! A method returning the right hand side of the system for the given lambda (lambdaS in space-time)
+		VectorXr rightHandSide(Real lambda) const;
 
 		// -- GETTERS --
 		//! A function returning the computed barycenters of the locationss
@@ -208,6 +345,25 @@ class MixedFERegressionBase
 
 		MatrixXv apply(void);
 		MatrixXr apply_to_b(const MatrixXr & b);
+		//! Factorization of the system for lambdaS and lambdaT in workspace [thread safe]
+		void factorize_lambda(Real lambdaS, Real lambdaT, LambdaWorkspace & workspace) const;
+		//! Factorization of the system for lambda in workspace, spatial problems [thread safe]
+		void factorize_lambda(Real lambda, LambdaWorkspace & workspace) const
+		{
+			factorize_lambda(lambda, 0, workspace);
+		}
+		//! Solution of the system factorized in workspace with right hand side b [thread safe]
+		MatrixXr solve_lambda(const MatrixXr & b, const LambdaWorkspace & workspace) const;
+		//! Solution of the system for lambda with right hand side b, with the factorization of workspace [thread safe]
+		MatrixXr apply_lambda(const MatrixXr & b, Real lambda, LambdaWorkspace & workspace) const
+		{
+			factorize_lambda(lambda, workspace);
+			return solve_lambda(b, workspace);
+		}
+		//! Psi times the first block of the solution for every lambda of the grid, one per column [reduced system only]
+		MatrixXr apply_grid(const std::vector<Real> & lambdas);
+		//! Psi times the first block of the solution with right hand side [b; 0] for every lambda of the grid [reduced system only]
+		std::vector<MatrixXr> apply_to_b_grid(const MatrixXr & b, const std::vector<Real> & lambdas);
 };
 
 //----------------------------------------------------------------------------//
@@ -1,6 +1,7 @@
 #ifndef __MIXED_FE_REGRESSION_IMP_H__
 #define __MIXED_FE_REGRESSION_IMP_H__
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <random>
@@ -144,111 +145,45 @@ void MixedFERegressionBase<InputHandler>::setPsi(const MeshHandler<ORDER, mydim,
 	}
 	else if(regressionData_.isLocationsByBarycenter() && (regressionData_.getNumberOfRegions() == 0)) // Pointwise data -- by barycenter
 	{
-		// Exploit isLocationsByBarycenter simplyfication
-		constexpr UInt Nodes = mydim==2 ? 3*ORDER : 6*ORDER-2;
-		Element<Nodes, mydim, ndim> tri_activated;	// Dummy for element search
-		Real evaluator;					// Dummy for evaluation storage
+		// Exploit isLocationsByBarycenter simplyfication: we already know the id of the element
+		// containing each point and the values to add
+		PsiBuilder<ORDER, mydim, ndim> builder(mesh_, regressionData_.getSearch());
+		builder.byBarycenters(regressionData_.getElementIds(), regressionData_.getBarycenters(), psi_);
 
 		for(UInt i=0; i<nlocations;i++)
-		{ // Update Psi looping on all locations
-			// We already know the id of the element containing the point
-			tri_activated = mesh_.getElement(regressionData_.getElementId(i));
-
-			if(tri_activated.getId() == Identifier::NVAL)
+		{
+			if(regressionData_.getElementId(i) < 0 || regressionData_.getElementId(i) >= mesh_.num_elements())
 			{ // Invald id --> error
 				Rprintf("ERROR: Point %d is not in the domain, remove point and re-perform smoothing\n", i+1);
 			}
-			else
-			{ // tri_activated.getId() found, it's action might be felt a priori by all the psi of the element, one for each node
-				for(UInt node=0; node<Nodes ; ++node)
-				{// Loop on all the nodes of the found element and update the related entries of Psi
-					evaluator = regressionData_.getBarycenter(i,node); // We already know the value to add
-					// Insert the value in the column given by the GLOBAL indexing of the evaluated NODE
-					psi_.insert(i, tri_activated[node].getId()) = evaluator;
-				}
-			}
-		} // End of for loop
+		}
 	}
 	else if((!regressionData_.isLocationsByBarycenter()) && (regressionData_.getNumberOfRegions() == 0))
 	{
 		// THEORETICAL REMARK:
 		// If isLocationsByNodes && isLocationsByBarycenters are false
 		// locations are unspecified points, so we have to evaluate them directly
-		constexpr UInt Nodes = mydim==2 ? 3*ORDER : 6*ORDER-2;
-		Element<Nodes, mydim, ndim> tri_activated;	// Dummy for element search
-		Eigen::Matrix<Real,Nodes,1> coefficients;	// Dummy for point evaluation
-		Real evaluator;					// Dummy for evaluation storage
+		PsiBuilder<ORDER, mydim, ndim> builder(mesh_, regressionData_.getSearch());
 
-		// Resize for info storage
-		this->barycenters_.resize(nlocations, Nodes);
-		this->element_ids_.resize(nlocations);
+		// The points are located and the rows of Psi are computed in parallel, saving the barycenter information
+		std::vector<Id> located = builder.locate(regressionData_.getLocations());
+		builder.pointwise(regressionData_.getLocations(), located, psi_, nullptr, &barycenters_);
 
+		this->element_ids_.resize(nlocations);
 		for(UInt i=0; i<nlocations;i++)
-		{ // Update Psi looping on all locations
-			// [[GM missing a defaulted else, raising a WARNING!]]
-			if(regressionData_.getSearch() == 1)
-			{ // Use Naive search
-				tri_activated = mesh_.findLocationNaive(regressionData_.getLocations()[i]);
-			}
-			else if(regressionData_.getSearch() == 2)
-			{ // Use Tree search (default)
-				tri_activated = mesh_.findLocationTree(regressionData_.getLocations()[i]);
-			}
-
-			// Search the element containing the point
-			if(tri_activated.getId() == Identifier::NVAL)
+		{
+			element_ids_(i) = located[i]; // Save the id of the ELEMENT containing the location
+			if(located[i] == Identifier::NVAL)
 			{ // If not found
 				Rprintf("ERROR: Point %d is not in the domain, remove point and re-perform smoothing\n", i+1);
 			}
-			else
-			{ // tri_activated.getId() found, it's action might be felt a priori by all the psi of the element, one for each node
-				element_ids_(i) = tri_activated.getId(); // Save the id of the ELEMENT containing the location
-
-				for(UInt node=0; node<Nodes ; ++node)
-				{// Loop on all the nodes of the found element and update the related entries of Psi
-					// Define vector of all zeros but "node" component (necessary for function evaluate_point)
-					coefficients = Eigen::Matrix<Real,Nodes,1>::Zero();
-					coefficients(node) = 1; //Activates only current base-node
-					// Evaluate psi in the node
-					evaluator = evaluate_point<Nodes,mydim,ndim>(tri_activated, regressionData_.getLocations()[i], coefficients);
-					// Save barycenter information
-					barycenters_(i,node) = tri_activated.getBaryCoordinates(regressionData_.getLocations()[i])[node];
-					// Insert the value in the column given by the GLOBAL indexing of the evaluated NODE
-					psi_.insert(i, tri_activated[node].getId()) = evaluator;
-				}
-			}
-		} // End of for loop
+		}
 	}
 	else // Areal data
 	{
-		constexpr UInt Nodes = mydim==2 ? 3*ORDER : 6*ORDER-2;
-		Real * tab; // Psi_i temporary storage
-		tab = (Real*) malloc(sizeof(Real)*nnodes);
-
-		for(UInt i=0; i<nlocations;i++) //nlocations = number of regions
-		{ // Loop to update by rows Psi matrix
-			for(UInt k=0; k<nnodes; k++)
-				tab[k] = 0;	//Iniialize at 0
-			for(UInt j=0; j<mesh_.num_elements(); j++)
-			{
-				if((*(regressionData_.getIncidenceMatrix()))(i,j) == 1) // Element j is in region i
-				{ // Location is related to that mesh element
-					Element<Nodes, mydim, ndim> tri = mesh_.getElement(j); // Identify the element
-					for(UInt k=0; k<Nodes; k++)
-					{ // Add contribution of the area to right location
-						tab[tri[k].getId()] += integratePsi(tri,k); // Integral over tri of psi_k
-					}
-				}
-			}
-			for(UInt k=0; k<nnodes; k++)
-			{ // Loop update Psi matrix i-th row
-				if(tab[k] != 0) // Relevant change
-				{ // Update the right position
-					psi_.insert(i,k) = tab[k]/A_(i); // Divide by |D_i|
-				}
-			}
-		}
-		free(tab);	// Deallocate dynamic memory
+		// Psi_i is the mean of the basis functions over the elements of region i
+		PsiBuilder<ORDER, mydim, ndim> builder(mesh_, regressionData_.getSearch());
+		builder.areal(*(regressionData_.getIncidenceMatrix()), A_, psi_);
 	}
 	psi_.makeCompressed();	// Compress for optimization
 }
@@ -535,9 +470,17 @@ template<typename InputHandler>
 void MixedFERegressionBase<InputHandler>::buildMatrixNoCov(const SpMat & NWblock, const SpMat & SWblock,  const SpMat & SEblock)
 {
 	UInt nnodes = N_*M_; // Note that is only space M_=1
+
+	// Only the values of the blocks change with lambda: once the pattern is built, they are written in place
+	if(updateMatrixNoCov(NWblock, SWblock, SEblock))
+		return;
+
+	const std::vector<UInt> * bc_indices = regressionData_.getDirichletIndices();
+	const UInt nblocks = NWblock.nonZeros() + 2*SWblock.nonZeros() + SEblock.nonZeros();
+
 	// Vector to be filled with the triplets used to build _coeffmatrix (reserved with the right dimension)
 	std::vector<coeff> tripletAll;
-	tripletAll.reserve(NWblock.nonZeros() + 2*SWblock.nonZeros() + SEblock.nonZeros());
+	tripletAll.reserve(nblocks + 2*bc_indices->size());
 
 	// Parsing all matrices, reading the values to be put inside _coeffmatrix, coordinates according to the rules
 	for(UInt k=0; k<NWblock.outerSize(); ++k)
@@ -560,12 +503,70 @@ void MixedFERegressionBase<InputHandler>::buildMatrixNoCov(const SpMat & NWblock
 		{
 			tripletAll.push_back(coeff(it.row()+nnodes, it.col(), it.value()));
 		}
+	// The diagonal entries of the Dirichlet nodes, set by addDirichletBC, belong to the pattern
+	for(UInt id : *bc_indices)
+	{
+		tripletAll.push_back(coeff(id, id, 0.));
+		tripletAll.push_back(coeff(id+nnodes, id+nnodes, 0.));
+	}
 
 	// Define, resize, fill and compress
 	matrixNoCov_.setZero();
 	matrixNoCov_.resize(2*nnodes,2*nnodes);
 	matrixNoCov_.setFromTriplets(tripletAll.begin(),tripletAll.end());
 	matrixNoCov_.makeCompressed();
+
+	// Position of the value of each entry of the blocks, in the order of the triplets
+	const int * inner = matrixNoCov_.innerIndexPtr(), * outer = matrixNoCov_.outerIndexPtr();
+	matrixNoCovPositions_.resize(nblocks);
+	for(UInt k=0; k<nblocks; ++k)
+		matrixNoCovPositions_[k] = std::lower_bound(inner+outer[tripletAll[k].col()], inner+outer[tripletAll[k].col()+1], tripletAll[k].row()) - inner;
+
+	// A new pattern needs a new ordering
+	isMatrixNoCovAnalyzed_ = false;
+}
+
+template<typename InputHandler>
+bool MixedFERegressionBase<InputHandler>::updateMatrixNoCov(const SpMat & NWblock, const SpMat & SWblock,  const SpMat & SEblock)
+{
+	UInt nnodes = N_*M_;
+	if(matrixNoCov_.rows() != 2*nnodes || !matrixNoCov_.isCompressed() ||
+		matrixNoCovPositions_.size() != NWblock.nonZeros() + 2*SWblock.nonZeros() + SEblock.nonZeros())
+		return false;
+
+	Real * values = matrixNoCov_.valuePtr();
+	const int * inner = matrixNoCov_.innerIndexPtr(), * outer = matrixNoCov_.outerIndexPtr();
+	std::fill(values, values+matrixNoCov_.nonZeros(), 0.);
+
+	// The entries are visited in the order of the triplets of buildMatrixNoCov, each one must be found in its column
+	UInt k = 0;
+	auto add = [&](int row, int col, Real value) -> bool
+	{
+		const UInt position = matrixNoCovPositions_[k++];
+		if(position < UInt(outer[col]) || position >= UInt(outer[col+1]) || inner[position] != row)
+			return false;
+		values[position] += value;
+		return true;
+	};
+
+	for(UInt j=0; j<NWblock.outerSize(); ++j)
+		for(SpMat::InnerIterator it(NWblock,j); it; ++it)
+			if(!add(it.row(), it.col(), it.value()))
+				return false;
+	for(UInt j=0; j<SEblock.outerSize(); ++j)
+		for(SpMat::InnerIterator it(SEblock,j); it; ++it)
+			if(!add(it.row()+nnodes, it.col()+nnodes, it.value()))
+				return false;
+	for(UInt j=0; j<SWblock.outerSize(); ++j)
+		for(SpMat::InnerIterator it(SWblock,j); it; ++it)
+			if(!add(it.col(), it.row()+nnodes, it.value()))
+				return false;
+	for(UInt j=0; j<SWblock.outerSize(); ++j)
+		for(SpMat::InnerIterator it(SWblock,j); it; ++it)
+			if(!add(it.row()+nnodes, it.col(), it.value()))
+				return false;
+
+	return true;
 }
 
 //----------------------------------------------------------------------------//
@@ -577,7 +578,35 @@ void MixedFERegressionBase<InputHandler>::system_factorize()
 	const VectorXr * P = regressionData_.getWeightsMatrix(); // Matrix of weights for GAM
 
 	// First phase: Factorization of matrixNoCov
-	matrixNoCovdec_.compute(matrixNoCov_);
+	if(isReduced_)
+	{
+		if(!isReducedAnalyzed_)
+		{
+			reducedMatrixdec_.analyzePattern(reducedMatrix_);
+			isReducedAnalyzed_ = true;
+		}
+		reducedMatrixdec_.factorize(reducedMatrix_);
+	}
+	else if(isMatrixFree_)
+	{
+		// only the Jacobi preconditioner is computed, from the diagonal of the operator
+		matrixNoCovopminres_.compute(*matrixNoCovop_);
+	}
+	else if(isIterative_)
+	{
+		// the preconditioner is computed from the blocks of matrixNoCov_
+		matrixNoCovminres_.compute(matrixNoCov_, nnodes);
+	}
+	else
+	{
+		// The ordering depends only on the pattern, which is the same for every lambda
+		if(!isMatrixNoCovAnalyzed_)
+		{
+			matrixNoCovdec_.analyzePattern(matrixNoCov_);
+			isMatrixNoCovAnalyzed_ = true;
+		}
+		matrixNoCovdec_.factorize(matrixNoCov_);
+	}
 
 	if(regressionData_.getCovariates()->rows() != 0)
 	{ // Needed only if there are covariates, else we can stop before
@@ -614,7 +643,7 @@ void MixedFERegressionBase<InputHandler>::system_factorize()
 		 	U_.topRows(nnodes) = psi_.transpose()*A_.asDiagonal()*U_.topRows(nnodes);
     		}
 
-		MatrixXr D = V_*matrixNoCovdec_.solve(U_);
+		MatrixXr D = V_*matrixNoCov_solve(U_);
 
 		// G = C + D
 		MatrixXr G;
@@ -635,17 +664,42 @@ template<typename Derived>
 MatrixXr MixedFERegressionBase<InputHandler>::system_solve(const Eigen::MatrixBase<Derived> & b)
 {
 	// Resolution of the system matrixNoCov * x1 = b
-	MatrixXr x1 = matrixNoCovdec_.solve(b);
+	MatrixXr x1 = matrixNoCov_solve(b);
 	if(regressionData_.getCovariates()->rows() != 0)
 	{
 		// Resolution of G * x2 = V * x1
 		MatrixXr x2 = Gdec_.solve(V_*x1);
 		// Resolution of the system matrixNoCov * x3 = U * x2
-		x1 -= matrixNoCovdec_.solve(U_*x2);
+		x1 -= matrixNoCov_solve(U_*x2);
 	}
 	return x1;
 }
 
+template<typename InputHandler>
+template<typename Derived>
+MatrixXr MixedFERegressionBase<InputHandler>::matrixNoCov_solve(const Eigen::MatrixBase<Derived> & b)
+{
+	if(isReduced_)
+		return reduced_solve(reducedMatrixdec_, reducedLambda_, b);
+	if(isMatrixFree_)
+		return matrixNoCovopminres_.solve(b);
+	if(isIterative_)
+		return matrixNoCovminres_.solve(b);
+	return matrixNoCovdec_.solve(b);
+}
+
+template<typename InputHandler>
+template<typename Derived>
+MatrixXr MixedFERegressionBase<InputHandler>::reduced_solve(const SparseFactorization & dec, Real lambda, const Eigen::MatrixBase<Derived> & b) const
+{
+	// b = [b1; b2], the second block of the solution follows from the first one
+	MatrixXr b2 = R0lumpedinv_.asDiagonal()*b.bottomRows(N_);
+	MatrixXr x(b.rows(), b.cols());
+	x.topRows(N_) = dec.solve(b.topRows(N_) - R1_.transpose()*b2);
+	x.bottomRows(N_) = -(R0lumpedinv_.asDiagonal()*(R1_*x.topRows(N_)) + b2/lambda);
+	return x;
+}
+
 //----------------------------------------------------------------------------//
 // GCV
 
@@ -698,7 +752,6 @@ void MixedFERegressionBase<InputHandler>::computeDegreesOfFreedomExact(UInt outp
 	std::string file_name;
 	UInt nnodes = N_*M_;
 	UInt nlocations = regressionData_.getNumberofObservations();
-	Real degrees=0;
 
 
 	MatrixXr X1;
@@ -713,16 +766,46 @@ void MixedFERegressionBase<InputHandler>::computeDegreesOfFreedomExact(UInt outp
 	{
 		isRcomputed_ = true;
 		//take R0 from the final matrix since it has already applied the dirichlet boundary conditions
-		SpMat R0 = matrixNoCov_.bottomRightCorner(nnodes,nnodes)/lambdaS;
+		setR(matrixNoCov_.bottomRightCorner(nnodes,nnodes)/lambdaS);
+	}
 
-		R0dec_.compute(R0);
-		if(!regressionData_.isSpaceTime() || !regressionData_.getFlagParabolic())
-		{
-			MatrixXr X2 = R0dec_.solve(R1_);
-			R_ = R1_.transpose() * X2;
+	MatrixXr B;
+	if(!regressionData_.isSpaceTime() && regressionData_.isLocationsByNodes()) {
+		const auto k = regressionData_.getObservationsIndices();
+
+		// Setup rhs B
+		B = MatrixXr::Zero(nnodes,nlocations);
+		// B = I(:,k) * Q
+		for (auto i=0; i<nlocations;++i) {
+			VectorXr ei = VectorXr::Zero(nlocations);
+			ei(i) = 1;
+			VectorXr Qi = LeftMultiplybyQ(ei);
+			for (int j=0; j<nlocations; ++j) {
+				B((*k)[i], j) = Qi(j);
+			}
 		}
 	}
 
+	_dof(output_indexS,output_indexT) = degreesOfFreedomExact(X1, B, R0dec_, lambdaS, lambdaT);
+}
+
+template<typename InputHandler>
+void MixedFERegressionBase<InputHandler>::setR(const SpMat & R0)
+{
+	R0dec_.compute(R0);
+	if(!regressionData_.isSpaceTime() || !regressionData_.getFlagParabolic())
+	{
+		MatrixXr X2 = R0dec_.solve(R1_);
+		R_ = R1_.transpose() * X2;
+	}
+}
+
+template<typename InputHandler>
+Real MixedFERegressionBase<InputHandler>::degreesOfFreedomExact(const MatrixXr & X1, const MatrixXr & B, const SparseFactorization & R0dec, Real lambdaS, Real lambdaT) const
+{
+	UInt nnodes = N_*M_;
+	Real degrees=0;
+
 	MatrixXr P;
 	MatrixXr X3=X1;
 
@@ -731,7 +814,7 @@ void MixedFERegressionBase<InputHandler>::computeDegreesOfFreedomExact(UInt outp
 	if (regressionData_.isSpaceTime() && regressionData_.getFlagParabolic())
 	{
 		SpMat X2 = R1_+lambdaT*LR0k_;
-		P = lambdaS*X2.transpose()*R0dec_.solve(X2);
+		P = lambdaS*X2.transpose()*R0dec.solve(X2);
 	}
 	else
 	{
@@ -765,18 +848,6 @@ void MixedFERegressionBase<InputHandler>::computeDegreesOfFreedomExact(UInt outp
 		if(regressionData_.getCovariates()->rows() != 0)
 			degrees += regressionData_.getCovariates()->cols();
 
-		// Setup rhs B
-		MatrixXr B;
-		B = MatrixXr::Zero(nnodes,nlocations);
-		// B = I(:,k) * Q
-		for (auto i=0; i<nlocations;++i) {
-			VectorXr ei = VectorXr::Zero(nlocations);
-			ei(i) = 1;
-			VectorXr Qi = LeftMultiplybyQ(ei);
-			for (int j=0; j<nlocations; ++j) {
-				B((*k)[i], j) = Qi(j);
-			}
-		}
 		// Solve the system TX = B
 		MatrixXr X;
 		X = Dsolver.solve(B);
@@ -799,7 +870,7 @@ void MixedFERegressionBase<InputHandler>::computeDegreesOfFreedomExact(UInt outp
 		}
 	}
 
-	_dof(output_indexS,output_indexT) = degrees;
+	return degrees;
 }
 
 template<typename InputHandler>
@@ -807,6 +878,32 @@ void MixedFERegressionBase<InputHandler>::computeDegreesOfFreedomStochastic(UInt
 {
 
 	UInt nnodes = N_*M_;
+	MatrixXr u = dofProbes();
+
+	// Products by S = psi * | I  0 | * matrix^-1 * | I  0 |^T * psi^T * A * Q, solving with right hand side | I  0 |^T * psi^T * A * Q * u
+	auto applyS = [this, nnodes](const MatrixXr & v) -> MatrixXr
+	{
+		MatrixXr b = MatrixXr::Zero(2*nnodes,v.cols());
+		if (regressionData_.getNumberOfRegions() == 0){
+			b.topRows(nnodes) = psi_.transpose() * LeftMultiplybyQ(v);
+		}else{
+			b.topRows(nnodes) = psi_.transpose() * A_.asDiagonal() * LeftMultiplybyQ(v);
+		}
+		return psi_*system_solve(b).topRows(nnodes);
+	};
+
+	Real q = 0;
+	if (regressionData_.getCovariates()->rows() != 0) {
+		q = regressionData_.getCovariates()->cols();
+	}
+
+	// Degrees of freedom = q + E[ u^T * S * u ], by Hutch++ or with fewer realizations if so required [see TraceEstimator]
+	_dof(output_indexS,output_indexT) = dofEstimator_.trace(applyS, u) + q;
+}
+
+template<typename InputHandler>
+MatrixXr MixedFERegressionBase<InputHandler>::dofProbes(void) const
+{
 	UInt nlocations = regressionData_.getNumberofObservations();
 
 	// std::random_device rd;
@@ -826,35 +923,25 @@ void MixedFERegressionBase<InputHandler>::computeDegreesOfFreedomStochastic(UInt
 			}
 		}
 	}
+	return u;
+}
 
-	// Define the first right hand side : | I  0 |^T * psi^T * A * Q * u
-	MatrixXr b = MatrixXr::Zero(2*nnodes,u.cols());
-	if (regressionData_.getNumberOfRegions() == 0){
-		b.topRows(nnodes) = psi_.transpose() * LeftMultiplybyQ(u);
-	}else{
-		b.topRows(nnodes) = psi_.transpose() * A_.asDiagonal() * LeftMultiplybyQ(u);
-	}
-
-	// Resolution of the system
-	MatrixXr x = system_solve(b);
-
-	MatrixXr uTpsi = u.transpose()*psi_;
-	VectorXr edf_vect(nrealizations);
-	Real q = 0;
-
-	// Degrees of freedom = q + E[ u^T * psi * | I  0 |* x ]
-	if (regressionData_.getCovariates()->rows() != 0) {
-		q = regressionData_.getCovariates()->cols();
+template<typename InputHandler>
+void MixedFERegressionBase<InputHandler>::computeBeta(UInt output_indexS, UInt output_indexT)
+{
+	const VectorXr * obsp = regressionData_.getObservations();
+	MatrixXr W(*(this->regressionData_.getCovariates()));
+	VectorXr P(*(this->regressionData_.getWeightsMatrix()));
+	VectorXr beta_rhs;
+	if( P.size() != 0)
+	{
+		beta_rhs = W.transpose()*P.asDiagonal()*(*obsp - psi_*_solution(output_indexS,output_indexT).topRows(psi_.cols()));
 	}
-	// For any realization we compute the degrees of freedom
-	for (int i=0; i<nrealizations; ++i) {
-
-		edf_vect(i) = uTpsi.row(i).dot(x.col(i).head(nnodes)) + q;
+	else
+	{
+		beta_rhs = W.transpose()*(*obsp - psi_*_solution(output_indexS,output_indexT).topRows(psi_.cols()));
 	}
-
-	// Estimates: sample mean, sample variance
-	Real mean = edf_vect.sum()/nrealizations;
-	_dof(output_indexS,output_indexT) = mean;
+	_beta(output_indexS,output_indexT) = WTW_.solve(beta_rhs);
 }
 
 template<typename InputHandler>
@@ -879,30 +966,78 @@ void MixedFERegressionBase<InputHandler>::preapply(EOExpr<A> oper, const Forcing
 		isPsiComputed = true;
 	}
 
-	// If there are covariates in the model set H and Q
-	if(Wp->rows() != 0)
+	// If there are covariates in the model set H and Q; the exact gcv by GCV_Blocked only multiplies by Q, so the
+	// dense s x s matrices are not built when it is going to be used [see optimizer_method_selection]
+	const bool isGCVBlocked = gcvBlocked_ && optimizationData_.get_loss_function() == "GCV" &&
+		optimizationData_.get_DOF_evaluation() == "exact" && regressionData_.getDirichletIndices()->size() == 0 &&
+		!regressionData_.isSpaceTime() && !isGAMData;
+	if(Wp->rows() != 0 && !isGCVBlocked)
 	{
 		setH();
 		setQ();
 	}
 
 	typedef EOExpr<Mass> ETMass; Mass EMass; ETMass mass(EMass);
-	if(!isR1Computed)
+	// Spatial problems without boundary conditions can be solved without assembling R0, R1 and the system matrix,
+	// if so required; the exact dofs and the GAM need the matrices
+	if(!isMatrixFree_ && !isR1Computed && !isR0Computed && matrixFree_ && !regressionData_.isSpaceTime() && !isGAMData &&
+		regressionData_.getDirichletIndices()->size() == 0 && optimizationData_.get_DOF_evaluation() != "exact")
+	{
+		R1op_ = make_unique<MatrixFreeOperator<ORDER, mydim, ndim, IntegratorSpace, A>>(mesh_, fe, oper);
+		R0op_ = make_unique<MatrixFreeOperator<ORDER, mydim, ndim, IntegratorSpace, Mass>>(mesh_, fe, mass);
+		matrixNoCovop_ = make_unique<SaddlePointOperator>(DMat_, *R1op_, *R0op_);
+		matrixNoCovopminres_.setTolerance(solverTolerance_);
+		isMatrixFree_ = true;
+	}
+
+	if(!isMatrixFree_ && !isR1Computed && !isR0Computed)
+	{
+		// R1, R0 and the forcing term in a single pass over the mesh
+		Assembler::operKernel(oper, mass, mesh_, fe, R1_, R0_, this->isSpaceVarying ? &u : nullptr, &rhs_ft_correction_);
+		isR1Computed = true;
+		isR0Computed = true;
+		isForcingComputed_ = this->isSpaceVarying;
+	}
+	if(!isMatrixFree_ && !isR1Computed)
 	{
 		Assembler::operKernel(oper, mesh_, fe, R1_);
 		isR1Computed = true;
 	}
-	if(!isR0Computed)
+	if(!isMatrixFree_ && !isR0Computed)
 	{
 		Assembler::operKernel(mass, mesh_, fe, R0_);
 		isR0Computed = true;
 	}
 
-	if(this->isSpaceVarying)
+	if(this->isSpaceVarying && !isForcingComputed_)
 	{
 		Assembler::forcingTerm(mesh_, fe, u, rhs_ft_correction_);
+		isForcingComputed_ = true;
+	}
+
+	// The reduced system needs no Dirichlet nodes, whose penalty acts on both blocks; the exact dofs use the mixed system
+	if(!isMatrixFree_ && !isReduced_ && reducedSystem_ && !regressionData_.isSpaceTime() &&
+		regressionData_.getDirichletIndices()->size() == 0 && optimizationData_.get_DOF_evaluation() != "exact")
+	{
+		R0lumpedinv_ = lumpedMass(R0_).cwiseInverse();	// positive also on quadratic elements, see lumpedMass
+		Rlumped_ = R1_.transpose()*R0lumpedinv_.asDiagonal()*R1_;
+		isReduced_ = true;
+	}
+	// A grid of lambdas for the gcv can be solved by the multi-shift CG on the reduced systems
+	isMultiShift_ = isReduced_ && multiShiftGrid_ && !isGAMData && optimizationData_.get_criterion() == "grid";
+
+	// Any other problem can be solved by MINRES instead of the LU factorization, if so required; the penalty of the
+	// Dirichlet nodes would spoil the convergence
+	if(!isMatrixFree_ && !isReduced_ && !isIterative_ && iterativeSolver_ && regressionData_.getDirichletIndices()->size() == 0)
+	{
+		matrixNoCovminres_.setTolerance(solverTolerance_);
+		isIterative_ = true;
 	}
 
+	// The lambdas of a problem solved by factorization can be solved concurrently [see apply_lambda and
+	// apply_space_time_grid]; the Dirichlet nodes would change the matrices of the model
+	isParallelGrid_ = !isMatrixFree_ && !isIterative_ && !isGAMData && regressionData_.getDirichletIndices()->size() == 0;
+
 	if(regressionData_.isSpaceTime())
 	{
 		this->template buildSpaceTimeMatrices<IntegratorTime, SPLINE_DEGREE, ORDER_DERIVATIVE>();
@@ -930,6 +1065,23 @@ void MixedFERegressionBase<InputHandler>::preapply(EOExpr<A> oper, const Forcing
 template<typename InputHandler>
 void MixedFERegressionBase<InputHandler>::buildSystemMatrix(Real lambda_S)
 {
+        if(isMatrixFree_)
+        {
+                matrixNoCovop_->setLambda(lambda_S);
+                return;
+        }
+        if(isReduced_)
+        {
+                // The pattern of the sum changes only with that of DMat_ (GAM)
+                SpMat reducedMatrix = this->DMat_ + lambda_S*Rlumped_;
+                isReducedAnalyzed_ = isReducedAnalyzed_ && reducedMatrix.nonZeros() == reducedMatrix_.nonZeros() &&
+                        std::equal(reducedMatrix.outerIndexPtr(), reducedMatrix.outerIndexPtr()+reducedMatrix.outerSize()+1, reducedMatrix_.outerIndexPtr()) &&
+                        std::equal(reducedMatrix.innerIndexPtr(), reducedMatrix.innerIndexPtr()+reducedMatrix.nonZeros(), reducedMatrix_.innerIndexPtr());
+                reducedMatrix_ = std::move(reducedMatrix);
+                reducedLambda_ = lambda_S;
+                return;
+        }
+
         this->R1_lambda = (-lambda_S)*(R1_);
         this->R0_lambda = (-lambda_S)*(R0_);
 
@@ -984,11 +1136,173 @@ MatrixXr MixedFERegressionBase<InputHandler>::apply_to_b(const MatrixXr & b)
 }
 
 
+template<typename InputHandler>
+VectorXr MixedFERegressionBase<InputHandler>::rightHandSide(Real lambda) const
+{
+	// As the corrections of apply
+	const UInt nnodes = N_*M_;
+	VectorXr rhs = _rightHandSide;
+	if(this->isSpaceVarying)
+		rhs.bottomRows(nnodes) = (-lambda)*rhs_ft_correction_;
+	if(regressionData_.isSpaceTime() && regressionData_.getFlagParabolic())
+		rhs.segment(nnodes, rhs_ic_correction_.size()) -= lambda*rhs_ic_correction_;
+	return rhs;
+}
+
+template<typename InputHandler>
+void MixedFERegressionBase<InputHandler>::factorize_lambda(Real lambdaS, Real lambdaT, LambdaWorkspace & workspace) const
+{
+	// The steps of buildSystemMatrix and system_factorize, on the matrices of workspace
+	const UInt nnodes = N_*M_;
+	SpMat A;
+	if(isReduced_)
+	{
+		A = DMat_ + lambdaS*Rlumped_;
+	}
+	else
+	{
+		// NorthWest block updated if separable, SouthWest block (and NorthEast) if parabolic
+		SpMat NW, SW;
+		if(regressionData_.isSpaceTime() && !regressionData_.getFlagParabolic())
+			NW = DMat_ + lambdaT*Ptk_;
+		if(regressionData_.isSpaceTime() && regressionData_.getFlagParabolic())
+			SW = R1_ + lambdaT*LR0k_;
+		const SpMat & NWblock = NW.size() != 0 ? NW : DMat_;
+		const SpMat & SWblock = SW.size() != 0 ? SW : R1_;
+
+		std::vector<coeff> tripletAll;
+		tripletAll.reserve(NWblock.nonZeros() + 2*SWblock.nonZeros() + R0_.nonZeros());
+		for(UInt k=0; k<NWblock.outerSize(); ++k)
+			for(SpMat::InnerIterator it(NWblock,k); it; ++it)
+				tripletAll.push_back(coeff(it.row(), it.col(), it.value()));
+		for(UInt k=0; k<R0_.outerSize(); ++k)
+			for(SpMat::InnerIterator it(R0_,k); it; ++it)
+				tripletAll.push_back(coeff(it.row()+nnodes, it.col()+nnodes, -lambdaS*it.value()));
+		for(UInt k=0; k<SWblock.outerSize(); ++k)
+			for(SpMat::InnerIterator it(SWblock,k); it; ++it)
+			{
+				tripletAll.push_back(coeff(it.col(), it.row()+nnodes, -lambdaS*it.value()));
+				tripletAll.push_back(coeff(it.row()+nnodes, it.col(), -lambdaS*it.value()));
+			}
+		A.resize(2*nnodes, 2*nnodes);
+		A.setFromTriplets(tripletAll.begin(), tripletAll.end());
+		A.makeCompressed();
+	}
+	if(!workspace.isAnalyzed)
+	{
+		workspace.dec.analyzePattern(A);
+		workspace.isAnalyzed = true;
+	}
+	workspace.dec.factorize(A);
+	workspace.lambda = lambdaS;
+
+	const MatrixXr * Wp = regressionData_.getCovariates();
+	if(Wp->rows() != 0)
+	{
+		// Woodbury, with U = [psi^T * W; 0] (psi^T * A * W for areal data) and V = [W^T * psi, 0]
+		MatrixXr U = MatrixXr::Zero(2*nnodes, Wp->cols());
+		if(regressionData_.getNumberOfRegions()==0)
+			U.topRows(nnodes) = psi_t_*(*Wp);
+		else
+			U.topRows(nnodes) = psi_t_*A_.asDiagonal()*(*Wp);
+		workspace.MU = isReduced_ ? reduced_solve(workspace.dec, lambdaS, U) : workspace.dec.solve(U);
+		workspace.Gdec.compute(-Wp->transpose()*(*Wp) + Wp->transpose()*(psi_*workspace.MU.topRows(nnodes)));
+	}
+}
+
+template<typename InputHandler>
+MatrixXr MixedFERegressionBase<InputHandler>::solve_lambda(const MatrixXr & b, const LambdaWorkspace & workspace) const
+{
+	// As system_solve
+	MatrixXr x = isReduced_ ? reduced_solve(workspace.dec, workspace.lambda, b) : workspace.dec.solve(b);
+	const MatrixXr * Wp = regressionData_.getCovariates();
+	if(Wp->rows() != 0)
+		x -= workspace.MU*workspace.Gdec.solve(Wp->transpose()*(psi_*x.topRows(N_*M_)));
+	return x;
+}
+
+template<typename InputHandler>
+MatrixXr MixedFERegressionBase<InputHandler>::apply_grid(const std::vector<Real> & lambdas)
+{
+	// The forcing term enters the reduced right hand side as b1 + lambda * R1^T * M^-1 * u, so the two parts are
+	// solved separately and summed for every lambda
+	MatrixXr b(N_, this->isSpaceVarying ? 2 : 1);
+	b.col(0) = _rightHandSide.topRows(N_);
+	if(this->isSpaceVarying)
+		b.col(1) = R1_.transpose()*(R0lumpedinv_.asDiagonal()*rhs_ft_correction_);
+
+	std::vector<MatrixXr> x = apply_to_b_grid(b, lambdas);
+	MatrixXr psif(psi_.rows(), lambdas.size());
+	for(UInt j=0; j<lambdas.size(); ++j)
+	{
+		psif.col(j) = x[j].col(0);
+		if(this->isSpaceVarying)
+			psif.col(j) += lambdas[j]*x[j].col(1);
+	}
+	return psif;
+}
+
+template<typename InputHandler>
+std::vector<MatrixXr> MixedFERegressionBase<InputHandler>::apply_to_b_grid(const MatrixXr & b, const std::vector<Real> & lambdas)
+{
+	// The covariates are accounted for by Woodbury as in system_solve: the columns of U are solved together with b
+	const MatrixXr * Wp = regressionData_.getCovariates();
+	const UInt q = Wp->rows() != 0 ? Wp->cols() : 0;
+	MatrixXr rhs(N_, b.cols()+q);
+	rhs.leftCols(b.cols()) = b;
+	if(q != 0)
+	{
+		if(regressionData_.getNumberOfRegions()==0)
+			rhs.rightCols(q) = psi_t_*(*Wp);
+		else
+			rhs.rightCols(q) = psi_t_*A_.asDiagonal()*(*Wp);
+	}
+
+	// The grid is split in groups of lambdas within a factor range: in each of them DMat + lambda * Rlumped is
+	// M + (lambda - lambda0) * Rlumped, with M = DMat + lambda0 * Rlumped and lambda0 below the group so that all the
+	// shifts are positive. The iterations grow with the square root of the range, one M is factorized per group
+	const Real range = 10;
+	std::vector<UInt> order(lambdas.size());
+	for(UInt j=0; j<lambdas.size(); ++j)
+		order[j] = j;
+	std::sort(order.begin(), order.end(), [&lambdas](UInt i, UInt j) {return lambdas[i] < lambdas[j];});
+
+	multiShiftcg_.setTolerance(solverTolerance_);
+	multiShiftcg_.setMaxIterations(20*N_);
+	SparseFactorization Mdec(SparseMatrixType::SymmetricPositiveDefinite);
+	Mdec.analyzePattern(Rlumped_ + DMat_);	// the pattern of M does not depend on lambda0
+	std::vector<MatrixXr> x(lambdas.size());
+	for(UInt first=0, last=0; first<order.size(); first=last)
+	{
+		const Real lambda0 = 0.9*lambdas[order[first]];
+		std::vector<Real> sigmas;
+		for(; last<order.size() && lambdas[order[last]] <= range*lambdas[order[first]]; ++last)
+			sigmas.push_back(lambdas[order[last]]-lambda0);
+
+		const SpMat M = DMat_ + lambda0*Rlumped_;
+		Mdec.factorize(M);
+		std::vector<MatrixXr> xgroup = multiShiftcg_.solve(Mdec, M, Rlumped_, sigmas, rhs, psi_);
+		for(UInt k=0; k<sigmas.size(); ++k)
+			x[order[first+k]] = std::move(xgroup[k]);
+	}
+
+	if(q != 0)
+	{
+		const MatrixXr WtW = Wp->transpose()*(*Wp);
+		for(UInt j=0; j<lambdas.size(); ++j)
+		{
+			// x = x1 - psi * matrixNoCov^-1 * U * G^-1 * W^T * x1, with G = -W^T * W + W^T * psi * matrixNoCov^-1 * U
+			Eigen::PartialPivLU<MatrixXr> Gdec(-WtW + Wp->transpose()*x[j].rightCols(q));
+			x[j] = x[j].leftCols(b.cols()) - x[j].rightCols(q)*Gdec.solve(Wp->transpose()*x[j].leftCols(b.cols()));
+		}
+	}
+	return x;
+}
+
 template<typename InputHandler>
 MatrixXv  MixedFERegressionBase<InputHandler>::apply(void)
 {
 	UInt nnodes = N_*M_; // Define nuber of nodes
-	const VectorXr * obsp = regressionData_.getObservations(); // Get observations
 
 	UInt sizeLambdaS;
 	if (!regressionData_.isSpaceTime() && !isGAMData)
@@ -1005,6 +1319,14 @@ MatrixXv  MixedFERegressionBase<InputHandler>::apply(void)
 		this->_beta.resize(sizeLambdaS,sizeLambdaT);
 	}
 
+	// The pairs of lambdas of a space-time problem can be solved concurrently
+	const int threads = (regressionData_.isSpaceTime() && isParallelGrid_ && sizeLambdaS*sizeLambdaT > 1) ? fdaPDEThreads() : 1;
+	if(threads > 1)
+	{
+		apply_space_time_grid(threads);
+		return this->_solution;
+	}
+
 	VectorXr rhs = _rightHandSide; // Save rhs for modification
 
 	for(UInt s=0; s<sizeLambdaS; ++s)
@@ -1081,18 +1403,7 @@ MatrixXv  MixedFERegressionBase<InputHandler>::apply(void)
 			// covariates computation
 			if(regressionData_.getCovariates()->rows()!=0)
 			{
-				MatrixXr W(*(this->regressionData_.getCovariates()));
-				VectorXr P(*(this->regressionData_.getWeightsMatrix()));
-				VectorXr beta_rhs;
-				if( P.size() != 0)
-				{
-					beta_rhs = W.transpose()*P.asDiagonal()*(*obsp - psi_*_solution(s,t).topRows(psi_.cols()));
-				}
-				else
-				{
-					beta_rhs = W.transpose()*(*obsp - psi_*_solution(s,t).topRows(psi_.cols()));
-				}
-				_beta(s,t) = WTW_.solve(beta_rhs);
+				computeBeta(s,t);
 			}
 		}
 	}
@@ -1106,6 +1417,101 @@ MatrixXv  MixedFERegressionBase<InputHandler>::apply(void)
 	return this->_solution;
 }
 
+template<typename InputHandler>
+void MixedFERegressionBase<InputHandler>::apply_space_time_grid(int threads)
+{
+	const UInt nnodes = N_*M_;
+	const std::vector<Real> lambdaS = optimizationData_.get_lambda_S();
+	const std::vector<Real> lambdaT = optimizationData_.get_lambda_T();
+	const UInt sizeLambdaS = lambdaS.size();
+	const UInt sizeLambdaT = lambdaT.size();
+
+	const bool isGCV = optimizationData_.get_loss_function()=="GCV";
+	const bool isExact = isGCV && optimizationData_.get_DOF_evaluation()=="exact";
+	const bool isStochastic = isGCV && !isExact && optimizationData_.get_DOF_evaluation()!="not_required";
+
+	// The terms of the dofs shared by all the pairs are computed once, as by computeDegreesOfFreedomExact
+	MatrixXr X1, u;
+	if(isExact)
+	{
+		if (regressionData_.getNumberOfRegions() == 0){ //pointwise data
+			X1 = psi_.transpose() * LeftMultiplybyQ(psi_);
+		}else{ //areal data
+			X1 = psi_.transpose() * A_.asDiagonal() * LeftMultiplybyQ(psi_);
+		}
+		if (isRcomputed_ == false)
+		{
+			isRcomputed_ = true;
+			setR(-R0_);	// no Dirichlet nodes in a parallel grid
+		}
+	}
+	// The stochastic dofs of all the pairs use the same realizations [as GCV_Stochastic]
+	if(isStochastic)
+		u = dofProbes();
+	const Real q = regressionData_.getCovariates()->rows() != 0 ? regressionData_.getCovariates()->cols() : 0;
+
+	// Each thread factorizes its pairs of lambdas in its own workspace [see factorize_lambda]; the solves of R0 in the
+	// parabolic exact dofs need a factorization of each thread too
+	#pragma omp parallel num_threads(threads)
+	{
+		LambdaWorkspace workspace = lambdaWorkspace();
+		TraceEstimator estimator = dofEstimator_;
+		SparseFactorization R0dec(SparseMatrixType::General, R0dec_.solver());
+		if(isExact && regressionData_.getFlagParabolic())
+			R0dec.compute(-R0_);
+
+		#pragma omp for schedule(dynamic)
+		for(int k = 0; k < int(sizeLambdaS*sizeLambdaT); ++k)
+		{
+			const UInt s = k/sizeLambdaT;
+			const UInt t = k%sizeLambdaT;
+			factorize_lambda(lambdaS[s], lambdaT[t], workspace);
+			_solution(s,t) = solve_lambda(rightHandSide(lambdaS[s]), workspace);
+
+			if(isExact)
+			{
+				_dof(s,t) = degreesOfFreedomExact(X1, MatrixXr(), regressionData_.getFlagParabolic() ? R0dec : R0dec_, lambdaS[s], lambdaT[t]);
+			}
+			else if(isStochastic)
+			{
+				auto applyS = [&](const MatrixXr & v) -> MatrixXr
+				{
+					MatrixXr b = MatrixXr::Zero(2*nnodes,v.cols());
+					if (regressionData_.getNumberOfRegions() == 0){
+						b.topRows(nnodes) = psi_.transpose() * LeftMultiplybyQ(v);
+					}else{
+						b.topRows(nnodes) = psi_.transpose() * A_.asDiagonal() * LeftMultiplybyQ(v);
+					}
+					return psi_*solve_lambda(b, workspace).topRows(nnodes);
+				};
+				_dof(s,t) = estimator.trace(applyS, u) + q;
+			}
+		}
+	}
+
+	// GCV and betas in the order of apply, the best lambdas being the first of equal GCVs
+	for(UInt s=0; s<sizeLambdaS; ++s)
+	{
+		for(UInt t=0; t<sizeLambdaT; ++t)
+		{
+			if(isGCV)
+			{
+				computeGeneralizedCrossValidation(s,t,lambdaS[s],lambdaT[t]);
+			}
+			else
+			{
+				_dof(s,t) = -1;
+				_GCV(s,t) = -1;
+			}
+
+			if(regressionData_.getCovariates()->rows()!=0)
+			{
+				computeBeta(s,t);
+			}
+		}
+	}
+}
+
 //----------------------------------------------------------------------------//
 
 template<>
@@ -63,6 +63,11 @@ SEXP regression_skeleton(InputHandler & regressionData, OptimizationData & optim
 		}
 	}
 
+	if(regression.isIterativeSolver())
+		Rprintf("MINRES: at most %d iterations, relative residual at most %e\n", regression.getSolverIterations(), regression.getSolverResidual());
+	if(regression.isMultiShift())
+		Rprintf("Multi-shift CG: at most %d iterations, relative residual at most %e\n", regression.getMultiShiftIterations(), regression.getMultiShiftResidual());
+
  	return Solution_Builders::build_solution_plain_regression<InputHandler, ORDER, mydim, ndim>(solution_bricks.first,solution_bricks.second,mesh,regressionData);
 }
 
@@ -77,7 +82,20 @@ std::pair<MatrixXr, output_Data> optimizer_method_selection(CarrierType & carrie
 {
 	// Build the optimizer
 	const OptimizationData * optr = carrier.get_opt_data();
-	if(optr->get_loss_function() == "GCV" && optr->get_DOF_evaluation() == "exact")
+	if(optr->get_loss_function() == "GCV" && optr->get_DOF_evaluation() == "exact" && gcvBlockedOption() && GCV_Blocked<CarrierType, 1>::is_applicable(carrier))
+	{
+		// bounded memory comes first, GCV_Eigen stores dense nnodes x nnodes matrices
+		Rprintf("GCV exact by blocks\n");
+		GCV_Blocked<CarrierType, 1> optim(carrier);
+		return optimizer_strategy_selection<GCV_Blocked<CarrierType, 1>, CarrierType>(optim, carrier);
+	}
+	else if(optr->get_loss_function() == "GCV" && optr->get_DOF_evaluation() == "exact" && gcvEigenOption() && GCV_Eigen<CarrierType, 1>::is_applicable(carrier))
+	{
+		Rprintf("GCV exact by eigendecomposition\n");
+		GCV_Eigen<CarrierType, 1> optim(carrier);
+		return optimizer_strategy_selection<GCV_Eigen<CarrierType, 1>, CarrierType>(optim, carrier);
+	}
+	else if(optr->get_loss_function() == "GCV" && optr->get_DOF_evaluation() == "exact")
 	{
 		Rprintf("GCV exact\n");
 		GCV_Exact<CarrierType, 1> optim(carrier);
@@ -102,27 +120,38 @@ std::pair<MatrixXr, output_Data> optimizer_method_selection(CarrierType & carrie
 		output_Data output;
 		output.z_hat.resize(carrier.get_psip()->rows(),carrier.get_opt_data()->get_size_S());
 		output.lambda_vec = carrier.get_opt_data()->get_lambda_S();
-		MatrixXr solution;
-
-		for(UInt j=0; j<carrier.get_opt_data()->get_size_S(); j++)
+		const std::vector<Real> & lambdas = carrier.get_opt_data()->get_lambda_S();
+		const UInt nl = carrier.get_opt_data()->get_size_S();
+		const auto * model = carrier.get_model();
+		const int threads = model->isParallelGrid() ? fdaPDEThreads() : 1;
+		MatrixXr solution(2*carrier.get_n_nodes(), nl);
+
+		// The last lambda is solved by the model in any case, so that it holds its betas
+		if(threads > 1)
 		{
-			if(j==0)
-			{
-				MatrixXr sol = carrier.apply(carrier.get_opt_data()->get_lambda_S()[j]);
-				solution.resize(sol.rows(),carrier.get_opt_data()->get_size_S());
-				solution.col(j) = sol;
-			}
-			else
+			#pragma omp parallel num_threads(threads)
 			{
-				solution.col(j) = carrier.apply(carrier.get_opt_data()->get_lambda_S()[j]);
+				LambdaWorkspace workspace = model->lambdaWorkspace();
+				#pragma omp for schedule(dynamic)
+				for(int j=0; j<int(nl)-1; j++)
+					solution.col(j) = model->apply_lambda(model->rightHandSide(lambdas[j]), lambdas[j], workspace);
 			}
-			optim.combine_output_prediction(solution.topRows(solution.rows()/2).col(j),output,j);
 		}
+		else
+		{
+			for(UInt j=0; j+1<nl; j++)
+				solution.col(j) = carrier.apply(lambdas[j]);
+		}
+		solution.col(nl-1) = carrier.apply(lambdas[nl-1]);
+
+		for(UInt j=0; j<nl; j++)
+			optim.combine_output_prediction(solution.topRows(solution.rows()/2).col(j),output,j);
 
 		// Rprintf("WARNING: partial time after the optimization method\n");
 		timespec T = Time_partial.stop();
 
 		output.time_partial = T.tv_sec + 1e-9*T.tv_nsec;
+		output.peak_memory = peakMemory();
 
                 // postponed after apply in order to have betas computed
                 output.betas = carrier.get_model()->getBeta();
@@ -155,6 +184,7 @@ std::pair<MatrixXr, output_Data> optimizer_strategy_selection(EvaluationType & o
 
 		// this will be used when grid will be correctly implemented, also for return elements
 
+		Fun.set_grid(optr->get_lambda_S());
 		Eval_GCV<EvaluationType> eval(Fun, optr->get_lambda_S());
 		output_Data output = eval.Get_optimization_vectorial();
 
@@ -165,6 +195,7 @@ std::pair<MatrixXr, output_Data> optimizer_strategy_selection(EvaluationType & o
 		MatrixXr solution = carrier.apply(output.lambda_sol);
 
 		output.time_partial = T.tv_sec + 1e-9*T.tv_nsec;
+		output.peak_memory = peakMemory();
 
                 //postponed after apply in order to have betas computed
                 output.betas = carrier.get_model()->getBeta();
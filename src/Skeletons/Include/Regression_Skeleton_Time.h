@@ -20,6 +20,8 @@ SEXP regression_skeleton_time(InputHandler & regressionData, OptimizationData &
 
 	regression.template preapply<ORDER,mydim,ndim, IntegratorSpace, IntegratorTime, SPLINE_DEGREE, ORDER_DERIVATIVE>(mesh); //! solve the problem (compute the _solution, _dof, _GCV, _beta)
         regression.apply();
+	if(regression.isIterativeSolver())
+		Rprintf("MINRES: at most %d iterations, relative residual at most %e\n", regression.getSolverIterations(), regression.getSolverResidual());
 
 	//! copy result in R memory
 	MatrixXv const & solution = regression.getSolution();